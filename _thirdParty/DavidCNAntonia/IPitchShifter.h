@@ -3,15 +3,26 @@
 #include <memory>
 
 namespace DavidCNAntonia {
+enum class ProcessingMode {
+  realtime,
+  // For offline bounces: throughput and quality over latency.
+  offline,
+};
+
 class IPitchShifter {
 public:
   static std::unique_ptr<IPitchShifter>
-  createInstance(int numChannels, double sampleRate, int samplesPerBlock);
+  createInstance(int numChannels, double sampleRate, int samplesPerBlock,
+                 ProcessingMode mode = ProcessingMode::realtime);
 
   virtual ~IPitchShifter() = default;
 
   virtual void setFormantPreserving(bool shouldPreserveFormants) = 0;
 
+  /** Trade pitch-shifting quality for CPU. Changes must be glitch-free.
+   */
+  virtual void setPitchHighSpeed(bool shouldUseHighSpeed) = 0;
+
   virtual int getLatency() = 0;
 
   /** Pitch shift a juce::AudioBuffer<float>
@@ -40,5 +51,11 @@ public:
    * cause less or more latency.
    */
   virtual int getLatencyEstimationInSamples() = 0;
+
+  /** Number of blocks, since construction, that couldn't be output entirely
+   * for lack of processed samples (underrun), or for which processed samples
+   * had to be held back for lack of room (overrun).
+   */
+  virtual int getNumBufferFailures() = 0;
 };
 } // namespace DavidCNAntonia
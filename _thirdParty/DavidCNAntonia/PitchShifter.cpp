@@ -1,25 +1,39 @@
 #include "PitchShifter.h"
+#include "Tracing.h"
 #include <juce_dsp/juce_dsp.h>
 
 namespace DavidCNAntonia {
 std::unique_ptr<IPitchShifter>
 IPitchShifter::createInstance(int numChannels, double sampleRate,
-                              int samplesPerBlock) {
+                              int samplesPerBlock, ProcessingMode mode) {
   return std::make_unique<PitchShifter>(numChannels, sampleRate,
-                                        samplesPerBlock, std::nullopt);
+                                        samplesPerBlock, std::nullopt, mode);
 }
 
 PitchShifter::PitchShifter(
     int numChannels, double sampleRate, int samplesPerBlock,
-    std::optional<RubberBand::RubberBandStretcher::Options> opts) {
+    std::optional<RubberBand::RubberBandStretcher::Options> opts,
+    ProcessingMode mode)
+    : processingMode(mode), bufferFail(0) {
+  const auto isOffline = mode == ProcessingMode::offline;
   rubberband = std::make_unique<RubberBand::RubberBandStretcher>(
-      static_cast<size_t>(sampleRate), numChannels, opts ? *opts : defaultOptions, 1.0, 1.0);
+      static_cast<size_t>(sampleRate), numChannels,
+      opts ? *opts : (isOffline ? offlineOptions : defaultOptions), 1.0, 1.0);
 
   initLatency = (int)rubberband->getLatency();
   maxSamples = sampleRate / 1000.0 * 4.0;
 
-  input.initialise(numChannels, sampleRate);
-  output.initialise(numChannels, sampleRate);
+  // Offline, the rings must also hold the chunks rubberband is fed (see
+  // below), and the output ring the reserve ahead of them.
+  offlineChunkSize = isOffline ? juce::jmax(samplesPerBlock, 4096) : 0;
+  const auto offlineLatency = initLatency + 2 * offlineChunkSize;
+  const auto ringSize = static_cast<int>(sampleRate);
+  const auto offlineInputSize =
+      static_cast<int>(rubberband->getPreferredStartPad()) +
+      2 * offlineChunkSize;
+  const auto offlineOutputSize = offlineLatency + 2 * offlineChunkSize;
+  input.initialise(numChannels, juce::jmax(ringSize, offlineInputSize));
+  output.initialise(numChannels, juce::jmax(ringSize, offlineOutputSize));
 
   for (int sample = 0; sample < rubberband->getPreferredStartPad();
        ++sample) { // Loop to push samples to input buffer.
@@ -47,6 +61,21 @@ PitchShifter::PitchShifter(
 
   latencyInSamples = (initLatency + maxSamples);
 
+  if (isOffline) {
+    // Rather than chasing a small output buffer by nudging the time ratio,
+    // feed rubberband large chunks and hold enough output in reserve for it
+    // never to run dry. Costs latency, which doesn't matter when bouncing.
+    rubberband->setMaxProcessSize(static_cast<size_t>(offlineChunkSize));
+    latencyInSamples = offlineLatency;
+    const auto padding = latencyInSamples - samplesToSkip;
+    for (int sample = 0; sample < padding; ++sample) {
+      for (int channel = 0; channel < numChannels; ++channel) {
+        output.pushSample(0.0, channel);
+      }
+    }
+    samplesToSkip = 0;
+  }
+
   dryWet =
       std::make_unique<juce::dsp::DryWetMixer<float>>(latencyInSamples * 2);
   dryWet->prepare(spec);
@@ -65,15 +94,100 @@ void PitchShifter::setFormantPreserving(bool shouldPreserveFormants) {
   }
 }
 
+void PitchShifter::setPitchHighSpeed(bool shouldUseHighSpeed) {
+  if (shouldUseHighSpeed != pitchHighSpeed) {
+    pitchHighSpeed = shouldUseHighSpeed;
+    // Both may be changed while processing in real-time mode.
+    rubberband->setPitchOption(
+        shouldUseHighSpeed
+            ? RubberBand::RubberBandStretcher::Option::OptionPitchHighSpeed
+            : RubberBand::RubberBandStretcher::Option::
+                  OptionPitchHighConsistency);
+  }
+}
+
 int PitchShifter::getLatency() { return latencyInSamples; }
 
 void PitchShifter::processBuffer(float *const *audio, int numberOfChannels,
                                  int numberOfSamples) {
+  SAINT_TRACE_ZONE("PitchShifter::processBuffer");
 
   juce::dsp::AudioBlock<float> block{audio,
                                      static_cast<size_t>(numberOfChannels),
                                      static_cast<size_t>(numberOfSamples)};
 
+  dryWet->pushDrySamples(block);
+
+  if (processingMode == ProcessingMode::offline) {
+    pushAndProcessOffline(block);
+  } else {
+    pushAndProcessRealtime(block);
+  }
+
+  auto availableSamples = rubberband->available();
+
+  const auto outputRoom = output.getCapacity() - output.getAvailableSamples(0);
+  if (availableSamples > outputRoom) {
+    // Overrun: leave the excess in rubberband until next time rather than
+    // overwrite what's still to be read.
+    availableSamples = juce::jmax(outputRoom, 0);
+    ++bufferFail;
+  }
+
+  if (availableSamples > 0) { // If rubberband samples are available then copy
+    // to the output ring buffer.
+    SAINT_TRACE_ZONE("RubberBandStretcher::retrieve");
+    rubberband->retrieve(output.writePointerArray(), availableSamples);
+    output.copyToBuffer(availableSamples);
+  }
+
+  auto availableOutputSamples =
+      output.getAvailableSamples(0) -
+      samplesToSkip; // Copy samples from output ring buffer to output buffer
+  // where available.
+  if (samplesToSkip > 0) {
+    int thisSkip = juce::jmin(output.getAvailableSamples(0), samplesToSkip);
+    for (int sample = 0; sample < thisSkip; ++sample) {
+      for (int channel = 0; channel < block.getNumChannels(); ++channel) {
+        output.popSample(channel);
+      }
+      samplesToSkip--;
+    }
+  }
+
+  if (availableOutputSamples >= (int)block.getNumSamples()) {
+    outputStarted = true;
+  } else if (outputStarted) {
+    // Underrun: the beginning of the block is left silent.
+    ++bufferFail;
+  }
+
+  for (int channel = 0; channel < block.getNumChannels(); ++channel) {
+    for (int sample = 0; sample < block.getNumSamples(); ++sample) {
+      if (output.getAvailableSamples(channel) > 0) {
+        block.setSample(channel,
+                        (int)((availableOutputSamples >= block.getNumSamples())
+                                  ? sample
+                                  : sample + block.getNumSamples() -
+                                        availableOutputSamples),
+                        output.popSample(channel));
+      }
+    }
+  }
+
+  if (pitchParam == 0 &&
+      mixParam != 0.0) { // Ensure no phasing with mix occurs when pitch is
+    // set to +/-0 semitones.
+    mixSmoothing.setTargetValue(0.0);
+  } else {
+    mixSmoothing.setTargetValue(mixParam / 100.0);
+  }
+  dryWet->setWetMixProportion(mixSmoothing.skip((int)block.getNumSamples()));
+  dryWet->mixWetSamples(block); // Mix in the dry signal.
+}
+
+void PitchShifter::pushAndProcessRealtime(
+    juce::dsp::AudioBlock<float> &block) {
   pitchSmoothing.setTargetValue(powf(
       2.0, pitchParam / 12)); // Convert semitone value into pitch scale value.
 
@@ -87,8 +201,6 @@ void PitchShifter::processBuffer(float *const *audio, int numberOfChannels,
     }
   }
 
-  dryWet->pushDrySamples(block);
-
   for (int sample = 0; sample < block.getNumSamples();
        ++sample) { // Loop to push samples to input buffer.
     for (int channel = 0; channel < block.getNumChannels(); channel++) {
@@ -119,6 +231,7 @@ void PitchShifter::processBuffer(float *const *audio, int numberOfChannels,
             rubberband->setPitchScale(newPitch);
             oldPitch = newPitch;
           }
+          SAINT_TRACE_ZONE("RubberBandStretcher::process");
           rubberband->process(input.readPointerArray((int)reqSamples),
                               reqSamples,
                               false); // Process stored input samples.
@@ -126,51 +239,39 @@ void PitchShifter::processBuffer(float *const *audio, int numberOfChannels,
       }
     }
   }
+}
 
-  auto availableSamples = rubberband->available();
-
-  if (availableSamples > 0) { // If rubberband samples are available then copy
-    // to the output ring buffer.
-    rubberband->retrieve(output.writePointerArray(), availableSamples);
-    output.copyToBuffer(availableSamples);
+void PitchShifter::pushAndProcessOffline(juce::dsp::AudioBlock<float> &block) {
+  // No smoothing and no time-ratio nudging: the pitch is set once per block.
+  newPitch = powf(2.0, pitchParam / 12);
+  if (oldPitch != newPitch) {
+    rubberband->setPitchScale(newPitch);
+    oldPitch = newPitch;
   }
 
-  auto availableOutputSamples =
-      output.getAvailableSamples(0) -
-      samplesToSkip; // Copy samples from output ring buffer to output buffer
-  // where available.
-  if (samplesToSkip > 0) {
-    int thisSkip = juce::jmin(output.getAvailableSamples(0), samplesToSkip);
-    for (int sample = 0; sample < thisSkip; ++sample) {
-      for (int channel = 0; channel < block.getNumChannels(); ++channel) {
-        output.popSample(channel);
-      }
-      samplesToSkip--;
+  for (int sample = 0; sample < block.getNumSamples(); ++sample) {
+    for (int channel = 0; channel < block.getNumChannels(); channel++) {
+      input.pushSample(block.getSample(channel, sample), channel);
     }
   }
+  block.clear();
 
-  for (int channel = 0; channel < block.getNumChannels(); ++channel) {
-    for (int sample = 0; sample < block.getNumSamples(); ++sample) {
-      if (output.getAvailableSamples(channel) > 0) {
-        block.setSample(channel,
-                        (int)((availableOutputSamples >= block.getNumSamples())
-                                  ? sample
-                                  : sample + block.getNumSamples() -
-                                        availableOutputSamples),
-                        output.popSample(channel));
-      }
+  while (input.getAvailableSamples(0) >= offlineChunkSize) {
+    {
+      SAINT_TRACE_ZONE("RubberBandStretcher::process");
+      rubberband->process(input.readPointerArray(offlineChunkSize),
+                          static_cast<size_t>(offlineChunkSize), false);
+    }
+    // What doesn't fit stays in rubberband until there is room.
+    const auto availableSamples =
+        juce::jmin(rubberband->available(),
+                   output.getCapacity() - output.getAvailableSamples(0));
+    if (availableSamples > 0) {
+      SAINT_TRACE_ZONE("RubberBandStretcher::retrieve");
+      rubberband->retrieve(output.writePointerArray(), availableSamples);
+      output.copyToBuffer(availableSamples);
     }
   }
-
-  if (pitchParam == 0 &&
-      mixParam != 0.0) { // Ensure no phasing with mix occurs when pitch is
-    // set to +/-0 semitones.
-    mixSmoothing.setTargetValue(0.0);
-  } else {
-    mixSmoothing.setTargetValue(mixParam / 100.0);
-  }
-  dryWet->setWetMixProportion(mixSmoothing.skip((int)block.getNumSamples()));
-  dryWet->mixWetSamples(block); // Mix in the dry signal.
 }
 
 void PitchShifter::setMixPercentage(float newPercentage) {
@@ -191,4 +292,6 @@ float PitchShifter::getSemitoneShift() { return pitchParam; }
 int PitchShifter::getLatencyEstimationInSamples() {
   return maxSamples * 3.0 + initLatency;
 }
+
+int PitchShifter::getNumBufferFailures() { return bufferFail; }
 } // namespace DavidCNAntonia
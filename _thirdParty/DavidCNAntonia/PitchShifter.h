@@ -7,6 +7,7 @@
 namespace juce {
 namespace dsp {
 template <typename T> class DryWetMixer;
+template <typename T> class AudioBlock;
 } // namespace dsp
 } // namespace juce
 
@@ -22,6 +23,18 @@ public:
       RubberBand::RubberBandStretcher::Option::OptionChannelsTogether +
       RubberBand::RubberBandStretcher::Option::OptionWindowShort;
 
+  /** Still a real-time stretcher, because the pitch changes along the way,
+   * but with the longer window and the best pitch option.
+   */
+  static const RubberBand::RubberBandStretcher::Options offlineOptions =
+      RubberBand::RubberBandStretcher::Option::OptionProcessRealTime +
+      RubberBand::RubberBandStretcher::Option::OptionPitchHighQuality +
+      RubberBand::RubberBandStretcher::Option::OptionTransientsSmooth +
+      RubberBand::RubberBandStretcher::Option::OptionPhaseIndependent +
+      RubberBand::RubberBandStretcher::Option::OptionFormantPreserved +
+      RubberBand::RubberBandStretcher::Option::OptionChannelsTogether +
+      RubberBand::RubberBandStretcher::Option::OptionWindowStandard;
+
   /** Setup the pitch shifter. By default the shifter will be setup so that the
    * dry signal isn't delayed to be given a somewhat similar latency to the wet
    * signal - this is not accurate when enabled! By enabling minLatency some
@@ -29,10 +42,13 @@ public:
    * modulation with a change of the pitch parameter.
    */
   PitchShifter(int numChannels, double sampleRate, int samplesPerBlock,
-               std::optional<RubberBand::RubberBandStretcher::Options> opts);
+               std::optional<RubberBand::RubberBandStretcher::Options> opts,
+               ProcessingMode mode = ProcessingMode::realtime);
 
   void setFormantPreserving(bool shouldPreserveFormants) override;
 
+  void setPitchHighSpeed(bool shouldUseHighSpeed) override;
+
   int getLatency() override;
 
   /** Pitch shift a juce::AudioBuffer<float>
@@ -62,7 +78,13 @@ public:
    */
   int getLatencyEstimationInSamples() override;
 
+  int getNumBufferFailures() override;
+
 private:
+  void pushAndProcessRealtime(juce::dsp::AudioBlock<float> &block);
+  void pushAndProcessOffline(juce::dsp::AudioBlock<float> &block);
+
+  const ProcessingMode processingMode;
   std::unique_ptr<RubberBand::RubberBandStretcher> rubberband;
   RingBuffer input, output;
   int maxSamples, initLatency, bufferFail, smallestAcceptableSize,
@@ -71,7 +93,10 @@ private:
   std::unique_ptr<juce::dsp::DryWetMixer<float>> dryWet;
   juce::SmoothedValue<float> timeSmoothing, mixSmoothing, pitchSmoothing;
   bool formantPreserving;
-  int latencyInSamples = 0, samplesToSkip = 0, readSpace;
+  bool pitchHighSpeed = false;
+  // Underruns are only failures once the output has begun flowing.
+  bool outputStarted = false;
+  int latencyInSamples = 0, samplesToSkip = 0, readSpace, offlineChunkSize = 0;
   size_t reqSamples;
 };
 } // namespace DavidCNAntonia
\ No newline at end of file
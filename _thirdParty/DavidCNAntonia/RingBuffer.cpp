@@ -40,6 +40,12 @@ int RingBuffer::getAvailableSamples(int channel) {
     return writePos[channel] + buffer.getNumSamples() - readPos[channel];
   }
 }
+
+int RingBuffer::getCapacity() const {
+  // One slot is lost distinguishing a full buffer from an empty one.
+  return buffer.getNumSamples() - 1;
+}
+
 const float *const *RingBuffer::readPointerArray(int reqSamples) {
   for (int sample = 0; sample < reqSamples; sample++) {
     for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
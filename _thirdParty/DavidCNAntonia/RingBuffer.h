@@ -10,6 +10,8 @@ public:
   void pushSample(float sample, int channel);
   float popSample(int channel);
   int getAvailableSamples(int channel);
+  // How many samples can be available at most.
+  int getCapacity() const;
   const float *const *readPointerArray(int reqSamples);
   float *const *writePointerArray();
   void copyToBuffer(int numSamples);
@@ -0,0 +1,93 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace saint {
+namespace benchmarks {
+namespace {
+std::atomic<bool> isCounting = false;
+std::atomic<long long> numAllocations = 0;
+std::atomic<long long> totalBytes = 0;
+std::atomic<long long> currentBytes = 0;
+std::atomic<long long> peakBytes = 0;
+
+size_t getAllocationSize(void *p) {
+#if defined(_WIN32)
+  return _msize(p);
+#elif defined(__APPLE__)
+  return malloc_size(p);
+#else
+  return malloc_usable_size(p);
+#endif
+}
+
+void *allocate(size_t size) {
+  auto p = std::malloc(size == 0 ? 1 : size);
+  if (!p) {
+    throw std::bad_alloc{};
+  }
+  if (isCounting) {
+    const auto bytes = static_cast<long long>(getAllocationSize(p));
+    ++numAllocations;
+    totalBytes += bytes;
+    const auto current = currentBytes += bytes;
+    auto peak = peakBytes.load();
+    while (current > peak && !peakBytes.compare_exchange_weak(peak, current)) {
+    }
+  }
+  return p;
+}
+
+void deallocate(void *p) {
+  if (!p) {
+    return;
+  }
+  if (isCounting) {
+    // Memory allocated before `Start` makes this go negative. That's fine:
+    // the peak is what was allocated on top of what there was at `Start`.
+    currentBytes -= static_cast<long long>(getAllocationSize(p));
+  }
+  std::free(p);
+}
+} // namespace
+
+void AllocationCounter::Start() {
+  numAllocations = 0;
+  totalBytes = 0;
+  currentBytes = 0;
+  peakBytes = 0;
+  isCounting = true;
+}
+
+void AllocationCounter::Stop(Result &result) {
+  isCounting = false;
+  result.num_allocs = numAllocations;
+  result.total_allocated_bytes = totalBytes;
+  result.max_bytes_used = peakBytes;
+  result.net_heap_growth = currentBytes;
+}
+
+void AllocationCounter::Stop(Result *result) { Stop(*result); }
+} // namespace benchmarks
+} // namespace saint
+
+void *operator new(size_t size) { return saint::benchmarks::allocate(size); }
+void *operator new[](size_t size) { return saint::benchmarks::allocate(size); }
+void operator delete(void *p) noexcept { saint::benchmarks::deallocate(p); }
+void operator delete[](void *p) noexcept { saint::benchmarks::deallocate(p); }
+void operator delete(void *p, size_t) noexcept {
+  saint::benchmarks::deallocate(p);
+}
+void operator delete[](void *p, size_t) noexcept {
+  saint::benchmarks::deallocate(p);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+namespace saint {
+namespace benchmarks {
+// Google Benchmark memory manager fed by this executable's replacement of the
+// global operator new and delete. For each benchmark it reports the number of
+// allocations, the bytes allocated and the peak heap usage in the JSON output.
+// Google Benchmark measures these over a separate run of the whole benchmark
+// function, so they include its setup: for a loading stage, the peak is that
+// of everything up to and including that stage.
+class AllocationCounter : public benchmark::MemoryManager {
+public:
+  void Start() override;
+  void Stop(Result &) override;
+  // Pure virtual, though deprecated, in the 1.7 versions of the library, gone
+  // in later ones, hence no `override`.
+  void Stop(Result *);
+};
+} // namespace benchmarks
+} // namespace saint
@@ -0,0 +1,33 @@
+#include "BenchmarkUtils.h"
+
+#include <cmath>
+
+namespace saint {
+namespace benchmarks {
+void applyAudioArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"blockSize", "sampleRate"})
+      ->ArgsProduct({benchmark::CreateRange(32, 4096, 2),
+                     {44100, 48000, 96000, 192000}});
+}
+
+std::vector<float> makeTestSignal(int sampleRate, int numSamples) {
+  constexpr auto twoPi = 6.283185307179586;
+  constexpr auto freq = 220.;
+  std::vector<float> signal(static_cast<size_t>(numSamples));
+  for (auto i = 0; i < numSamples; ++i) {
+    const auto phase = twoPi * freq * i / sampleRate;
+    signal[i] = static_cast<float>(0.4 * std::sin(phase) +
+                                   0.2 * std::sin(2 * phase) +
+                                   0.1 * std::sin(3 * phase));
+  }
+  return signal;
+}
+
+void setAudioCounters(benchmark::State &state, int sampleRate, int blockSize) {
+  state.SetItemsProcessed(state.iterations() * blockSize);
+  state.counters["realTimeFactor"] = benchmark::Counter(
+      static_cast<double>(blockSize) / sampleRate,
+      benchmark::Counter::kIsIterationInvariantRate);
+}
+} // namespace benchmarks
+} // namespace saint
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace saint {
+namespace benchmarks {
+// Block sizes from 32 to 4096 samples, times sample rates from 44.1 to
+// 192 kHz. The first argument is the block size, the second the sample rate.
+void applyAudioArgs(benchmark::internal::Benchmark *);
+
+// A 220 Hz tone with a few harmonics, for the pitch detector to have
+// something to lock on.
+std::vector<float> makeTestSignal(int sampleRate, int numSamples);
+
+// Reports samples per second and how many times faster than real time the
+// benchmarked code runs.
+void setAudioCounters(benchmark::State &, int sampleRate, int blockSize);
+} // namespace benchmarks
+} // namespace saint
@@ -0,0 +1,283 @@
+#include "BenchmarkUtils.h"
+#include "DefaultMidiFileOwner.h"
+#include "IntervalHelper.h"
+#include "JuceMidiFileUtils.h"
+#include "Score.h"
+#include "SmfParser.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace saint {
+namespace {
+namespace fs = std::filesystem;
+
+enum class Source {
+  // _assets/Hotel_California.mid, a realistic song.
+  baseline,
+  // Generated with the number of notes given as benchmark argument.
+  synthetic,
+};
+
+constexpr auto numSyntheticTracks = 16;
+constexpr auto ticksPerCrotchet = 480;
+constexpr auto playedTrack = 1;
+constexpr auto harmonyTrack = 2;
+
+// All tracks play the same quaver rhythm, the harmony a third above. Track 0
+// carries the tempo and a time signature change every bar.
+void writeSyntheticMidiFile(const fs::path &path, int numNotes) {
+  juce::MidiFile midiFile;
+  midiFile.setTicksPerQuarterNote(ticksPerCrotchet);
+  const auto notesPerTrack = std::max(numNotes / numSyntheticTracks, 1);
+  constexpr auto ticksPerNote = ticksPerCrotchet / 2;
+  const auto numTicks = notesPerTrack * ticksPerNote;
+
+  juce::MidiMessageSequence conductor;
+  conductor.addEvent(juce::MidiMessage::tempoMetaEvent(500000), 0.);
+  constexpr std::array<std::array<int, 2>, 4> signatures{
+      {{4, 4}, {3, 4}, {6, 8}, {7, 8}}};
+  auto bar = 0;
+  for (auto tick = 0; tick < numTicks; ++bar) {
+    const auto &sig = signatures[bar % signatures.size()];
+    conductor.addEvent(juce::MidiMessage::timeSignatureMetaEvent(sig[0], sig[1]),
+                       static_cast<double>(tick));
+    tick += 4 * ticksPerCrotchet * sig[0] / sig[1];
+  }
+  midiFile.addTrack(conductor);
+
+  for (auto track = 1; track < numSyntheticTracks; ++track) {
+    juce::MidiMessageSequence seq;
+    seq.addEvent(juce::MidiMessage::textMetaEvent(
+        3, "Track " + juce::String{track}));
+    const auto transposition = track == harmonyTrack ? 4 : 0;
+    for (auto i = 0; i < notesPerTrack; ++i) {
+      const auto noteNumber = 48 + (i * 7) % 24 + transposition;
+      const auto tick = static_cast<double>(i * ticksPerNote);
+      seq.addEvent(juce::MidiMessage::noteOn(track, noteNumber, 0.8f), tick);
+      seq.addEvent(juce::MidiMessage::noteOff(track, noteNumber),
+                   tick + ticksPerNote);
+    }
+    midiFile.addTrack(seq);
+  }
+  juce::File file{path.string()};
+  file.deleteFile();
+  juce::FileOutputStream stream{file};
+  midiFile.writeTo(stream);
+}
+
+fs::path getMidiFile(Source source, benchmark::State &state) {
+  if (source == Source::baseline) {
+    return fs::absolute("./saint/_assets/Hotel_California.mid");
+  }
+  const auto numNotes = static_cast<int>(state.range(0));
+  static std::map<int, fs::path> files;
+  auto &path = files[numNotes];
+  if (path.empty()) {
+    path = fs::temp_directory_path() /
+           ("saint_synthetic_" + std::to_string(numNotes) + ".mid");
+    writeSyntheticMidiFile(path, numNotes);
+  }
+  return path;
+}
+
+std::optional<juce::MidiFile> loadOrSkip(Source source,
+                                         benchmark::State &state) {
+  auto midiFile = getJuceMidiFile(getMidiFile(source, state).string());
+  if (!midiFile) {
+    state.SkipWithError("could not read the MIDI file - is the working "
+                        "directory the repository root?");
+  }
+  return midiFile;
+}
+
+int getNumNoteEvents(const juce::MidiFile &midiFile) {
+  auto num = 0;
+  for (auto i = 0; i < midiFile.getNumTracks(); ++i) {
+    const auto track = midiFile.getTrack(i);
+    for (const auto holder : *track) {
+      num += holder->message.isNoteOn() ? 1 : 0;
+    }
+  }
+  return num;
+}
+
+void setNoteCounters(benchmark::State &state, const juce::MidiFile &midiFile) {
+  const auto numNotes = getNumNoteEvents(midiFile);
+  state.counters["notes"] = numNotes;
+  state.SetItemsProcessed(state.iterations() * numNotes);
+}
+
+void MidiLoading_getJuceMidiFile(benchmark::State &state, Source source) {
+  const auto path = getMidiFile(source, state).string();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getJuceMidiFile(path));
+  }
+  if (const auto midiFile = loadOrSkip(source, state)) {
+    setNoteCounters(state, *midiFile);
+  }
+}
+
+// The parsing alone, from an already mapped file.
+void MidiLoading_parseStandardMidiFile(benchmark::State &state,
+                                       Source source) {
+  const juce::MemoryMappedFile file{
+      juce::File{getMidiFile(source, state).string()},
+      juce::MemoryMappedFile::readOnly};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        parseStandardMidiFile(file.getData(), file.getSize()));
+  }
+  if (const auto midiFile = loadOrSkip(source, state)) {
+    setNoteCounters(state, *midiFile);
+  }
+}
+
+// Everything the JUCE-based steps below do together, with the in-place
+// parser. Hits the score cache but for the first iteration if SAINT_SCORE_CACHE
+// is set to something true, see main.cpp.
+void MidiLoading_loadScore(benchmark::State &state, Source source) {
+  const auto path = getMidiFile(source, state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(loadScore(path));
+  }
+  if (const auto midiFile = loadOrSkip(source, state)) {
+    setNoteCounters(state, *midiFile);
+  }
+}
+
+void MidiLoading_getTrackNames(benchmark::State &state, Source source) {
+  const auto midiFile = loadOrSkip(source, state);
+  if (!midiFile) {
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getTrackNames(*midiFile));
+  }
+  setNoteCounters(state, *midiFile);
+}
+
+void MidiLoading_getTimeSignatures(benchmark::State &state, Source source) {
+  const auto midiFile = loadOrSkip(source, state);
+  if (!midiFile) {
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getTimeSignatures(*midiFile));
+  }
+  setNoteCounters(state, *midiFile);
+}
+
+void MidiLoading_getMidiNoteMessages(benchmark::State &state, Source source) {
+  const auto midiFile = loadOrSkip(source, state);
+  if (!midiFile) {
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getMidiNoteMessages(*midiFile, playedTrack));
+    benchmark::DoNotOptimize(getMidiNoteMessages(*midiFile, harmonyTrack));
+  }
+  setNoteCounters(state, *midiFile);
+}
+
+void MidiLoading_toIntervalSpans(benchmark::State &state, Source source) {
+  const auto midiFile = loadOrSkip(source, state);
+  if (!midiFile) {
+    return;
+  }
+  const auto played = getMidiNoteMessages(*midiFile, playedTrack);
+  const auto harmony = getMidiNoteMessages(*midiFile, harmonyTrack);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(toIntervalSpans(played, harmony));
+  }
+  setNoteCounters(state, *midiFile);
+}
+
+// Everything `setMidiFile` and the track setters do, up to the interval
+// getter being created. The score registry only keeps scores in use: each
+// iteration's owner loads it again, from the score cache if enabled.
+void MidiLoading_DefaultMidiFileOwner(benchmark::State &state, Source source) {
+  const auto path = getMidiFile(source, state);
+  for (auto _ : state) {
+    DefaultMidiFileOwner owner{[](float) {},
+                               [](PlayheadCommand) { return false; }};
+    owner.setSampleRate(44100);
+    owner.setMidiFile(path);
+    owner.setPlayedTrack(playedTrack);
+    owner.setHarmonyTrack(harmonyTrack);
+    benchmark::DoNotOptimize(owner.getIntervalGetter());
+  }
+  if (const auto midiFile = loadOrSkip(source, state)) {
+    setNoteCounters(state, *midiFile);
+  }
+}
+
+// A session of several instances on the same song, each harmonizing another
+// track. They share one score, loaded again every iteration.
+void MidiLoading_instancesOfOneSong(benchmark::State &state) {
+  constexpr auto numInstances = 8;
+  const auto path = fs::absolute("./saint/_assets/Hotel_California.mid");
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<DefaultMidiFileOwner>> owners;
+    for (auto i = 0; i < numInstances; ++i) {
+      auto &owner = owners.emplace_back(std::make_unique<DefaultMidiFileOwner>(
+          [](float) {}, [](PlayheadCommand) { return false; }));
+      owner->setSampleRate(44100);
+      owner->setMidiFile(path);
+      owner->setPlayedTrack(1 + i);
+      owner->setHarmonyTrack(2 + i);
+    }
+    benchmark::DoNotOptimize(owners);
+  }
+  state.counters["instances"] = numInstances;
+}
+
+// Auditioning harmony tracks: only the intervals are assigned again, the
+// played track's spans being kept.
+void MidiLoading_switchHarmonyTrack(benchmark::State &state, Source source) {
+  DefaultMidiFileOwner owner{[](float) {},
+                             [](PlayheadCommand) { return false; }};
+  owner.setSampleRate(44100);
+  owner.setMidiFile(getMidiFile(source, state));
+  owner.setPlayedTrack(playedTrack);
+  auto i = 0;
+  for (auto _ : state) {
+    owner.setHarmonyTrack(i++ % 2 == 0 ? harmonyTrack : harmonyTrack + 1);
+    benchmark::DoNotOptimize(owner.getIntervalGetter());
+  }
+  if (const auto midiFile = loadOrSkip(source, state)) {
+    setNoteCounters(state, *midiFile);
+  }
+}
+
+void applyNoteCounts(benchmark::internal::Benchmark *b) {
+  b->ArgName("notes")
+      ->RangeMultiplier(10)
+      ->Range(100, 1000000)
+      ->Unit(benchmark::kMillisecond);
+}
+} // namespace
+
+#define SAINT_MIDI_LOADING_BENCHMARK(name)                                     \
+  BENCHMARK_CAPTURE(name, Hotel_California, Source::baseline)                  \
+      ->Unit(benchmark::kMillisecond);                                         \
+  BENCHMARK_CAPTURE(name, synthetic, Source::synthetic)->Apply(applyNoteCounts)
+
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_getJuceMidiFile);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_parseStandardMidiFile);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_loadScore);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_getTrackNames);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_getTimeSignatures);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_getMidiNoteMessages);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_toIntervalSpans);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_DefaultMidiFileOwner);
+SAINT_MIDI_LOADING_BENCHMARK(MidiLoading_switchHarmonyTrack);
+BENCHMARK(MidiLoading_instancesOfOneSong)->Unit(benchmark::kMillisecond);
+} // namespace saint
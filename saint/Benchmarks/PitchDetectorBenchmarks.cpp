@@ -0,0 +1,26 @@
+#include "BenchmarkUtils.h"
+#include "PitchDetectorImpl.h"
+
+namespace saint {
+namespace {
+void PitchDetectorImpl_process(benchmark::State &state) {
+  const auto blockSize = static_cast<int>(state.range(0));
+  const auto sampleRate = static_cast<int>(state.range(1));
+  PitchDetectorImpl detector{sampleRate, std::nullopt, std::nullopt,
+                             PitchDetector::defaultAnalysisOverlap};
+  // Long enough a loop for the analysis frames not to always fall on the
+  // same blocks.
+  const auto signal = benchmarks::makeTestSignal(sampleRate, sampleRate);
+  const auto numBlocks = static_cast<int>(signal.size()) / blockSize;
+  auto block = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        detector.process(signal.data() + block * blockSize, blockSize));
+    block = (block + 1) % numBlocks;
+  }
+  benchmarks::setAudioCounters(state, sampleRate, blockSize);
+}
+} // namespace
+
+BENCHMARK(PitchDetectorImpl_process)->Apply(benchmarks::applyAudioArgs);
+} // namespace saint
@@ -0,0 +1,48 @@
+#include "BenchmarkUtils.h"
+#include "DavidCNAntonia/PitchShifter.h"
+#include "DavidCNAntonia/RingBuffer.h"
+
+#include <algorithm>
+
+namespace saint {
+namespace {
+void PitchShifter_processBuffer(benchmark::State &state) {
+  const auto blockSize = static_cast<int>(state.range(0));
+  const auto sampleRate = static_cast<int>(state.range(1));
+  DavidCNAntonia::PitchShifter shifter{1, static_cast<double>(sampleRate),
+                                       blockSize, std::nullopt};
+  shifter.setMixPercentage(100.f);
+  shifter.setSemitoneShift(4.f);
+  const auto signal = benchmarks::makeTestSignal(sampleRate, sampleRate);
+  const auto numBlocks = static_cast<int>(signal.size()) / blockSize;
+  std::vector<float> block(static_cast<size_t>(blockSize));
+  auto index = 0;
+  for (auto _ : state) {
+    // Processing is in-place. Next to the shifting, that copy is noise.
+    const auto begin = signal.begin() + index * blockSize;
+    std::copy(begin, begin + blockSize, block.begin());
+    auto p = block.data();
+    shifter.processBuffer(&p, 1, blockSize);
+    benchmark::ClobberMemory();
+    index = (index + 1) % numBlocks;
+  }
+  benchmarks::setAudioCounters(state, sampleRate, blockSize);
+}
+
+// Push and pop a block the way the shifter does, through the pointer arrays.
+void RingBuffer_pushAndPop(benchmark::State &state) {
+  const auto blockSize = static_cast<int>(state.range(0));
+  const auto sampleRate = static_cast<int>(state.range(1));
+  DavidCNAntonia::RingBuffer ringBuffer;
+  ringBuffer.initialise(1, sampleRate);
+  for (auto _ : state) {
+    ringBuffer.copyToBuffer(blockSize);
+    benchmark::DoNotOptimize(ringBuffer.readPointerArray(blockSize));
+  }
+  benchmarks::setAudioCounters(state, sampleRate, blockSize);
+}
+} // namespace
+
+BENCHMARK(PitchShifter_processBuffer)->Apply(benchmarks::applyAudioArgs);
+BENCHMARK(RingBuffer_pushAndPop)->Apply(benchmarks::applyAudioArgs);
+} // namespace saint
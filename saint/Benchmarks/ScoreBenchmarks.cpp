@@ -0,0 +1,100 @@
+#include "BenchmarkUtils.h"
+#include "IntervalHelper.h"
+#include "PositionGetter.h"
+
+#include <random>
+
+namespace saint {
+namespace {
+// Scattered over the whole score, so that lookups don't all hit the
+// beginning.
+std::vector<float> getQueries(float lastCrotchet) {
+  std::minstd_rand generator{0};
+  std::uniform_real_distribution<float> distribution{0.f, lastCrotchet};
+  std::vector<float> queries(1024);
+  for (auto &query : queries) {
+    query = distribution(generator);
+  }
+  return queries;
+}
+
+void getClosestLimitIndex(benchmark::State &state) {
+  const auto numLimits = static_cast<int>(state.range(0));
+  std::vector<float> limits(static_cast<size_t>(numLimits));
+  for (auto i = 0; i < numLimits; ++i) {
+    // A quaver per note.
+    limits[i] = i / 2.f;
+  }
+  const auto queries = getQueries(limits.back());
+  auto i = 0u;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ::saint::getClosestLimitIndex(limits, queries[i]));
+    i = (i + 1) % queries.size();
+  }
+  state.SetComplexityN(numLimits);
+}
+
+// Alternating 4/4 and 3/4 every bar.
+std::vector<TimeSignaturePosition> getTimeSignatures(int numTimeSignatures,
+                                                     float &lastCrotchet) {
+  std::vector<TimeSignaturePosition> positions;
+  lastCrotchet = 0.f;
+  for (auto i = 0; i < numTimeSignatures; ++i) {
+    const auto fourFour = i % 2 == 0;
+    positions.push_back({i, lastCrotchet, {fourFour ? 4 : 3, 4}});
+    lastCrotchet += fourFour ? 4.f : 3.f;
+  }
+  return positions;
+}
+
+void PositionGetter_getPosition(benchmark::State &state) {
+  const auto numTimeSignatures = static_cast<int>(state.range(0));
+  auto lastCrotchet = 0.f;
+  const PositionGetter positionGetter{
+      getTimeSignatures(numTimeSignatures, lastCrotchet)};
+  const auto queries = getQueries(lastCrotchet);
+  auto i = 0u;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(positionGetter.getPosition(queries[i]));
+    i = (i + 1) % queries.size();
+  }
+  state.SetComplexityN(numTimeSignatures);
+}
+
+void PositionGetter_getBarTimeInCrotchets(benchmark::State &state) {
+  const auto numTimeSignatures = static_cast<int>(state.range(0));
+  auto lastCrotchet = 0.f;
+  const PositionGetter positionGetter{
+      getTimeSignatures(numTimeSignatures, lastCrotchet)};
+  std::minstd_rand generator{0};
+  std::uniform_int_distribution<int> distribution{0, numTimeSignatures - 1};
+  std::vector<int> bars(1024);
+  for (auto &bar : bars) {
+    bar = distribution(generator);
+  }
+  auto i = 0u;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(positionGetter.getBarTimeInCrotchets(bars[i]));
+    i = (i + 1) % bars.size();
+  }
+  state.SetComplexityN(numTimeSignatures);
+}
+} // namespace
+
+BENCHMARK(getClosestLimitIndex)
+    ->ArgName("numLimits")
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18)
+    ->Complexity();
+BENCHMARK(PositionGetter_getPosition)
+    ->ArgName("numTimeSignatures")
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 15)
+    ->Complexity();
+BENCHMARK(PositionGetter_getBarTimeInCrotchets)
+    ->ArgName("numTimeSignatures")
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 15)
+    ->Complexity();
+} // namespace saint
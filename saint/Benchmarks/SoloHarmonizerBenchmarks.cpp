@@ -0,0 +1,73 @@
+#include "BenchmarkUtils.h"
+#include "DefaultMidiFileOwner.h"
+#include "Playheads/ProcessCallbackDrivenPlayhead.h"
+#include "SoloHarmonizer.h"
+
+#include <filesystem>
+
+namespace saint {
+namespace {
+namespace fs = std::filesystem;
+
+struct Session {
+  Session(std::shared_ptr<DefaultMidiFileOwner> midiFileOwner, int sampleRate,
+          int blockSize)
+      : playhead{sampleRate, midiFileOwner->getTempoMap()},
+        harmonizer{std::move(midiFileOwner), playhead} {
+    harmonizer.prepareToPlay(sampleRate, blockSize);
+  }
+  ProcessCallbackDrivenPlayhead playhead;
+  SoloHarmonizer harmonizer;
+};
+
+void SoloHarmonizer_processBlock(benchmark::State &state) {
+  const auto blockSize = static_cast<int>(state.range(0));
+  const auto sampleRate = static_cast<int>(state.range(1));
+  const auto midiFileOwner = std::make_shared<DefaultMidiFileOwner>(
+      [](float) {}, [](PlayheadCommand) { return false; });
+  midiFileOwner->setSampleRate(sampleRate);
+  midiFileOwner->setMidiFile(
+      fs::absolute("./saint/_assets/Les_Petits_Poissons.mid"));
+  midiFileOwner->setPlayedTrack(1);
+  midiFileOwner->setHarmonyTrack(2);
+  const auto spans = midiFileOwner->getIntervalSpans();
+  if (!spans || spans->empty()) {
+    state.SkipWithError("could not load Les_Petits_Poissons.mid - is the "
+                        "working directory the repository root?");
+    return;
+  }
+  // Start over at the end of the piece, else the shifter would soon be
+  // bypassed for lack of harmony.
+  const auto songSamples = static_cast<long long>(
+      midiFileOwner->getTempoMap()->getSeconds(spans->back().beginCrotchet) *
+      sampleRate);
+  const auto signal = benchmarks::makeTestSignal(sampleRate, sampleRate);
+  const auto numBlocks = static_cast<int>(signal.size()) / blockSize;
+  std::vector<float> block(static_cast<size_t>(blockSize));
+  auto session =
+      std::make_unique<Session>(midiFileOwner, sampleRate, blockSize);
+  auto sampleCount = 0ll;
+  auto index = 0;
+  for (auto _ : state) {
+    const auto begin = signal.begin() + index * blockSize;
+    std::copy(begin, begin + blockSize, block.begin());
+    session->harmonizer.processBlock(block.data(), blockSize);
+    session->playhead.incrementSampleCount(blockSize);
+    index = (index + 1) % numBlocks;
+    sampleCount += blockSize;
+    if (sampleCount >= songSamples) {
+      state.PauseTiming();
+      session.reset();
+      session =
+          std::make_unique<Session>(midiFileOwner, sampleRate, blockSize);
+      sampleCount = 0;
+      state.ResumeTiming();
+    }
+  }
+  benchmarks::setAudioCounters(state, sampleRate, blockSize);
+  state.counters["loadLevel"] = session->harmonizer.getLoadLevel();
+}
+} // namespace
+
+BENCHMARK(SoloHarmonizer_processBlock)->Apply(benchmarks::applyAudioArgs);
+} // namespace saint
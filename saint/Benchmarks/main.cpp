@@ -0,0 +1,63 @@
+#include "AllocationCounter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+bool hasArgument(int argc, char *argv[], const char *prefix) {
+  for (auto i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], prefix, std::strlen(prefix)) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void setEnvironmentVariableUnlessSet(const char *name, const char *value) {
+  if (std::getenv(name)) {
+    return;
+  }
+#ifdef _WIN32
+  _putenv_s(name, value);
+#else
+  setenv(name, value, 0);
+#endif
+}
+} // namespace
+
+// Same as benchmark_main, but unless told otherwise also writes the results as
+// JSON to SaintBenchmarks.json, for runs to be compared with Google
+// Benchmark's tools/compare.py. Heap usage is reported for every benchmark.
+int main(int argc, char *argv[]) {
+  // Load shedding would have the harmonizer benchmark measure whatever
+  // quality level the machine's load led to, rather than always the same code
+  // path.
+  setEnvironmentVariableUnlessSet("SAINT_LOAD_SHEDDING", "0");
+  // The on-disk score cache would have all but the first iteration of the
+  // loading benchmarks time cache hits. Set it to 1 to time those instead.
+  setEnvironmentVariableUnlessSet("SAINT_SCORE_CACHE", "0");
+  std::vector<char *> args(argv, argv + argc);
+  std::string out{"--benchmark_out=SaintBenchmarks.json"};
+  std::string format{"--benchmark_out_format=json"};
+  if (!hasArgument(argc, argv, "--benchmark_out=")) {
+    args.push_back(out.data());
+    if (!hasArgument(argc, argv, "--benchmark_out_format=")) {
+      args.push_back(format.data());
+    }
+  }
+  auto numArgs = static_cast<int>(args.size());
+  benchmark::Initialize(&numArgs, args.data());
+  if (benchmark::ReportUnrecognizedArguments(numArgs, args.data())) {
+    return 1;
+  }
+  saint::benchmarks::AllocationCounter allocationCounter;
+  benchmark::RegisterMemoryManager(&allocationCounter);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::RegisterMemoryManager(nullptr);
+  benchmark::Shutdown();
+  return 0;
+}
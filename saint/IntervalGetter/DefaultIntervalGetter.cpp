@@ -1,9 +1,12 @@
 #include "DefaultIntervalGetter.h"
+#include "DebugHooks.h"
 #include "IntervalHelper.h"
+#include "Tracing.h"
 
 #include <algorithm>
 #include <cmath>
 #include <iterator>
+#include <limits>
 
 namespace saint {
 
@@ -28,22 +31,54 @@ getNotes(const std::vector<IntervalSpan> &spans) {
 
 DefaultIntervalGetter::DefaultIntervalGetter(
     const std::vector<IntervalSpan> &spans,
-    std::optional<testUtils::IntervalGetterDebugCb> debugCb)
-    : _debugCb(std::move(debugCb)), _crotchets(getCrotchets(spans)),
-      _intervals(getNotes(spans)) {}
+    [[maybe_unused]] std::unique_ptr<testUtils::IntervalGetterDebugSink>
+        debugSink)
+    :
+#ifdef SAINT_DEBUG_HOOKS
+      _debugSink(std::move(debugSink)),
+#endif
+      _crotchets(getCrotchets(spans)), _intervals(getNotes(spans)) {}
 
-std::optional<float> DefaultIntervalGetter::getHarmoInterval(
-    float timeInCrotchets, const std::optional<float> &pitch, int blockSize) {
+std::optional<float>
+DefaultIntervalGetter::getHarmoInterval(float timeInCrotchets,
+                                        const std::optional<float> &pitch,
+                                        [[maybe_unused]] int blockSize) {
+  SAINT_TRACE_ZONE("DefaultIntervalGetter::getHarmoInterval");
   const auto interval = _getHarmoInterval(timeInCrotchets, pitch);
-  if (_debugCb) {
-    testUtils::IntervalGetterDebugCbArgs args{_crotchets, pitch, interval};
-    args.newIndex = _currentIndex;
-    args.blockSize = blockSize;
-    (*_debugCb)(args);
-  }
+  SAINT_DEBUG_HOOK(_debugSink,
+                   onHarmoInterval({_crotchets, timeInCrotchets, pitch,
+                                    interval, _currentIndex, blockSize}));
   return interval;
 }
 
+void DefaultIntervalGetter::reset() { _prevWasPitched = false; }
+
+bool DefaultIntervalGetter::hasHarmonyBetween(float beginCrotchet,
+                                              float endCrotchet) const {
+  // Because `getClosestLimitIndex` snaps to the closest limit, span `i` may be
+  // returned anywhere within [_crotchets[i - 1], _crotchets[i + 1]).
+  const auto numSpans = static_cast<int>(_crotchets.size());
+  const auto first = std::upper_bound(_crotchets.begin(), _crotchets.end(),
+                                      beginCrotchet) -
+                     _crotchets.begin();
+  for (auto i = std::max(static_cast<int>(first) - 2, 0); i < numSpans; ++i) {
+    const auto earliest = i > 0 ? _crotchets[i - 1]
+                                : 2 * _crotchets[0] -
+                                      (numSpans > 1 ? _crotchets[1]
+                                                    : _crotchets[0]);
+    if (earliest >= endCrotchet) {
+      break;
+    }
+    const auto latest = i + 1 < numSpans ? _crotchets[i + 1]
+                                         : std::numeric_limits<float>::max();
+    const auto &note = _intervals[i];
+    if (latest > beginCrotchet && note && note->interval) {
+      return true;
+    }
+  }
+  return false;
+}
+
 std::optional<float>
 DefaultIntervalGetter::_getHarmoInterval(float timeInCrotchets,
                                          const std::optional<float> &pitch) {
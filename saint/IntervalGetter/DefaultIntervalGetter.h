@@ -2,24 +2,32 @@
 
 #include "CommonTypes.h"
 #include "IntervalGetter.h"
-#include "IntervalGetterDebugCb.h"
+#include "IntervalGetterDebugSink.h"
 
+#include <memory>
 #include <vector>
 
 namespace saint {
 class DefaultIntervalGetter : public IntervalGetter {
 public:
-  DefaultIntervalGetter(const std::vector<IntervalSpan> &timeSegments,
-                        std::optional<testUtils::IntervalGetterDebugCb>);
+  // `debugSink` is ignored unless SAINT_DEBUG_HOOKS is defined.
+  DefaultIntervalGetter(
+      const std::vector<IntervalSpan> &timeSegments,
+      std::unique_ptr<testUtils::IntervalGetterDebugSink> debugSink);
   std::optional<float> getHarmoInterval(float timeInCrotchets,
                                         const std::optional<float> &pitch,
                                         int blockSize = 0) override;
+  void reset() override;
+  bool hasHarmonyBetween(float beginCrotchet,
+                         float endCrotchet) const override;
 
 private:
   std::optional<float> _getInterval() const;
   std::optional<float> _getHarmoInterval(float timeInCrotchets,
                                          const std::optional<float> &pitch);
-  const std::optional<testUtils::IntervalGetterDebugCb> _debugCb;
+#ifdef SAINT_DEBUG_HOOKS
+  const std::unique_ptr<testUtils::IntervalGetterDebugSink> _debugSink;
+#endif
   const std::vector<float> _crotchets;
   const std::vector<std::optional<PlayedNote>> _intervals;
   bool _prevWasPitched = false;
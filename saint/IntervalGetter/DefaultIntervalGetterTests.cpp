@@ -25,7 +25,7 @@ TEST(DefaultIntervalGetter, returns_nullopt_if_no_interval) {
           {0.f, aloneA4}, // not an interval, just a note by itself
           {1.f, noNote},
       },
-      std::nullopt};
+      nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, 123.f), Eq(std::nullopt));
 }
 
@@ -35,7 +35,7 @@ TEST(DefaultIntervalGetter,
                                 {0.f, minor3rdB4},
                                 {1.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, 0.f), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(0.f, 100.f), Optional(3.f));
 }
@@ -53,7 +53,7 @@ TEST(DefaultIntervalGetter, natural_scenario) {
                                 {2.f, major3rdB4},
                                 {5.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, 123.f), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(1.f, 234.f), Optional(3.f));
   // This tick cuts a major 3rd, but the interval state sticks because the pitch
@@ -70,6 +70,20 @@ TEST(DefaultIntervalGetter, natural_scenario) {
   EXPECT_THAT(sut.getHarmoInterval(6.f, std::nullopt), Eq(std::nullopt));
 }
 
+TEST(DefaultIntervalGetter, looks_the_time_up_again_after_a_reset) {
+  DefaultIntervalGetter sut{{
+                                {0.f, minor3rdB4},
+                                {2.f, major3rdB4},
+                                {4.f, noNote},
+                            },
+                            nullptr};
+  EXPECT_THAT(sut.getHarmoInterval(2.5f, 123.f), Optional(4.f));
+  // E.g. a loop back to its beginning while the note is still held.
+  EXPECT_THAT(sut.getHarmoInterval(0.f, 123.f), Optional(4.f));
+  sut.reset();
+  EXPECT_THAT(sut.getHarmoInterval(0.f, 123.f), Optional(3.f));
+}
+
 TEST(DefaultIntervalGetter, no_pitch_to_no_pitch) {
   DefaultIntervalGetter sut{{
                                 {0.f, noNote},
@@ -77,7 +91,7 @@ TEST(DefaultIntervalGetter, no_pitch_to_no_pitch) {
                                 {2.f, major3rdB4},
                                 {3.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, std::nullopt), Eq(std::nullopt));
   EXPECT_THAT(sut.getHarmoInterval(1.f, std::nullopt), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(2.f, std::nullopt), Optional(4.f));
@@ -90,7 +104,7 @@ TEST(DefaultIntervalGetter, no_pitch_to_yes_pitch) {
                                 {1.f, major3rdB4},
                                 {2.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, std::nullopt), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(1.f, 123.f), Optional(4.f));
 }
@@ -101,7 +115,7 @@ TEST(DefaultIntervalGetter, yes_pitch_to_yes_pitch) {
                                 {1.f, major3rdB4},
                                 {2.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, 123.f), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(1.f, 123.f), Optional(3.f));
 }
@@ -112,7 +126,7 @@ TEST(DefaultIntervalGetter, yes_pitch_to_no_pitch) {
                                 {1.f, major3rdB4},
                                 {2.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(0.f, 123.f), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(1.f, std::nullopt), Optional(4.f));
 }
@@ -124,10 +138,30 @@ TEST(DefaultIntervalGetter, snaps_interval_to_onset_closest_to_playhead) {
                                 {6.f, major3rdB4},
                                 {9.f, noNote},
                             },
-                            std::nullopt};
+                            nullptr};
   EXPECT_THAT(sut.getHarmoInterval(1.f, std::nullopt), Eq(std::nullopt));
   EXPECT_THAT(sut.getHarmoInterval(4.f, std::nullopt), Optional(3.f));
   EXPECT_THAT(sut.getHarmoInterval(5.f, std::nullopt), Optional(4.f));
   EXPECT_THAT(sut.getHarmoInterval(7.f, std::nullopt), Optional(4.f));
   EXPECT_THAT(sut.getHarmoInterval(8.f, std::nullopt), Optional(4.f));
 }
+
+TEST(DefaultIntervalGetter, has_harmony_between) {
+  DefaultIntervalGetter sut{{
+                                {0.f, aloneA4},
+                                {3.f, minor3rdB4},
+                                {6.f, major3rdB4},
+                                {9.f, noNote},
+                                {12.f, aloneA4},
+                                {15.f, noNote},
+                            },
+                            nullptr};
+  EXPECT_FALSE(sut.hasHarmonyBetween(-5.f, -4.f));
+  EXPECT_TRUE(sut.hasHarmonyBetween(1.f, 2.f));
+  EXPECT_TRUE(sut.hasHarmonyBetween(4.f, 5.f));
+  EXPECT_TRUE(sut.hasHarmonyBetween(8.f, 10.f));
+  EXPECT_FALSE(sut.hasHarmonyBetween(10.f, 11.f));
+  EXPECT_FALSE(sut.hasHarmonyBetween(13.f, 20.f));
+  // Snapping may bring the minor third up to 3 crotchets early.
+  EXPECT_TRUE(sut.hasHarmonyBetween(-1.f, 0.5f));
+}
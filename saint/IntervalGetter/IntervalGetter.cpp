@@ -1,25 +1,26 @@
 #include "IntervalGetter.h"
 #include "DefaultIntervalGetter.h"
-#include "IntervalGetterDebugCb.h"
+#include "IntervalGetterDebugSink.h"
 #include "Utils.h"
 
 #include <cassert>
 
 namespace saint {
 std::shared_ptr<IntervalGetter>
-IntervalGetter::createInstance(const std::vector<IntervalSpan> &spans,
-                               const std::optional<int> &samplesPerSecond,
-                               const std::optional<float> &crotchetsPerSecond) {
+IntervalGetter::createInstance(
+    const std::vector<IntervalSpan> &spans,
+    [[maybe_unused]] const std::optional<int> &samplesPerSecond,
+    [[maybe_unused]] const std::optional<float> &crotchetsPerSecond) {
   // TODO: No need to wrap IntervalGetter
-  if (utils::getEnvironmentVariableAsBool("SAINT_DEBUG_INTERVALGETTER") &&
-      utils::isDebugBuild()) {
+#ifdef SAINT_DEBUG_HOOKS
+  if (utils::getEnvironmentVariableAsBool("SAINT_DEBUG_INTERVALGETTER")) {
     assert(samplesPerSecond.has_value());
     assert(crotchetsPerSecond.has_value());
     const auto crotchetsPerSample = *crotchetsPerSecond / *samplesPerSecond;
     return std::make_shared<DefaultIntervalGetter>(
-        spans, testUtils::getIntervalGetterDebugCb(crotchetsPerSample));
-  } else {
-    return std::make_shared<DefaultIntervalGetter>(spans, std::nullopt);
+        spans, testUtils::makeIntervalGetterDebugSink(crotchetsPerSample));
   }
+#endif
+  return std::make_shared<DefaultIntervalGetter>(spans, nullptr);
 }
 } // namespace saint
\ No newline at end of file
@@ -22,5 +22,15 @@ public:
   virtual std::optional<float>
   getHarmoInterval(float timeInCrotchets, const std::optional<float> &pitch,
                    int blockSize = 0) = 0;
+
+  // Forgets the note it was on, e.g. because the playhead jumped back to the
+  // beginning of a loop: the next call looks the time up whatever the pitch.
+  virtual void reset() = 0;
+
+  // Whether some harmonized note may be returned by `getHarmoInterval` for a
+  // time within [begin, end). Conservative: may return true where
+  // `getHarmoInterval` eventually returns nullopt, never the other way round.
+  virtual bool hasHarmonyBetween(float beginCrotchet,
+                                 float endCrotchet) const = 0;
 };
 } // namespace saint
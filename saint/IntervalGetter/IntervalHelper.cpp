@@ -1,5 +1,6 @@
 #include "IntervalHelper.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iterator>
 
@@ -47,13 +48,10 @@ std::optional<int> getClosestLimitIndex(const std::vector<float> &intervals,
 }
 
 std::vector<IntervalSpan>
-toIntervalSpans(const std::vector<MidiNoteMsg> &playedMidiTrack,
-                const std::vector<MidiNoteMsg> &harmoMidiTrack) {
+toPlayedSpans(const std::vector<MidiNoteMsg> &playedMidiTrack) {
   std::vector<IntervalSpan> spans;
-  auto harmoIt = harmoMidiTrack.begin();
-  for (auto playedIt = playedMidiTrack.begin();
-       playedIt != playedMidiTrack.end(); ++playedIt) {
-    const auto &played = *playedIt;
+  spans.reserve(playedMidiTrack.size() + 1);
+  for (const auto &played : playedMidiTrack) {
     if (!played.isNoteOn) {
       spans.push_back({played.crotchet, std::nullopt});
       continue;
@@ -66,29 +64,45 @@ toIntervalSpans(const std::vector<MidiNoteMsg> &playedMidiTrack,
     }
     spans.push_back(
         {played.crotchet, PlayedNote{played.noteNumber, std::nullopt}});
+  }
+  if (spans.size() > 0 && spans[0].beginCrotchet > 0) {
+    spans.insert(spans.begin(), {0, std::nullopt});
+  }
+  return spans;
+}
+
+void assignIntervals(std::vector<IntervalSpan> &spans,
+                     const std::vector<MidiNoteMsg> &harmoMidiTrack) {
+  auto harmoIt = harmoMidiTrack.begin();
+  for (auto &span : spans) {
+    if (!span.playedNote) {
+      continue;
+    }
+    auto &played = *span.playedNote;
+    played.interval.reset();
     // Look for harmonized note at that crotchet ...
     harmoIt = std::find_if(
-        harmoIt, harmoMidiTrack.end(), [&played](const MidiNoteMsg &harmo) {
-          return harmo.isNoteOn && harmo.crotchet >= played.crotchet;
+        harmoIt, harmoMidiTrack.end(), [&span](const MidiNoteMsg &harmo) {
+          return harmo.isNoteOn && harmo.crotchet >= span.beginCrotchet;
         });
     if (harmoIt == harmoMidiTrack.end()) {
       // ... no harmonized note anymore.
       continue;
     }
-    const auto &harmonyMsg = (*harmoIt);
-    if (harmonyMsg.crotchet > played.crotchet) {
+    if (harmoIt->crotchet > span.beginCrotchet) {
       // Looks like played and harmony are not homorythmic - TODO issue a
       // warning ?
       continue;
-    } else {
-      // Get note value
-      spans.back().playedNote->interval =
-          harmonyMsg.noteNumber - played.noteNumber;
     }
+    played.interval = harmoIt->noteNumber - played.noteNumber;
   }
-  if (spans.size() > 0 && spans[0].beginCrotchet > 0) {
-    spans.insert(spans.begin(), {0, std::nullopt});
-  }
+}
+
+std::vector<IntervalSpan>
+toIntervalSpans(const std::vector<MidiNoteMsg> &playedMidiTrack,
+                const std::vector<MidiNoteMsg> &harmoMidiTrack) {
+  auto spans = toPlayedSpans(playedMidiTrack);
+  assignIntervals(spans, harmoMidiTrack);
   return spans;
 }
 } // namespace saint
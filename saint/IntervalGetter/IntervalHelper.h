@@ -8,6 +8,17 @@ namespace saint {
 std::optional<int> getClosestLimitIndex(const std::vector<float> &intervals,
                                         float crotchet);
 
+// The spans of the played track, with no intervals yet. They only depend on
+// the played track, so they can be kept while harmony tracks are tried.
+std::vector<IntervalSpan>
+toPlayedSpans(const std::vector<MidiNoteMsg> &playedMidiTrack);
+
+// Sets the interval of each played note to the harmony note starting with it,
+// if any, in one pass over both. Intervals already set are overwritten.
+void assignIntervals(std::vector<IntervalSpan> &spans,
+                     const std::vector<MidiNoteMsg> &harmoMidiTrack);
+
+// `toPlayedSpans` followed by `assignIntervals`.
 std::vector<IntervalSpan>
 toIntervalSpans(const std::vector<MidiNoteMsg> &playedMidiTrack,
                 const std::vector<MidiNoteMsg> &harmoMidiTrack);
@@ -59,4 +59,25 @@ TEST(toIntervalSpans, variousTests) {
   EXPECT_EQ(expected, actual);
 }
 
+TEST(assignIntervals, replaces_the_intervals_of_another_harmony_track) {
+  const std::vector<MidiNoteMsg> playedMidiTrack{{1.f, true, 69},
+                                                 {2.f, false, 69},
+                                                 {2.f, true, 71},
+                                                 {4.f, true, 72},
+                                                 {10.f, false, 72}};
+  const std::vector<MidiNoteMsg> thirds{{2.f, true, 74}, {4.f, true, 76}};
+  const std::vector<MidiNoteMsg> fifths{{1.f, true, 76}, {4.f, true, 79}};
+  auto spans = toPlayedSpans(playedMidiTrack);
+  assignIntervals(spans, thirds);
+  EXPECT_EQ(toIntervalSpans(playedMidiTrack, thirds), spans);
+
+  assignIntervals(spans, fifths);
+  const std::vector<IntervalSpan> expected{{0.f, std::nullopt},
+                                           {1.f, PlayedNote{69, 7}},
+                                           {2.f, PlayedNote{71, std::nullopt}},
+                                           {4.f, PlayedNote{72, 7}},
+                                           {10.f, std::nullopt}};
+  EXPECT_EQ(expected, spans);
+}
+
 } // namespace saint
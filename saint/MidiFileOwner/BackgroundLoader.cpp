@@ -0,0 +1,66 @@
+#include "BackgroundLoader.h"
+#include "Tracing.h"
+
+namespace saint {
+BackgroundLoader::BackgroundLoader(Post post)
+    : _post(std::move(post)),
+      _generation(std::make_shared<std::atomic<std::uint64_t>>(0)),
+      _thread([this] { _run(); }) {}
+
+BackgroundLoader::~BackgroundLoader() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _quit = true;
+    _pendingJob = nullptr;
+  }
+  ++*_generation;
+  _condition.notify_one();
+  _thread.join();
+}
+
+void BackgroundLoader::submit(Job job) {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _pendingJob = std::move(job);
+    _pendingGeneration = ++*_generation;
+  }
+  _condition.notify_one();
+}
+
+void BackgroundLoader::cancel() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _pendingJob = nullptr;
+  ++*_generation;
+}
+
+void BackgroundLoader::_run() {
+  tracing::setThreadName("background loader");
+  while (true) {
+    Job job;
+    std::uint64_t generation = 0;
+    {
+      std::unique_lock<std::mutex> lock{_mutex};
+      _condition.wait(lock, [this] { return _quit || _pendingJob; });
+      if (_quit) {
+        return;
+      }
+      job = std::move(_pendingJob);
+      _pendingJob = nullptr;
+      generation = _pendingGeneration;
+    }
+    auto deliver = job();
+    // Superseded already: no need to bother the delivery thread.
+    if (!deliver || *_generation != generation) {
+      continue;
+    }
+    _post([weakGeneration = std::weak_ptr<std::atomic<std::uint64_t>>{
+               _generation},
+           generation, deliver = std::move(deliver)] {
+      const auto current = weakGeneration.lock();
+      if (current && *current == generation) {
+        deliver();
+      }
+    });
+  }
+}
+} // namespace saint
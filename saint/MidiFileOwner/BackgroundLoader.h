@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace saint {
+// Runs jobs on a worker thread, one at a time, and hands their results back to
+// another thread, typically the message thread. Only the latest job matters:
+// a job that hasn't started when another is submitted is dropped, and the
+// result of one that has is discarded.
+class BackgroundLoader {
+public:
+  // Runs a function on the thread the results are delivered to.
+  using Post = std::function<void(std::function<void()>)>;
+  // Runs on the worker thread, returning what to do with the result on the
+  // delivery thread.
+  using Job = std::function<std::function<void()>()>;
+
+  explicit BackgroundLoader(Post);
+  // Waits for the job under way, if any, and discards its result, as well as
+  // results posted but not delivered yet. To be destroyed on the delivery
+  // thread.
+  ~BackgroundLoader();
+
+  void submit(Job);
+  // Drops the pending job and discards the result of the one under way.
+  void cancel();
+
+private:
+  void _run();
+
+  const Post _post;
+  // Shared with the posted deliveries, so that they can tell if they're still
+  // wanted, even after the loader is gone.
+  const std::shared_ptr<std::atomic<std::uint64_t>> _generation;
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  Job _pendingJob;
+  std::uint64_t _pendingGeneration = 0;
+  bool _quit = false;
+  std::thread _thread;
+};
+} // namespace saint
@@ -0,0 +1,102 @@
+#include "BackgroundLoader.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+// Stands for the message thread: deliveries are run when the test says so.
+class DeliveryQueue {
+public:
+  BackgroundLoader::Post getPost() {
+    return [this](std::function<void()> f) {
+      std::lock_guard<std::mutex> lock{_mutex};
+      _functions.push_back(std::move(f));
+      _condition.notify_one();
+    };
+  }
+
+  // Waits for `n` deliveries to have been posted and runs all posted so far.
+  void runWhenPosted(size_t n) {
+    std::deque<std::function<void()>> functions;
+    {
+      std::unique_lock<std::mutex> lock{_mutex};
+      ASSERT_TRUE(_condition.wait_for(lock, std::chrono::seconds{5},
+                                      [&] { return _functions.size() >= n; }));
+      std::swap(functions, _functions);
+    }
+    for (auto &f : functions) {
+      f();
+    }
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  std::deque<std::function<void()>> _functions;
+};
+
+BackgroundLoader::Job makeJob(std::vector<int> &delivered, int value) {
+  return [&delivered, value] {
+    return std::function<void()>{[&delivered, value] {
+      delivered.push_back(value);
+    }};
+  };
+}
+} // namespace
+
+TEST(BackgroundLoader, delivers_the_result_through_post) {
+  DeliveryQueue queue;
+  std::vector<int> delivered;
+  BackgroundLoader sut{queue.getPost()};
+  sut.submit(makeJob(delivered, 1));
+  queue.runWhenPosted(1);
+  EXPECT_THAT(delivered, ElementsAre(1));
+}
+
+TEST(BackgroundLoader, discards_the_result_of_a_superseded_job) {
+  DeliveryQueue queue;
+  std::vector<int> delivered;
+  BackgroundLoader sut{queue.getPost()};
+  std::promise<void> started;
+  std::promise<void> release;
+  sut.submit([&] {
+    started.set_value();
+    release.get_future().wait();
+    return std::function<void()>{[&] { delivered.push_back(1); }};
+  });
+  started.get_future().wait();
+  sut.submit(makeJob(delivered, 2));
+  release.set_value();
+  queue.runWhenPosted(1);
+  EXPECT_THAT(delivered, ElementsAre(2));
+}
+
+TEST(BackgroundLoader, drops_deliveries_after_cancel_or_destruction) {
+  DeliveryQueue queue;
+  std::vector<int> delivered;
+  {
+    BackgroundLoader sut{queue.getPost()};
+    sut.submit(makeJob(delivered, 1));
+    // Let it be posted, then cancel before it is run.
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    sut.cancel();
+    queue.runWhenPosted(0);
+    sut.submit(makeJob(delivered, 2));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  }
+  queue.runWhenPosted(0);
+  EXPECT_THAT(delivered, IsEmpty());
+}
+} // namespace saint
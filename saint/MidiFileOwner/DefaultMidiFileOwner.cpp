@@ -4,6 +4,9 @@
 #include "IntervalHelper.h"
 #include "JuceMidiFileUtils.h"
 #include "PositionGetter.h"
+#include "ScoreCache.h"
+#include "ScoreRegistry.h"
+#include "Tracing.h"
 #include "Utils.h"
 
 #include <algorithm>
@@ -17,9 +20,13 @@ namespace saint {
 
 DefaultMidiFileOwner::DefaultMidiFileOwner(
     OnCrotchetsPerSecondAvailable onCrotchetsPerSecondAvailable,
-    OnPlayheadCommand onPlayheadCommand)
+    OnPlayheadCommand onPlayheadCommand,
+    BackgroundLoader::Post postToMessageThread)
     : _onCrotchetsPerSecondAvailable(onCrotchetsPerSecondAvailable),
-      _onPlayheadCommand(onPlayheadCommand) {}
+      _onPlayheadCommand(onPlayheadCommand),
+      _loader(postToMessageThread ? std::make_unique<BackgroundLoader>(
+                                        std::move(postToMessageThread))
+                                  : nullptr) {}
 
 void DefaultMidiFileOwner::setSampleRate(int sampleRate) {
   _samplesPerSecond = sampleRate;
@@ -39,12 +46,28 @@ void DefaultMidiFileOwner::setMidiFile(std::filesystem::path path) {
   _setMidiFile(std::move(path), true);
 }
 
+void DefaultMidiFileOwner::loadMidiFile(std::filesystem::path path) {
+  _startLoading(std::move(path));
+}
+
+void DefaultMidiFileOwner::setScore(std::shared_ptr<const Score> score) {
+  auto path = score ? score->path : std::filesystem::path{};
+  _setScore(std::move(path), std::move(score), true);
+}
+
 std::optional<std::filesystem::path> DefaultMidiFileOwner::getMidiFile() const {
   return _midiFilePath;
 }
 
 std::map<int, std::string> DefaultMidiFileOwner::getMidiFileTrackNames() const {
-  return _trackNames;
+  return _score ? _score->trackNames : std::map<int, std::string>{};
+}
+
+std::shared_ptr<const TempoMap> DefaultMidiFileOwner::getTempoMap() const {
+  if (!_score) {
+    return nullptr;
+  }
+  return std::shared_ptr<const TempoMap>{_score, &_score->tempoMap};
 }
 
 void DefaultMidiFileOwner::setPlayedTrack(int track) {
@@ -123,8 +146,9 @@ std::optional<int> getIntValue(juce::XmlElement &parent,
 
 std::vector<char> DefaultMidiFileOwner::getState() const {
   juce::XmlElement state{"SoloHarmonizerState"};
-  if (_midiFilePath) {
-    addChildElement(state, "MidiFile", _midiFilePath->string());
+  // The file being loaded is the one the user wants.
+  if (const auto path = _loadingMidiFile ? _loadingMidiFile : _midiFilePath) {
+    addChildElement(state, "MidiFile", path->string());
   }
   if (_playedTrack.has_value()) {
     addChildElement(state, "PlayedTrack", std::to_string(*_playedTrack));
@@ -152,11 +176,11 @@ void DefaultMidiFileOwner::setState(std::vector<char> data) {
     return;
   }
   auto somethingChanged = false;
+  std::optional<std::filesystem::path> midiFile;
   if (const auto pathStr = getChildText(*newState, "MidiFile")) {
     const std::filesystem::path path{*pathStr};
     if (std::filesystem::exists(path)) {
-      _setMidiFile(path, false);
-      somethingChanged = true;
+      midiFile = path;
     } else {
       // TODO handle
     }
@@ -180,29 +204,44 @@ void DefaultMidiFileOwner::setState(std::vector<char> data) {
   }
 
   if (somethingChanged) {
-    _createIntervalGetterIfAllParametersSet();
+    if (!midiFile) {
+      _createIntervalGetterIfAllParametersSet();
+    }
     for (auto listener : _listeners) {
       listener->onStateChange();
     }
   }
+  if (midiFile) {
+    // Last, for the tracks to be compiled together with the score.
+    _startLoading(std::move(*midiFile));
+  }
 }
 
 bool DefaultMidiFileOwner::hasIntervalGetter() const {
-  return _intervalGetter.use_count() > 0;
+  return _audioThreadIntervalGetter.load(std::memory_order_relaxed) != nullptr;
 }
 
 std::shared_ptr<IntervalGetter>
 DefaultMidiFileOwner::getIntervalGetter() const {
-  return _intervalGetter;
+  return std::atomic_load(&_intervalGetter);
+}
+
+IntervalGetter *DefaultMidiFileOwner::getAudioThreadIntervalGetter() const {
+  const auto intervalGetter =
+      _audioThreadIntervalGetter.load(std::memory_order_acquire);
+  // Done with the one got before, then.
+  _intervalGetterSeenByAudioThread.store(intervalGetter,
+                                         std::memory_order_release);
+  return intervalGetter;
 }
 
 bool DefaultMidiFileOwner::hasPositionGetter() const {
-  return _positionGetter.use_count() > 0;
+  return _hasPositionGetter.load(std::memory_order_relaxed);
 }
 
 std::shared_ptr<PositionGetter>
 DefaultMidiFileOwner::getPositionGetter() const {
-  return _positionGetter;
+  return std::atomic_load(&_positionGetter);
 }
 
 std::optional<std::vector<IntervalSpan>>
@@ -232,22 +271,121 @@ std::optional<float> getLowestPlayedTrackHarmonizedFrequency(
 }
 } // namespace
 
+std::optional<DefaultMidiFileOwner::CompiledIntervals>
+DefaultMidiFileOwner::_compileIntervals(
+    const Score &score, int playedTrack, int harmonyTrack,
+    const std::optional<int> &samplesPerSecond, const ScoreCache *cache,
+    const std::vector<IntervalSpan> *playedSpans) {
+  const auto numTracks = static_cast<int>(score.noteMessages.size());
+  if (playedTrack < 0 || playedTrack >= numTracks || harmonyTrack < 0 ||
+      harmonyTrack >= numTracks) {
+    return std::nullopt;
+  }
+  CompiledIntervals compiled;
+  compiled.playedTrack = playedTrack;
+  compiled.harmonyTrack = harmonyTrack;
+  compiled.samplesPerSecond = samplesPerSecond;
+  auto cachedSpans = cache ? cache->loadIntervalSpans(score.contentHash,
+                                                      playedTrack, harmonyTrack)
+                           : std::nullopt;
+  if (cachedSpans) {
+    compiled.spans = std::move(*cachedSpans);
+  } else {
+    compiled.spans = playedSpans
+                         ? *playedSpans
+                         : toPlayedSpans(score.noteMessages[playedTrack]);
+    assignIntervals(compiled.spans, score.noteMessages[harmonyTrack]);
+    if (cache) {
+      cache->saveIntervalSpans(score.contentHash, playedTrack, harmonyTrack,
+                               compiled.spans);
+    }
+  }
+  compiled.lowestPlayedTrackHarmonizedFrequency =
+      ::saint::getLowestPlayedTrackHarmonizedFrequency(compiled.spans);
+  if (!compiled.spans.empty()) {
+    compiled.intervalGetter = IntervalGetter::createInstance(
+        compiled.spans, samplesPerSecond, score.crotchetsPerSecond);
+  }
+  return compiled;
+}
+
+void DefaultMidiFileOwner::_startLoading(std::filesystem::path path) {
+  _loadingMidiFile = path;
+  for (auto listener : _listeners) {
+    listener->onMidiFileLoadStarted(path);
+  }
+  if (!_loader) {
+    auto score = ScoreRegistry::getDefault().getScore(path);
+    _finishLoading(std::move(path), std::move(score), std::nullopt);
+    return;
+  }
+  // Compiled for the tracks selected now. Should the selection change by the
+  // time the score is published, it is compiled again then.
+  _loader->submit([this, path, playedTrack = _playedTrack,
+                   harmonyTrack = _harmonyTrack,
+                   samplesPerSecond = _samplesPerSecond]() {
+    SAINT_TRACE_ZONE("DefaultMidiFileOwner load");
+    auto score = ScoreRegistry::getDefault().getScore(path);
+    std::optional<CompiledIntervals> intervals;
+    if (score && playedTrack && harmonyTrack) {
+      intervals = _compileIntervals(*score, *playedTrack, *harmonyTrack,
+                                    samplesPerSecond, ScoreCache::getDefault());
+    }
+    // Only called on the message thread, if this load is still wanted.
+    return std::function<void()>{[this, path, score, intervals]() {
+      _finishLoading(path, score, intervals);
+    }};
+  });
+}
+
+void DefaultMidiFileOwner::_finishLoading(
+    std::filesystem::path path, std::shared_ptr<const Score> score,
+    std::optional<CompiledIntervals> intervals) {
+  _loadingMidiFile.reset();
+  if (!score) {
+    for (auto listener : _listeners) {
+      listener->onMidiFileLoaded(path, false);
+    }
+    return;
+  }
+  _setScore(path, std::move(score), false);
+  if (intervals && intervals->playedTrack == _playedTrack &&
+      intervals->harmonyTrack == _harmonyTrack &&
+      intervals->samplesPerSecond == _samplesPerSecond) {
+    _applyIntervals(*intervals);
+  } else {
+    _createIntervalGetterIfAllParametersSet();
+  }
+  for (auto listener : _listeners) {
+    listener->onMidiFileLoaded(path, true);
+  }
+  for (auto listener : _listeners) {
+    listener->onStateChange();
+  }
+}
+
 void DefaultMidiFileOwner::_setMidiFile(
     std::filesystem::path path, bool createIntervalGetterIfAllParametersSet) {
-  _juceMidiFile = getJuceMidiFile(path.string());
+  auto score = ScoreRegistry::getDefault().getScore(path);
+  _setScore(std::move(path), std::move(score),
+            createIntervalGetterIfAllParametersSet);
+}
+
+void DefaultMidiFileOwner::_setScore(
+    std::filesystem::path path, std::shared_ptr<const Score> score,
+    bool createIntervalGetterIfAllParametersSet) {
+  _score = std::move(score);
   _midiFilePath = std::move(path);
-  _trackNames = _juceMidiFile ? getTrackNames(*_juceMidiFile)
-                              : std::map<int, std::string>{};
-  _crotchetsPerSecond = _juceMidiFile
-                            ? extractCrotchetsPerSecond(*_juceMidiFile)
-                            : std::optional<float>{};
+  _crotchetsPerSecond =
+      _score ? _score->crotchetsPerSecond : std::optional<float>{};
   if (_crotchetsPerSecond.has_value()) {
     _onCrotchetsPerSecondAvailable(*_crotchetsPerSecond);
   }
-  if (_juceMidiFile) {
-    auto timeSignaturePositions = getTimeSignatures(*_juceMidiFile);
-    _positionGetter =
-        std::make_shared<PositionGetter>(std::move(timeSignaturePositions));
+  if (_score) {
+    // Never used by the audio thread, which only asks whether there is one.
+    std::atomic_store(&_positionGetter, std::make_shared<PositionGetter>(
+                                            _score->timeSignatures));
+    _hasPositionGetter = true;
   }
   if (createIntervalGetterIfAllParametersSet) {
     _createIntervalGetterIfAllParametersSet();
@@ -275,24 +413,61 @@ void DefaultMidiFileOwner::_setHarmonyTrack(
 }
 
 void DefaultMidiFileOwner::_createIntervalGetterIfAllParametersSet() {
-  if (!_juceMidiFile || !_playedTrack || !_harmonyTrack) {
+  if (!_score || !_playedTrack || !_harmonyTrack) {
     return;
   }
-  const auto playedSeq = getMidiNoteMessages(*_juceMidiFile, *_playedTrack);
-  const auto harmoSeq = getMidiNoteMessages(*_juceMidiFile, *_harmonyTrack);
-  const auto intervalGetterInput = toIntervalSpans(playedSeq, harmoSeq);
+  if (const auto compiled =
+          _compileIntervals(*_score, *_playedTrack, *_harmonyTrack,
+                            _samplesPerSecond, nullptr, _getPlayedSpans())) {
+    _applyIntervals(*compiled);
+  }
+}
+
+const std::vector<IntervalSpan> *DefaultMidiFileOwner::_getPlayedSpans() {
+  const auto track = *_playedTrack;
+  if (track < 0 || track >= static_cast<int>(_score->noteMessages.size())) {
+    return nullptr;
+  }
+  if (_playedSpans.score != _score || _playedSpans.track != track) {
+    _playedSpans = {_score, track, toPlayedSpans(_score->noteMessages[track])};
+  }
+  return &_playedSpans.spans;
+}
+
+void DefaultMidiFileOwner::_applyIntervals(const CompiledIntervals &compiled) {
   _lowestPlayedTrackHarmonizedFrequency =
-      ::saint::getLowestPlayedTrackHarmonizedFrequency(intervalGetterInput);
-  if (intervalGetterInput.empty()) {
+      compiled.lowestPlayedTrackHarmonizedFrequency;
+  if (compiled.spans.empty()) {
     // _logger->warn("toIntervalGetterInput returned empty vector");
-  } else {
-    _intervalGetterInput = intervalGetterInput;
-    for (auto listener : _listeners) {
-      listener->onIntervalSpansAvailable(intervalGetterInput);
-    }
-    _intervalGetter = IntervalGetter::createInstance(
-        intervalGetterInput, _samplesPerSecond, _crotchetsPerSecond);
+    return;
+  }
+  _intervalGetterInput = compiled.spans;
+  for (auto listener : _listeners) {
+    listener->onIntervalSpansAvailable(compiled.spans);
+  }
+  _releaseIntervalGettersUnseenByAudioThread();
+  auto retired =
+      std::atomic_exchange(&_intervalGetter, compiled.intervalGetter);
+  _audioThreadIntervalGetter.store(compiled.intervalGetter.get(),
+                                   std::memory_order_release);
+  if (retired) {
+    _retiredIntervalGetters.push_back(std::move(retired));
+  }
+}
+
+void DefaultMidiFileOwner::_releaseIntervalGettersUnseenByAudioThread() {
+  const auto seen =
+      _intervalGetterSeenByAudioThread.load(std::memory_order_acquire);
+  const auto it = std::find_if(
+      _retiredIntervalGetters.begin(), _retiredIntervalGetters.end(),
+      [seen](const auto &retired) { return retired.get() == seen; });
+  if (it != _retiredIntervalGetters.end()) {
+    _retiredIntervalGetters.erase(_retiredIntervalGetters.begin(), it);
+  } else if (seen != nullptr && seen == _intervalGetter.get()) {
+    _retiredIntervalGetters.clear();
   }
+  // Otherwise the audio thread may not have seen any of them go: it may use
+  // the oldest still.
 }
 
 std::optional<float> DefaultMidiFileOwner::getCrotchetsPerSecond() const {
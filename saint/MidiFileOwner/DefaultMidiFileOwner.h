@@ -1,30 +1,42 @@
 #pragma once
 
+#include "BackgroundLoader.h"
 #include "CommonTypes.h"
 #include "MidiFileOwner.h"
+#include "Score.h"
 
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#include <atomic>
 #include <functional>
 #include <unordered_set>
 
 namespace saint {
+class ScoreCache;
 
 using OnCrotchetsPerSecondAvailable = std::function<void(float)>;
 using OnPlayheadCommand = std::function<bool(PlayheadCommand)>;
 
+// Not thread safe, except for the interval and position getters, which can be
+// got from any thread.
 class DefaultMidiFileOwner : public MidiFileOwner {
 public:
-  DefaultMidiFileOwner(OnCrotchetsPerSecondAvailable, OnPlayheadCommand);
+  // With `postToMessageThread`, `loadMidiFile` and `setState` load MIDI files
+  // on a worker thread and publish them from the function `postToMessageThread`
+  // is given. Without, they load them before returning.
+  DefaultMidiFileOwner(OnCrotchetsPerSecondAvailable, OnPlayheadCommand,
+                       BackgroundLoader::Post postToMessageThread = nullptr);
 
   // MidiFileOwner
   void setSampleRate(int) override;
   void addStateChangeListener(Listener *) override;
   void removeStateChangeListener(Listener *) override;
   void setMidiFile(std::filesystem::path) override;
+  void loadMidiFile(std::filesystem::path) override;
   std::optional<std::filesystem::path> getMidiFile() const override;
   std::map<int, std::string> getMidiFileTrackNames() const override;
+  std::shared_ptr<const TempoMap> getTempoMap() const override;
   void setPlayedTrack(int) override;
   std::optional<int> getPlayedTrack() const override;
   void setHarmonyTrack(int) override;
@@ -39,25 +51,66 @@ public:
   void setState(std::vector<char>) override;
   bool hasIntervalGetter() const override;
   std::shared_ptr<IntervalGetter> getIntervalGetter() const override;
+  IntervalGetter *getAudioThreadIntervalGetter() const override;
   bool hasPositionGetter() const override;
   std::shared_ptr<PositionGetter> getPositionGetter() const override;
   std::optional<std::vector<IntervalSpan>> getIntervalSpans() const override;
 
+  // Same as `setMidiFile`, but with a score that was already loaded, maybe
+  // shared with other owners. Scores of `setMidiFile` and `loadMidiFile` are
+  // shared through the default `ScoreRegistry`.
+  void setScore(std::shared_ptr<const Score>);
+
   // For testing
   std::optional<float> getCrotchetsPerSecond() const;
 
 private:
+  // What the interval getter needs, compiled from a score for a pair of
+  // tracks.
+  struct CompiledIntervals {
+    int playedTrack = 0;
+    int harmonyTrack = 0;
+    std::optional<int> samplesPerSecond;
+    std::vector<IntervalSpan> spans;
+    std::shared_ptr<IntervalGetter> intervalGetter;
+    std::optional<float> lowestPlayedTrackHarmonizedFrequency;
+  };
+
+  // The spans of a played track, without intervals, kept for harmony tracks
+  // to be tried without merging the tracks anew.
+  struct PlayedSpans {
+    std::shared_ptr<const Score> score;
+    int track = 0;
+    std::vector<IntervalSpan> spans;
+  };
+
+  // Computes the played spans unless given. With a cache, the spans are
+  // looked up there first, and added if missing: this is for loads, e.g. on
+  // session restore, rather than for tracks being tried one after the other.
+  static std::optional<CompiledIntervals>
+  _compileIntervals(const Score &, int playedTrack, int harmonyTrack,
+                    const std::optional<int> &samplesPerSecond,
+                    const ScoreCache *cache,
+                    const std::vector<IntervalSpan> *playedSpans = nullptr);
+  const std::vector<IntervalSpan> *_getPlayedSpans();
+  void _startLoading(std::filesystem::path);
+  void _finishLoading(std::filesystem::path, std::shared_ptr<const Score>,
+                      std::optional<CompiledIntervals>);
+  void _applyIntervals(const CompiledIntervals &);
+  void _releaseIntervalGettersUnseenByAudioThread();
   void _setMidiFile(std::filesystem::path,
                     bool createIntervalGetterIfAllParametersSet);
+  void _setScore(std::filesystem::path, std::shared_ptr<const Score>,
+                 bool createIntervalGetterIfAllParametersSet);
   void _setPlayedTrack(int, bool createIntervalGetterIfAllParametersSet);
   void _setHarmonyTrack(int, bool createIntervalGetterIfAllParametersSet);
   void _createIntervalGetterIfAllParametersSet();
   const OnCrotchetsPerSecondAvailable _onCrotchetsPerSecondAvailable;
   const OnPlayheadCommand _onPlayheadCommand;
   std::optional<std::vector<IntervalSpan>> _intervalGetterInput;
-  std::optional<juce::MidiFile> _juceMidiFile;
+  std::shared_ptr<const Score> _score;
+  PlayedSpans _playedSpans;
   std::optional<std::filesystem::path> _midiFilePath;
-  std::map<int, std::string> _trackNames;
   std::optional<int> _samplesPerSecond;
   std::optional<int> _playedTrack;
   std::optional<int> _harmonyTrack;
@@ -65,8 +118,22 @@ private:
   std::optional<int> _loopEndBar;
   std::optional<float> _crotchetsPerSecond;
   std::optional<float> _lowestPlayedTrackHarmonizedFrequency;
+  // Accessed atomically, for threads other than this one to get copies.
   std::shared_ptr<IntervalGetter> _intervalGetter;
   std::shared_ptr<PositionGetter> _positionGetter;
+  // What the audio thread reads, without locking.
+  std::atomic<IntervalGetter *> _audioThreadIntervalGetter = nullptr;
+  std::atomic<bool> _hasPositionGetter = false;
+  // The interval getter the audio thread got last. It may still use that one
+  // or any published after it, but no longer the ones retired before it.
+  mutable std::atomic<IntervalGetter *> _intervalGetterSeenByAudioThread =
+      nullptr;
+  // Replaced interval getters, oldest first, released here once the audio
+  // thread is done with them.
+  std::vector<std::shared_ptr<IntervalGetter>> _retiredIntervalGetters;
   std::unordered_set<Listener *> _listeners;
+  std::optional<std::filesystem::path> _loadingMidiFile;
+  // Last, for the worker to be stopped before the rest is destroyed.
+  std::unique_ptr<BackgroundLoader> _loader;
 };
 } // namespace saint
@@ -0,0 +1,44 @@
+#include "DefaultMidiFileOwner.h"
+#include "IntervalGetter.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+namespace fs = std::filesystem;
+}
+
+TEST(DefaultMidiFileOwner,
+     keeps_interval_getters_the_audio_thread_may_still_use) {
+  DefaultMidiFileOwner sut{[](float) {}, [](PlayheadCommand) { return false; }};
+  sut.setSampleRate(44100);
+  sut.setMidiFile(fs::absolute("./saint/_assets/Hotel_California.mid"));
+  sut.setPlayedTrack(1);
+  sut.setHarmonyTrack(2);
+  const std::weak_ptr<IntervalGetter> first = sut.getIntervalGetter();
+  ASSERT_THAT(first.lock(), NotNull());
+  EXPECT_THAT(sut.getAudioThreadIntervalGetter(), Eq(first.lock().get()));
+
+  // The audio thread hasn't asked since: it may be using the first still.
+  sut.setHarmonyTrack(3);
+  sut.setHarmonyTrack(4);
+  EXPECT_FALSE(first.expired());
+
+  const std::weak_ptr<IntervalGetter> last = sut.getIntervalGetter();
+  ASSERT_THAT(last.lock(), Ne(first.lock()));
+  EXPECT_THAT(sut.getAudioThreadIntervalGetter(), Eq(last.lock().get()));
+
+  // Now it is done with those before the last.
+  sut.setHarmonyTrack(5);
+  EXPECT_TRUE(first.expired());
+  EXPECT_FALSE(last.expired());
+}
+
+} // namespace saint
@@ -1,4 +1,5 @@
 #include "JuceMidiFileUtils.h"
+#include "MidiEventUtils.h"
 
 #include <juce_audio_basics/juce_audio_basics.h>
 
@@ -28,7 +29,7 @@ std::optional<juce::MidiFile> getJuceMidiFile(const std::string &filename) {
   juce::MidiFile midiFile;
   const juce::File file(filename);
   const auto stream = file.createInputStream();
-  if (!midiFile.readFrom(*stream)) {
+  if (!stream || !midiFile.readFrom(*stream)) {
     return std::nullopt;
   }
   return midiFile;
@@ -65,10 +66,7 @@ std::map<int, std::string> getTrackNames(const juce::MidiFile &midiFile) {
 }
 
 float extractCrotchetsPerSecond(const juce::MidiFile &midiFile) {
-  // This makes the assumption that the tempo stays constant.
-  // For tempo-changing pieces, something more elaborate would be needed.
-  // But again, this is only for the built-in tick provider ; a proper host
-  // would do that.
+  // Only the first tempo ; `getTempoMap` has them all.
   const auto secondsPerCrotchet = getFirstFromTrack<float>(
       *midiFile.getTrack(0),
       [](const juce::MidiMessage &msg) { return msg.isTempoMetaEvent(); },
@@ -83,6 +81,21 @@ float extractCrotchetsPerSecond(const juce::MidiFile &midiFile) {
   }
 }
 
+TempoMap getTempoMap(const juce::MidiFile &midiFile) {
+  std::vector<TempoMap::TempoChange> tempoChanges;
+  const juce::MidiMessageSequence *firstTrack = midiFile.getTrack(0);
+  const auto ticksPerCrotchet = getTicksPerCrotchet(midiFile);
+  for (auto it = firstTrack->begin(); it != firstTrack->end(); ++it) {
+    const juce::MidiMessage &msg = (*it)->message;
+    if (!msg.isTempoMetaEvent()) {
+      continue;
+    }
+    tempoChanges.push_back({msg.getTimeStamp() / ticksPerCrotchet,
+                            1 / msg.getTempoSecondsPerQuarterNote()});
+  }
+  return TempoMap{std::move(tempoChanges)};
+}
+
 std::vector<MidiNoteMsg> getMidiNoteMessages(const juce::MidiFile &file,
                                              int track) {
   const auto seq = file.getTrack(track);
@@ -91,39 +104,16 @@ std::vector<MidiNoteMsg> getMidiNoteMessages(const juce::MidiFile &file,
     return {};
   }
   const auto ticksPerCrotchet = getTicksPerCrotchet(file);
-  const auto ticksPer32nd = ticksPerCrotchet / 8;
   std::vector<MidiNoteMsg> msgs;
-  MidiNoteMsg *lastMsg = nullptr;
   for (auto it = seq->begin(); it != seq->end(); ++it) {
     const auto msg = (*it)->message;
     if (!msg.isNoteOnOrOff()) {
       continue;
     }
-    const auto roundedTick =
-        static_cast<int>(msg.getTimeStamp() / ticksPer32nd + 0.5f) *
-        ticksPer32nd;
-    const auto crotchet = static_cast<float>(roundedTick) / ticksPerCrotchet;
-    msgs.push_back({crotchet, msg.isNoteOn(), msg.getNoteNumber()});
-    lastMsg = &msgs.back();
-  }
-  if (msgs.empty())
-    return {};
-  std::sort(msgs.begin(), msgs.end(),
-            [](const MidiNoteMsg &a, const MidiNoteMsg &b) {
-              return a.isNoteOn && !b.isNoteOn;
-            });
-  std::sort(msgs.begin(), msgs.end(),
-            [](const MidiNoteMsg &a, const MidiNoteMsg &b) {
-              return a.crotchet < b.crotchet;
-            });
-  auto it = std::prev(msgs.end());
-  while (it != msgs.begin()) {
-    auto prev = std::prev(it);
-    if (prev->isNoteOn && !it->isNoteOn && prev->crotchet == it->crotchet) {
-      msgs.erase(it);
-    }
-    it = prev;
+    msgs.push_back({getNoteCrotchet(msg.getTimeStamp(), ticksPerCrotchet),
+                    msg.isNoteOn(), msg.getNoteNumber()});
   }
+  sortNoteMessages(msgs);
   return msgs;
 }
 
@@ -134,9 +124,6 @@ int getTicksPerCrotchet(const juce::MidiFile &midiFile) {
 std::vector<TimeSignaturePosition>
 getTimeSignatures(const juce::MidiFile &midiFile) {
   std::vector<TimeSignaturePosition> positions;
-  auto barIndex = 0;
-  auto barCrotchet = 0.f;
-  auto crotchetsPerBar = 4.f;
   const juce::MidiMessageSequence *firstTrack = midiFile.getTrack(0);
   const auto ticksPerCrotchet = getTicksPerCrotchet(midiFile);
   for (auto it = firstTrack->begin(); it != firstTrack->end(); ++it) {
@@ -144,19 +131,10 @@ getTimeSignatures(const juce::MidiFile &midiFile) {
     if (!msg.isTimeSignatureMetaEvent()) {
       continue;
     }
-    TimeSignaturePosition position;
-    position.crotchet = std::roundf(static_cast<float>(msg.getTimeStamp()) /
-                                    static_cast<float>(ticksPerCrotchet) * 4) /
-                        4;
-    msg.getTimeSignatureInfo(position.timeSignature.num,
-                             position.timeSignature.den);
-    barIndex +=
-        static_cast<int>((position.crotchet - barCrotchet) / crotchetsPerBar);
-    position.barIndex = barIndex;
-    crotchetsPerBar =
-        4.f * position.timeSignature.num / position.timeSignature.den;
-    barCrotchet = position.crotchet;
-    positions.push_back(position);
+    Fraction timeSignature;
+    msg.getTimeSignatureInfo(timeSignature.num, timeSignature.den);
+    addTimeSignature(positions, msg.getTimeStamp(), timeSignature,
+                     ticksPerCrotchet);
   }
   return positions;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CommonTypes.h"
+#include "TempoMap.h"
 
 #include <functional>
 #include <map>
@@ -15,6 +16,8 @@ std::map<int, std::string> getTrackNames(const juce::MidiFile &midiFile);
 
 float extractCrotchetsPerSecond(const juce::MidiFile &midiFile);
 
+TempoMap getTempoMap(const juce::MidiFile &midiFile);
+
 std::vector<MidiNoteMsg> getMidiNoteMessages(const juce::MidiFile &, int track);
 
 int getTicksPerCrotchet(const juce::MidiFile &midiFile);
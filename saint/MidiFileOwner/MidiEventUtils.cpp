@@ -0,0 +1,59 @@
+#include "MidiEventUtils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace saint {
+float getNoteCrotchet(double tick, int ticksPerCrotchet) {
+  const auto ticksPer32nd = std::max(ticksPerCrotchet / 8, 1);
+  const auto roundedTick =
+      static_cast<int>(tick / ticksPer32nd + 0.5f) * ticksPer32nd;
+  return static_cast<float>(roundedTick) / ticksPerCrotchet;
+}
+
+void sortNoteMessages(std::vector<MidiNoteMsg> &msgs) {
+  std::stable_sort(msgs.begin(), msgs.end(),
+                   [](const MidiNoteMsg &a, const MidiNoteMsg &b) {
+                     if (a.crotchet != b.crotchet) {
+                       return a.crotchet < b.crotchet;
+                     }
+                     return a.isNoteOn && !b.isNoteOn;
+                   });
+  // The note-ons of a crotchet now come first, so that a note-off to drop
+  // follows either one of them or a note-off already dropped.
+  auto numKept = 0u;
+  for (const auto &msg : msgs) {
+    if (numKept > 0u && !msg.isNoteOn) {
+      const auto &lastKept = msgs[numKept - 1];
+      if (lastKept.isNoteOn && lastKept.crotchet == msg.crotchet) {
+        continue;
+      }
+    }
+    msgs[numKept++] = msg;
+  }
+  msgs.resize(numKept);
+}
+
+void addTimeSignature(std::vector<TimeSignaturePosition> &positions,
+                      double tick, Fraction timeSignature,
+                      int ticksPerCrotchet) {
+  auto barIndex = 0;
+  auto barCrotchet = 0.f;
+  auto crotchetsPerBar = 4.f;
+  if (!positions.empty()) {
+    const auto &last = positions.back();
+    barIndex = last.barIndex;
+    barCrotchet = last.crotchet;
+    crotchetsPerBar = 4.f * last.timeSignature.num / last.timeSignature.den;
+  }
+  TimeSignaturePosition position;
+  position.crotchet = std::roundf(static_cast<float>(tick) /
+                                  static_cast<float>(ticksPerCrotchet) * 4) /
+                      4;
+  position.timeSignature = timeSignature;
+  position.barIndex =
+      barIndex +
+      static_cast<int>((position.crotchet - barCrotchet) / crotchetsPerBar);
+  positions.push_back(position);
+}
+} // namespace saint
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CommonTypes.h"
+
+#include <vector>
+
+namespace saint {
+// What both the JUCE-based and the in-place MIDI file readers make of note
+// and time signature events, so that they produce the same scores.
+
+// The crotchet of a note event at `tick`, rounded to the closest 32nd.
+float getNoteCrotchet(double tick, int ticksPerCrotchet);
+
+// Sorts the messages of a track by crotchet, note-ons first, and drops the
+// note-offs that, once rounded, coincide with a note-on: at that crotchet the
+// new note takes over. O(n log n), in place but for the sort's buffer.
+void sortNoteMessages(std::vector<MidiNoteMsg> &);
+
+// Appends the time signature starting at `tick`, with its bar index counted
+// from the positions already in `positions`.
+void addTimeSignature(std::vector<TimeSignaturePosition> &positions,
+                      double tick, Fraction timeSignature,
+                      int ticksPerCrotchet);
+} // namespace saint
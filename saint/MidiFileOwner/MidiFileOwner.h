@@ -4,9 +4,12 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <optional>
 
 namespace saint {
+class TempoMap;
+
 class MidiFileOwner {
 public:
   class Listener {
@@ -16,6 +19,11 @@ public:
     virtual void onLoopBeginBarChange(const std::optional<int> &) {}
     virtual void onLoopEndBarChange(const std::optional<int> &) {}
     virtual void onIntervalSpansAvailable(const std::vector<IntervalSpan> &) {}
+    virtual void onMidiFileLoadStarted(const std::filesystem::path &) {}
+    // On success, `onStateChange` follows. Otherwise the previous file is
+    // still in use.
+    virtual void onMidiFileLoaded(const std::filesystem::path &,
+                                  bool /*success*/) {}
   };
 
   virtual ~MidiFileOwner() = default;
@@ -23,9 +31,16 @@ public:
                                        // better could probably be found.
   virtual void addStateChangeListener(Listener *) = 0;
   virtual void removeStateChangeListener(Listener *) = 0;
+  // Loads the file before returning.
   virtual void setMidiFile(std::filesystem::path) = 0;
+  // May load the file in the background, in which case the current one stays
+  // in use until the new one is ready. Loading another file before that
+  // cancels this one.
+  virtual void loadMidiFile(std::filesystem::path) = 0;
   virtual std::optional<std::filesystem::path> getMidiFile() const = 0;
   virtual std::map<int, std::string> getMidiFileTrackNames() const = 0;
+  // Of the current file, if any. Keeps the file's score alive.
+  virtual std::shared_ptr<const TempoMap> getTempoMap() const = 0;
   virtual void setPlayedTrack(int) = 0;
   virtual std::optional<int> getPlayedTrack() const = 0;
   virtual void setHarmonyTrack(int) = 0;
@@ -37,8 +52,13 @@ public:
   virtual bool execute(PlayheadCommand) = 0;
   virtual std::vector<char> getState() const = 0;
   virtual void setState(std::vector<char>) = 0;
+  // `hasIntervalGetter` and `hasPositionGetter` are lock-free. The shared
+  // getters are not: the audio thread uses `getAudioThreadIntervalGetter`.
   virtual bool hasIntervalGetter() const = 0;
   virtual std::shared_ptr<IntervalGetter> getIntervalGetter() const = 0;
+  // Lock-free. What it returns stays alive until the next call, which must be
+  // from the same thread.
+  virtual IntervalGetter *getAudioThreadIntervalGetter() const = 0;
   virtual bool hasPositionGetter() const = 0;
   virtual std::shared_ptr<PositionGetter> getPositionGetter() const = 0;
   virtual std::optional<float>
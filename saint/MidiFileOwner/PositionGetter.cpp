@@ -1,4 +1,6 @@
 #include "PositionGetter.h"
+#include <algorithm>
+#include <iterator>
 #include <tuple>
 
 namespace saint {
@@ -14,13 +16,20 @@ int getBeatsPerBar(const Fraction &timeSignature) {
 
 PositionGetter::PositionGetter(
     std::vector<TimeSignaturePosition> timeSignaturePositions)
-    : _timeSignaturePositions(std::move(timeSignaturePositions)) {}
+    : _timeSignaturePositions(std::move(timeSignaturePositions)) {
+  if (_timeSignaturePositions.empty()) {
+    // The MIDI file spec's default.
+    _timeSignaturePositions.push_back({0, 0.f, {4, 4}});
+  }
+}
 
 Position PositionGetter::getPosition(float crotchet) const {
-  const auto sigBarIt = std::prev(std::find_if(
-      _timeSignaturePositions.begin(), _timeSignaturePositions.end(),
-      [crotchet](const TimeSignaturePosition &pos) {
-        return pos.crotchet > crotchet;
+  // Times before the first signature are measured from it.
+  const auto sigBarIt = std::prev(std::upper_bound(
+      std::next(_timeSignaturePositions.begin()),
+      _timeSignaturePositions.end(), crotchet,
+      [](float crotchet, const TimeSignaturePosition &pos) {
+        return crotchet < pos.crotchet;
       }));
   const auto crotchetsFromSigBar = crotchet - sigBarIt->crotchet;
   const auto sigBar = sigBarIt->barIndex;
@@ -36,10 +45,11 @@ Position PositionGetter::getPosition(float crotchet) const {
 }
 
 float PositionGetter::getBarTimeInCrotchets(int barIndex) const {
-  const auto sigBarIt = std::prev(std::find_if(
-      _timeSignaturePositions.begin(), _timeSignaturePositions.end(),
-      [barIndex](const TimeSignaturePosition &timeSig) {
-        return timeSig.barIndex > barIndex;
+  const auto sigBarIt = std::prev(std::upper_bound(
+      std::next(_timeSignaturePositions.begin()),
+      _timeSignaturePositions.end(), barIndex,
+      [](int barIndex, const TimeSignaturePosition &timeSig) {
+        return barIndex < timeSig.barIndex;
       }));
   const auto barsFromSignBar = barIndex - sigBarIt->barIndex;
   const auto &sig = sigBarIt->timeSignature;
@@ -5,13 +5,15 @@
 #include <vector>
 
 namespace saint {
+// Lookups are binary searches over the time signature changes.
 class PositionGetter {
 public:
+  // In 4/4 if `timeSignatures` is empty.
   PositionGetter(std::vector<TimeSignaturePosition> timeSignatures);
   Position getPosition(float timeInCrotchets) const;
   float getBarTimeInCrotchets(int barIndex) const;
 
 private:
-  const std::vector<TimeSignaturePosition> _timeSignaturePositions;
+  std::vector<TimeSignaturePosition> _timeSignaturePositions;
 };
 } // namespace saint
@@ -24,4 +24,25 @@ TEST(PositionGetter, stuff) {
   EXPECT_THAT(sut.getPosition(15.f), Eq(Position({4, 1.f})));
 }
 
+TEST(PositionGetter, finds_bars_among_many_time_signatures) {
+  // A bar of 3/4 then one of 4/4, over and over.
+  std::vector<TimeSignaturePosition> timeSignatures;
+  for (auto i = 0; i < 1000; ++i) {
+    timeSignatures.push_back({2 * i, 7.f * i, {3, 4}});
+    timeSignatures.push_back({2 * i + 1, 7.f * i + 3.f, {4, 4}});
+  }
+  PositionGetter sut{std::move(timeSignatures)};
+  EXPECT_THAT(sut.getBarTimeInCrotchets(0), Eq(0.f));
+  EXPECT_THAT(sut.getBarTimeInCrotchets(501), Eq(1753.f));
+  EXPECT_THAT(sut.getBarTimeInCrotchets(2001), Eq(7004.f));
+  EXPECT_THAT(sut.getPosition(1753.5f), Eq(Position({501, 0.5f})));
+  EXPECT_THAT(sut.getPosition(7005.f), Eq(Position({2001, 1.f})));
+}
+
+TEST(PositionGetter, is_in_four_four_without_time_signatures) {
+  PositionGetter sut{std::vector<TimeSignaturePosition>{}};
+  EXPECT_THAT(sut.getBarTimeInCrotchets(2), Eq(8.f));
+  EXPECT_THAT(sut.getPosition(9.f), Eq(Position({2, 1.f})));
+}
+
 } // namespace saint
@@ -0,0 +1,31 @@
+#include "Score.h"
+#include "ScoreCache.h"
+#include "SmfParser.h"
+
+#include <juce_core/juce_core.h>
+
+namespace saint {
+std::shared_ptr<const Score> loadScore(const std::filesystem::path &path) {
+  const juce::MemoryMappedFile file{
+      juce::File{std::filesystem::absolute(path).string()},
+      juce::MemoryMappedFile::readOnly};
+  if (file.getData() == nullptr) {
+    return nullptr;
+  }
+  const auto contentHash = getContentHash(file.getData(), file.getSize());
+  const auto cache = ScoreCache::getDefault();
+  auto score = cache ? cache->loadScore(contentHash) : std::nullopt;
+  if (!score) {
+    score = parseStandardMidiFile(file.getData(), file.getSize());
+    if (!score) {
+      return nullptr;
+    }
+    if (cache) {
+      cache->saveScore(contentHash, *score);
+    }
+  }
+  score->path = path;
+  score->contentHash = contentHash;
+  return std::make_shared<const Score>(std::move(*score));
+}
+} // namespace saint
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CommonTypes.h"
+#include "TempoMap.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace saint {
+// Everything the harmonizer needs from a MIDI file, extracted once. A score is
+// immutable after `loadScore` returns, so that it can be shared between
+// MidiFileOwners, even on different threads.
+struct Score {
+  std::filesystem::path path;
+  // Of the MIDI file, see `getContentHash`. Keys the `ScoreCache`.
+  std::uint64_t contentHash = 0;
+  std::map<int, std::string> trackNames;
+  // The first tempo of the file.
+  std::optional<float> crotchetsPerSecond;
+  TempoMap tempoMap;
+  std::vector<TimeSignaturePosition> timeSignatures;
+  // Note messages of every track of the file, indexed by track number.
+  std::vector<std::vector<MidiNoteMsg>> noteMessages;
+};
+
+// Returns nullptr if `path` could not be read as a MIDI file. Files already
+// in the default `ScoreCache` aren't parsed again, and those that weren't are
+// added to it.
+std::shared_ptr<const Score> loadScore(const std::filesystem::path &path);
+} // namespace saint
@@ -0,0 +1,422 @@
+#include "ScoreCache.h"
+#include "Utils.h"
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+
+namespace saint {
+namespace fs = std::filesystem;
+using namespace scoreCache;
+
+namespace {
+constexpr char magic[8] = {'S', 'A', 'I', 'N', 'T', 'S', 'C', 'R'};
+constexpr auto scoreExtension = ".saintscore";
+constexpr auto spansExtension = ".saintspans";
+
+bool isCacheFile(const fs::path &path) {
+  const auto extension = path.extension();
+  return extension == scoreExtension || extension == spansExtension;
+}
+
+// Lets the least recently used files be found by their modification times.
+void markUsed(const fs::path &path) {
+  std::error_code error;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+}
+
+std::uintmax_t getMaxNumBytes() {
+  const auto megabytes =
+      utils::getEnvironmentVariable("SAINT_SCORE_CACHE_MAX_MB");
+  char *end = nullptr;
+  const auto value = std::strtoull(megabytes.c_str(), &end, 10);
+  if (megabytes.empty() || *end != '\0') {
+    return ScoreCache::defaultMaxNumBytes;
+  }
+  return static_cast<std::uintmax_t>(value) << 20;
+}
+
+fs::path getUserCacheDir() {
+#ifdef _WIN32
+  const auto baseDir = utils::getEnvironmentVariable("LOCALAPPDATA");
+#else
+  // https://specifications.freedesktop.org/basedir-spec/latest/
+  auto baseDir = utils::getEnvironmentVariable("XDG_CACHE_HOME");
+  if (baseDir.empty()) {
+    const auto home = utils::getEnvironmentVariable("HOME");
+    if (!home.empty()) {
+      baseDir = fs::path{home}.append(".cache").string();
+    }
+  }
+#endif
+  if (baseDir.empty()) {
+    return fs::temp_directory_path().append("saint").append("scores");
+  }
+  return fs::path{baseDir}.append("saint").append("scores");
+}
+
+std::string toHex(std::uint64_t value) {
+  std::ostringstream stream;
+  stream << std::hex;
+  stream.width(16);
+  stream.fill('0');
+  stream << value;
+  return stream.str();
+}
+
+class Writer {
+public:
+  Writer(Kind kind, std::uint64_t contentHash) {
+    FileHeader header{};
+    std::copy(std::begin(magic), std::end(magic), header.magic);
+    header.version = formatVersion;
+    header.kind = kind;
+    header.contentHash = contentHash;
+    append(header);
+  }
+
+  template <typename T> void append(const T &value) {
+    const auto bytes = reinterpret_cast<const char *>(&value);
+    _data.insert(_data.end(), bytes, bytes + sizeof(T));
+  }
+
+  void appendPadded(const std::string &str) {
+    _data.insert(_data.end(), str.begin(), str.end());
+    _data.resize(_data.size() + (4 - str.size() % 4) % 4);
+  }
+
+  // Completes the header.
+  std::vector<char> finish() {
+    const std::uint64_t numBytes = _data.size();
+    std::memcpy(_data.data() + offsetof(FileHeader, numBytes), &numBytes,
+                sizeof(numBytes));
+    return std::move(_data);
+  }
+
+private:
+  std::vector<char> _data;
+};
+
+// Bounds-checked reads from a mapped cache file, which may be corrupt.
+class Reader {
+public:
+  Reader(const fs::path &path, Kind kind, std::uint64_t contentHash)
+      : _file(juce::File{fs::absolute(path).string()},
+              juce::MemoryMappedFile::readOnly),
+        _data(static_cast<const char *>(_file.getData())),
+        _size(_data ? _file.getSize() : 0u) {
+    FileHeader header;
+    _isValid = read(header) &&
+               std::equal(std::begin(magic), std::end(magic), header.magic) &&
+               header.version == formatVersion && header.kind == kind &&
+               header.contentHash == contentHash && header.numBytes == _size;
+  }
+
+  bool isValid() const { return _isValid; }
+
+  template <typename T> bool read(T &value) {
+    if (_size - _position < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, _data + _position, sizeof(T));
+    _position += sizeof(T);
+    return true;
+  }
+
+  bool readPadded(std::string &str, std::size_t length) {
+    const auto paddedLength = length + (4 - length % 4) % 4;
+    if (_size - _position < paddedLength) {
+      return false;
+    }
+    str.assign(_data + _position, length);
+    _position += paddedLength;
+    return true;
+  }
+
+  bool isAtEnd() const { return _position == _size; }
+
+  // Guards allocations against corrupt counts.
+  bool hasAtLeast(std::size_t numBytes) const {
+    return _size - _position >= numBytes;
+  }
+
+private:
+  const juce::MemoryMappedFile _file;
+  const char *const _data;
+  const std::size_t _size;
+  std::size_t _position = 0;
+  bool _isValid = false;
+};
+} // namespace
+
+std::uint64_t getContentHash(const void *data, std::size_t size) {
+  auto hash = 0xcbf29ce484222325ull;
+  const auto bytes = static_cast<const unsigned char *>(data);
+  for (auto i = 0u; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+ScoreCache::ScoreCache(fs::path directory, std::uintmax_t maxNumBytes)
+    : _directory(std::move(directory)), _maxNumBytes(maxNumBytes) {}
+
+const ScoreCache *ScoreCache::getDefault() {
+  static const auto cache = []() -> std::unique_ptr<ScoreCache> {
+    const auto enabled = utils::getEnvironmentVariable("SAINT_SCORE_CACHE");
+    if (!enabled.empty() &&
+        !utils::getEnvironmentVariableAsBool("SAINT_SCORE_CACHE")) {
+      return nullptr;
+    }
+    const auto dir = utils::getEnvironmentVariable("SAINT_SCORE_CACHE_DIR");
+    return std::make_unique<ScoreCache>(
+        dir.empty() ? getUserCacheDir() : fs::path{dir}, getMaxNumBytes());
+  }();
+  return cache.get();
+}
+
+const fs::path &ScoreCache::getDirectory() const { return _directory; }
+
+std::optional<Score> ScoreCache::loadScore(std::uint64_t contentHash) const {
+  const auto path = _getScorePath(contentHash);
+  Reader reader{path, Kind::score, contentHash};
+  ScoreHeader header;
+  if (!reader.isValid() || !reader.read(header) ||
+      !reader.hasAtLeast(
+          header.numTempoChanges * sizeof(TempoChangeRecord) +
+          header.numTimeSignatures * sizeof(TimeSignatureRecord) +
+          header.numTracks * sizeof(std::uint32_t))) {
+    return std::nullopt;
+  }
+  Score score;
+  if (header.hasCrotchetsPerSecond) {
+    score.crotchetsPerSecond = header.crotchetsPerSecond;
+  }
+  std::vector<TempoMap::TempoChange> tempoChanges;
+  tempoChanges.reserve(header.numTempoChanges);
+  for (auto i = 0u; i < header.numTempoChanges; ++i) {
+    TempoChangeRecord record;
+    reader.read(record);
+    tempoChanges.push_back({record.crotchet, record.crotchetsPerSecond});
+  }
+  score.tempoMap = TempoMap{std::move(tempoChanges)};
+  score.timeSignatures.reserve(header.numTimeSignatures);
+  for (auto i = 0u; i < header.numTimeSignatures; ++i) {
+    TimeSignatureRecord record;
+    reader.read(record);
+    score.timeSignatures.push_back(
+        {record.barIndex, record.crotchet, {record.num, record.den}});
+  }
+  score.noteMessages.resize(header.numTracks);
+  for (auto &track : score.noteMessages) {
+    std::uint32_t numMessages = 0;
+    if (!reader.read(numMessages) ||
+        !reader.hasAtLeast(numMessages * sizeof(NoteRecord))) {
+      return std::nullopt;
+    }
+    track.reserve(numMessages);
+    for (auto i = 0u; i < numMessages; ++i) {
+      NoteRecord record;
+      reader.read(record);
+      track.push_back(
+          {record.crotchet, record.isNoteOn != 0, record.noteNumber});
+    }
+  }
+  for (auto i = 0u; i < header.numTrackNames; ++i) {
+    TrackNameRecord record;
+    std::string name;
+    if (!reader.read(record) || !reader.readPadded(name, record.length)) {
+      return std::nullopt;
+    }
+    score.trackNames[record.track] = std::move(name);
+  }
+  if (!reader.isAtEnd()) {
+    return std::nullopt;
+  }
+  markUsed(path);
+  return score;
+}
+
+bool ScoreCache::saveScore(std::uint64_t contentHash,
+                           const Score &score) const {
+  Writer writer{Kind::score, contentHash};
+  ScoreHeader header{};
+  header.crotchetsPerSecond = score.crotchetsPerSecond.value_or(0.f);
+  header.hasCrotchetsPerSecond = score.crotchetsPerSecond.has_value();
+  header.numTracks = static_cast<std::uint32_t>(score.noteMessages.size());
+  header.numTimeSignatures =
+      static_cast<std::uint32_t>(score.timeSignatures.size());
+  header.numTrackNames = static_cast<std::uint32_t>(score.trackNames.size());
+  const auto &tempoChanges = score.tempoMap.getTempoChanges();
+  header.numTempoChanges = static_cast<std::uint32_t>(tempoChanges.size());
+  writer.append(header);
+  for (const auto &change : tempoChanges) {
+    writer.append(
+        TempoChangeRecord{change.crotchet, change.crotchetsPerSecond});
+  }
+  for (const auto &position : score.timeSignatures) {
+    writer.append(TimeSignatureRecord{position.barIndex, position.crotchet,
+                                      position.timeSignature.num,
+                                      position.timeSignature.den});
+  }
+  for (const auto &track : score.noteMessages) {
+    writer.append(static_cast<std::uint32_t>(track.size()));
+    for (const auto &msg : track) {
+      writer.append(NoteRecord{msg.crotchet,
+                               static_cast<std::uint8_t>(msg.noteNumber),
+                               static_cast<std::uint8_t>(msg.isNoteOn), 0});
+    }
+  }
+  for (const auto &[track, name] : score.trackNames) {
+    writer.append(
+        TrackNameRecord{track, static_cast<std::uint32_t>(name.size())});
+    writer.appendPadded(name);
+  }
+  return _write(_getScorePath(contentHash), writer.finish());
+}
+
+std::optional<std::vector<IntervalSpan>>
+ScoreCache::loadIntervalSpans(std::uint64_t contentHash, int playedTrack,
+                              int harmonyTrack) const {
+  const auto path = _getSpansPath(contentHash, playedTrack, harmonyTrack);
+  Reader reader{path, Kind::intervalSpans, contentHash};
+  SpansHeader header;
+  if (!reader.isValid() || !reader.read(header) ||
+      header.playedTrack != playedTrack ||
+      header.harmonyTrack != harmonyTrack ||
+      !reader.hasAtLeast(header.numSpans * sizeof(SpanRecord))) {
+    return std::nullopt;
+  }
+  std::vector<IntervalSpan> spans;
+  spans.reserve(header.numSpans);
+  for (auto i = 0u; i < header.numSpans; ++i) {
+    SpanRecord record;
+    reader.read(record);
+    auto &span = spans.emplace_back(IntervalSpan{record.beginCrotchet, {}});
+    if (record.noteNumber >= 0) {
+      span.playedNote.emplace(PlayedNote{record.noteNumber});
+      if (record.interval != noInterval) {
+        span.playedNote->interval = record.interval;
+      }
+    }
+  }
+  if (!reader.isAtEnd()) {
+    return std::nullopt;
+  }
+  markUsed(path);
+  return spans;
+}
+
+bool ScoreCache::saveIntervalSpans(
+    std::uint64_t contentHash, int playedTrack, int harmonyTrack,
+    const std::vector<IntervalSpan> &spans) const {
+  Writer writer{Kind::intervalSpans, contentHash};
+  writer.append(SpansHeader{playedTrack, harmonyTrack,
+                            static_cast<std::uint32_t>(spans.size()), 0});
+  for (const auto &span : spans) {
+    SpanRecord record{span.beginCrotchet, -1, noInterval};
+    if (const auto &note = span.playedNote) {
+      record.noteNumber = static_cast<std::int16_t>(note->noteNumber);
+      if (note->interval) {
+        record.interval = static_cast<std::int16_t>(*note->interval);
+      }
+    }
+    writer.append(record);
+  }
+  return _write(_getSpansPath(contentHash, playedTrack, harmonyTrack),
+                writer.finish());
+}
+
+fs::path ScoreCache::_getScorePath(std::uint64_t contentHash) const {
+  return _directory / (toHex(contentHash) + scoreExtension);
+}
+
+fs::path ScoreCache::_getSpansPath(std::uint64_t contentHash,
+                                   int playedTrack, int harmonyTrack) const {
+  return _directory /
+         (toHex(contentHash) + "_" + std::to_string(playedTrack) + "_" +
+          std::to_string(harmonyTrack) + spansExtension);
+}
+
+bool ScoreCache::_write(const fs::path &path,
+                        const std::vector<char> &data) const {
+  std::error_code error;
+  fs::create_directories(_directory, error);
+  thread_local std::mt19937_64 generator{std::random_device{}()};
+  auto tmpPath = path;
+  tmpPath += "." + toHex(generator()) + ".tmp";
+  {
+    std::ofstream file{tmpPath, std::ios::binary};
+    if (!file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+      file.close();
+      fs::remove(tmpPath, error);
+      return false;
+    }
+  }
+  // Fails on Windows if another instance has the file mapped, in which case
+  // it's already there anyway.
+  fs::rename(tmpPath, path, error);
+  if (error) {
+    fs::remove(tmpPath, error);
+    return false;
+  }
+  _prune(path);
+  return true;
+}
+
+void ScoreCache::_prune(const fs::path &justWritten) const {
+  struct Entry {
+    fs::path path;
+    fs::file_time_type lastUse;
+    std::uintmax_t numBytes = 0;
+  };
+  std::vector<Entry> entries;
+  std::uintmax_t totalNumBytes = 0;
+  std::error_code error;
+  for (fs::directory_iterator it{_directory, error}, end; !error && it != end;
+       it.increment(error)) {
+    // Temporary files of other writers are theirs to remove.
+    if (!isCacheFile(it->path())) {
+      continue;
+    }
+    std::error_code entryError;
+    const auto numBytes = it->file_size(entryError);
+    if (entryError) {
+      continue;
+    }
+    const auto lastUse = it->last_write_time(entryError);
+    if (entryError) {
+      continue;
+    }
+    totalNumBytes += numBytes;
+    if (it->path() != justWritten) {
+      entries.push_back({it->path(), lastUse, numBytes});
+    }
+  }
+  if (totalNumBytes <= _maxNumBytes) {
+    return;
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) {
+              return a.lastUse < b.lastUse;
+            });
+  for (const auto &entry : entries) {
+    if (totalNumBytes <= _maxNumBytes) {
+      break;
+    }
+    // Fails on Windows if another instance has the file mapped, in which
+    // case it's in use anyway.
+    if (fs::remove(entry.path, error)) {
+      totalNumBytes -= entry.numBytes;
+    }
+  }
+}
+} // namespace saint
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CommonTypes.h"
+#include "Score.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace saint {
+// Scores, and the interval spans compiled from them, as compact binary files
+// keyed by the content hash of their MIDI file, so that a file already seen,
+// e.g. by another plugin instance of the same session, needn't be parsed
+// again. Files are in native byte order and written whole under a temporary
+// name before being renamed, so that concurrent instances never read half a
+// file. A file that doesn't match the current format is ignored and
+// eventually overwritten. Files last used longest ago are removed when a write
+// takes the cache over its size limit.
+namespace scoreCache {
+constexpr std::uint32_t formatVersion = 2;
+
+enum class Kind : std::uint32_t {
+  // `ScoreHeader`, then its `TempoChangeRecord`s, then its
+  // `TimeSignatureRecord`s, then for each track its
+  // number of messages and `NoteRecord`s, then for each track name a
+  // `TrackNameRecord` and its characters padded to 4 bytes.
+  score = 1,
+  // `SpansHeader` followed by its `SpanRecord`s.
+  intervalSpans,
+};
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  Kind kind;
+  std::uint64_t contentHash;
+  // Of the whole file, header included.
+  std::uint64_t numBytes;
+};
+
+struct ScoreHeader {
+  float crotchetsPerSecond;
+  std::int32_t hasCrotchetsPerSecond;
+  std::uint32_t numTracks;
+  std::uint32_t numTimeSignatures;
+  std::uint32_t numTrackNames;
+  std::uint32_t numTempoChanges;
+};
+
+struct TempoChangeRecord {
+  double crotchet;
+  double crotchetsPerSecond;
+};
+
+struct TimeSignatureRecord {
+  std::int32_t barIndex;
+  float crotchet;
+  std::int32_t num;
+  std::int32_t den;
+};
+
+struct NoteRecord {
+  float crotchet;
+  std::uint8_t noteNumber;
+  std::uint8_t isNoteOn;
+  std::uint16_t reserved;
+};
+
+struct TrackNameRecord {
+  std::int32_t track;
+  std::uint32_t length;
+};
+
+struct SpansHeader {
+  std::int32_t playedTrack;
+  std::int32_t harmonyTrack;
+  std::uint32_t numSpans;
+  std::uint32_t reserved;
+};
+
+struct SpanRecord {
+  float beginCrotchet;
+  // -1 if no note is played.
+  std::int16_t noteNumber;
+  // `noInterval` if the note isn't harmonized.
+  std::int16_t interval;
+};
+constexpr auto noInterval = std::numeric_limits<std::int16_t>::min();
+} // namespace scoreCache
+
+// 64-bit FNV-1a of a MIDI file's content.
+std::uint64_t getContentHash(const void *data, std::size_t size);
+
+class ScoreCache {
+public:
+  static constexpr std::uintmax_t defaultMaxNumBytes = 64u << 20;
+
+  // The directory is created when first written to.
+  explicit ScoreCache(std::filesystem::path directory,
+                      std::uintmax_t maxNumBytes = defaultMaxNumBytes);
+
+  // The cache in SAINT_SCORE_CACHE_DIR if set, else in the user's cache
+  // directory, of at most SAINT_SCORE_CACHE_MAX_MB megabytes if set. Null if
+  // SAINT_SCORE_CACHE is set to something false.
+  static const ScoreCache *getDefault();
+
+  const std::filesystem::path &getDirectory() const;
+
+  // The returned score has no path.
+  std::optional<Score> loadScore(std::uint64_t contentHash) const;
+  bool saveScore(std::uint64_t contentHash, const Score &) const;
+
+  std::optional<std::vector<IntervalSpan>>
+  loadIntervalSpans(std::uint64_t contentHash, int playedTrack,
+                    int harmonyTrack) const;
+  bool saveIntervalSpans(std::uint64_t contentHash, int playedTrack,
+                         int harmonyTrack,
+                         const std::vector<IntervalSpan> &) const;
+
+private:
+  std::filesystem::path _getScorePath(std::uint64_t contentHash) const;
+  std::filesystem::path _getSpansPath(std::uint64_t contentHash,
+                                      int playedTrack, int harmonyTrack) const;
+  bool _write(const std::filesystem::path &, const std::vector<char> &) const;
+  // Removes the least recently used files, but `justWritten`, until the cache
+  // is within its size limit.
+  void _prune(const std::filesystem::path &justWritten) const;
+
+  const std::filesystem::path _directory;
+  const std::uintmax_t _maxNumBytes;
+};
+} // namespace saint
@@ -0,0 +1,137 @@
+#include "ScoreCache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+namespace fs = std::filesystem;
+
+fs::path getCacheDir() {
+  const auto dir = fs::temp_directory_path() / "ScoreCacheTests";
+  fs::remove_all(dir);
+  return dir;
+}
+
+Score getScore() {
+  Score score;
+  score.trackNames = {{1, "Lead"}, {2, "Harmony, a name of odd length"}};
+  score.crotchetsPerSecond = 2.f;
+  score.tempoMap = TempoMap{{{0., 2.}, {16., 2.5}}};
+  score.timeSignatures = {{0, 0.f, {4, 4}}, {2, 8.f, {6, 8}}};
+  score.noteMessages = {{},
+                        {{0.f, true, 60}, {1.5f, false, 60}},
+                        {{0.f, true, 64}, {1.5f, false, 64}}};
+  return score;
+}
+
+void expectSameScores(const Score &actual, const Score &expected) {
+  EXPECT_THAT(actual.trackNames, Eq(expected.trackNames));
+  EXPECT_THAT(actual.crotchetsPerSecond, Eq(expected.crotchetsPerSecond));
+  const auto &actualTempi = actual.tempoMap.getTempoChanges();
+  const auto &expectedTempi = expected.tempoMap.getTempoChanges();
+  ASSERT_THAT(actualTempi.size(), Eq(expectedTempi.size()));
+  for (auto i = 0u; i < actualTempi.size(); ++i) {
+    EXPECT_THAT(actualTempi[i].crotchet, Eq(expectedTempi[i].crotchet));
+    EXPECT_THAT(actualTempi[i].crotchetsPerSecond,
+                Eq(expectedTempi[i].crotchetsPerSecond));
+  }
+  ASSERT_THAT(actual.timeSignatures.size(),
+              Eq(expected.timeSignatures.size()));
+  for (auto i = 0u; i < actual.timeSignatures.size(); ++i) {
+    const auto &a = actual.timeSignatures[i];
+    const auto &e = expected.timeSignatures[i];
+    EXPECT_THAT(a.barIndex, Eq(e.barIndex));
+    EXPECT_THAT(a.crotchet, Eq(e.crotchet));
+    EXPECT_THAT(a.timeSignature, Eq(e.timeSignature));
+  }
+  ASSERT_THAT(actual.noteMessages.size(), Eq(expected.noteMessages.size()));
+  for (auto i = 0u; i < actual.noteMessages.size(); ++i) {
+    const auto &a = actual.noteMessages[i];
+    const auto &e = expected.noteMessages[i];
+    ASSERT_THAT(a.size(), Eq(e.size()));
+    for (auto j = 0u; j < a.size(); ++j) {
+      EXPECT_THAT(a[j].crotchet, Eq(e[j].crotchet));
+      EXPECT_THAT(a[j].isNoteOn, Eq(e[j].isNoteOn));
+      EXPECT_THAT(a[j].noteNumber, Eq(e[j].noteNumber));
+    }
+  }
+}
+} // namespace
+
+TEST(ScoreCache, hashes_content_with_fnv1a) {
+  EXPECT_THAT(getContentHash("", 0), Eq(0xcbf29ce484222325ull));
+  EXPECT_THAT(getContentHash("a", 1), Eq(0xaf63dc4c8601ec8cull));
+}
+
+TEST(ScoreCache, round_trips_scores) {
+  const ScoreCache sut{getCacheDir()};
+  EXPECT_THAT(sut.loadScore(123), Eq(std::nullopt));
+  ASSERT_TRUE(sut.saveScore(123, getScore()));
+  const auto score = sut.loadScore(123);
+  ASSERT_TRUE(score.has_value());
+  expectSameScores(*score, getScore());
+  EXPECT_THAT(sut.loadScore(124), Eq(std::nullopt));
+}
+
+TEST(ScoreCache, round_trips_interval_spans) {
+  const ScoreCache sut{getCacheDir()};
+  const std::vector<IntervalSpan> spans{{0.f, std::nullopt},
+                                        {1.f, PlayedNote{69, std::nullopt}},
+                                        {2.f, PlayedNote{71, -3}},
+                                        {10.f, std::nullopt}};
+  ASSERT_TRUE(sut.saveIntervalSpans(123, 1, 2, spans));
+  EXPECT_THAT(sut.loadIntervalSpans(123, 1, 2), Optional(spans));
+  EXPECT_THAT(sut.loadIntervalSpans(123, 2, 1), Eq(std::nullopt));
+}
+
+TEST(ScoreCache, ignores_truncated_files) {
+  const ScoreCache sut{getCacheDir()};
+  ASSERT_TRUE(sut.saveScore(123, getScore()));
+  for (const auto &entry : fs::directory_iterator{sut.getDirectory()}) {
+    fs::resize_file(entry.path(), fs::file_size(entry.path()) - 4);
+  }
+  EXPECT_THAT(sut.loadScore(123), Eq(std::nullopt));
+  // And overwrites them.
+  ASSERT_TRUE(sut.saveScore(123, getScore()));
+  EXPECT_TRUE(sut.loadScore(123).has_value());
+}
+
+TEST(ScoreCache, removes_the_least_recently_used_files_when_full) {
+  const std::vector<IntervalSpan> spans{{0.f, PlayedNote{60, 4}},
+                                        {1.5f, std::nullopt}};
+  const auto dir = getCacheDir();
+  std::uintmax_t fileSize = 0;
+  {
+    const ScoreCache probe{dir};
+    ASSERT_TRUE(probe.saveIntervalSpans(123, 1, 2, spans));
+    for (const auto &entry : fs::directory_iterator{dir}) {
+      fileSize = entry.file_size();
+      fs::remove(entry.path());
+    }
+  }
+  // Room for two files.
+  const ScoreCache sut{dir, 2 * fileSize + fileSize / 2};
+  ASSERT_TRUE(sut.saveIntervalSpans(123, 1, 2, spans));
+  ASSERT_TRUE(sut.saveIntervalSpans(123, 1, 3, spans));
+  const auto now = fs::file_time_type::clock::now();
+  for (const auto &entry : fs::directory_iterator{dir}) {
+    const auto age = entry.path().string().find("_1_2") != std::string::npos
+                         ? std::chrono::hours{2}
+                         : std::chrono::hours{1};
+    fs::last_write_time(entry.path(), now - age);
+  }
+  // The oldest written, but used since.
+  ASSERT_TRUE(sut.loadIntervalSpans(123, 1, 2).has_value());
+  ASSERT_TRUE(sut.saveIntervalSpans(123, 1, 4, spans));
+  EXPECT_TRUE(sut.loadIntervalSpans(123, 1, 2).has_value());
+  EXPECT_THAT(sut.loadIntervalSpans(123, 1, 3), Eq(std::nullopt));
+  EXPECT_TRUE(sut.loadIntervalSpans(123, 1, 4).has_value());
+}
+} // namespace saint
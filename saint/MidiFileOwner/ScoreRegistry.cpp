@@ -0,0 +1,79 @@
+#include "ScoreRegistry.h"
+
+namespace saint {
+namespace fs = std::filesystem;
+
+ScoreRegistry::ScoreRegistry(Load load) : _load(std::move(load)) {}
+
+ScoreRegistry &ScoreRegistry::getDefault() {
+  static ScoreRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<const Score> ScoreRegistry::getScore(const fs::path &path) {
+  std::error_code error;
+  const auto absolutePath = fs::absolute(path, error).lexically_normal();
+  const auto modified = fs::last_write_time(absolutePath, error);
+  if (error) {
+    return nullptr;
+  }
+  const Key key{absolutePath.string(),
+                static_cast<std::int64_t>(
+                    modified.time_since_epoch().count())};
+
+  std::unique_lock<std::mutex> lock{_mutex};
+  _removeUnusedEntries();
+  while (true) {
+    auto &entry = _entries[key];
+    if (auto score = entry.score.lock()) {
+      return score;
+    }
+    if (!entry.isLoading) {
+      // Not removed while loading.
+      entry.isLoading = true;
+      break;
+    }
+    _loaded.wait(lock);
+  }
+  lock.unlock();
+  std::shared_ptr<const Score> score;
+  try {
+    score = _load(path);
+  } catch (...) {
+    _finishLoading(key, nullptr);
+    throw;
+  }
+  _finishLoading(key, score);
+  return score;
+}
+
+int ScoreRegistry::getNumScores() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  auto num = 0;
+  for (const auto &[key, entry] : _entries) {
+    num += entry.score.expired() ? 0 : 1;
+  }
+  return num;
+}
+
+void ScoreRegistry::_finishLoading(const Key &key,
+                                   std::shared_ptr<const Score> score) {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    auto &entry = _entries.at(key);
+    entry.isLoading = false;
+    entry.score = std::move(score);
+  }
+  _loaded.notify_all();
+}
+
+void ScoreRegistry::_removeUnusedEntries() {
+  for (auto it = _entries.begin(); it != _entries.end();) {
+    if (!it->second.isLoading && it->second.score.expired()) {
+      it = _entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+} // namespace saint
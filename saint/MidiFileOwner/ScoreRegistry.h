@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Score.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace saint {
+// Scores loaded in this process, shared by all the MidiFileOwners using the
+// same MIDI file, e.g. plugin instances of one session harmonizing different
+// parts of a song. A score is kept as long as someone uses it. It is keyed by
+// absolute path and modification time, so that a file edited in between is
+// loaded again. Thread safe: a file requested from several threads at once is
+// loaded once, the others waiting for it.
+class ScoreRegistry {
+public:
+  using Load = std::function<std::shared_ptr<const Score>(
+      const std::filesystem::path &)>;
+
+  explicit ScoreRegistry(Load = loadScore);
+
+  // The one of the process.
+  static ScoreRegistry &getDefault();
+
+  // Nullptr if the file doesn't exist or can't be loaded.
+  std::shared_ptr<const Score> getScore(const std::filesystem::path &);
+
+  // For testing
+  int getNumScores() const;
+
+private:
+  using Key = std::pair<std::string, std::int64_t>;
+
+  struct Entry {
+    std::weak_ptr<const Score> score;
+    bool isLoading = false;
+  };
+
+  void _finishLoading(const Key &, std::shared_ptr<const Score>);
+  void _removeUnusedEntries();
+
+  const Load _load;
+  mutable std::mutex _mutex;
+  std::condition_variable _loaded;
+  std::map<Key, Entry> _entries;
+};
+} // namespace saint
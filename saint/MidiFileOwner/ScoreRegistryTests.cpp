@@ -0,0 +1,100 @@
+#include "ScoreRegistry.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+namespace fs = std::filesystem;
+
+fs::path getMidiFilePath() {
+  const auto path = fs::temp_directory_path() / "ScoreRegistryTests.mid";
+  std::ofstream{path} << "not parsed by these tests";
+  return path;
+}
+
+struct CountingLoad {
+  std::shared_ptr<const Score> operator()(const fs::path &path) const {
+    ++*numLoads;
+    std::this_thread::sleep_for(delay);
+    auto score = std::make_shared<Score>();
+    score->path = path;
+    return score;
+  }
+
+  std::shared_ptr<std::atomic<int>> numLoads =
+      std::make_shared<std::atomic<int>>(0);
+  std::chrono::milliseconds delay{0};
+};
+} // namespace
+
+TEST(ScoreRegistry, shares_scores_while_they_are_in_use) {
+  const auto path = getMidiFilePath();
+  CountingLoad load;
+  ScoreRegistry sut{load};
+  const auto first = sut.getScore(path);
+  const auto second = sut.getScore(path.parent_path() / "." / path.filename());
+  EXPECT_THAT(first, NotNull());
+  EXPECT_THAT(second, Eq(first));
+  EXPECT_THAT(*load.numLoads, Eq(1));
+  EXPECT_THAT(sut.getNumScores(), Eq(1));
+}
+
+TEST(ScoreRegistry, loads_scores_again_once_released) {
+  const auto path = getMidiFilePath();
+  CountingLoad load;
+  ScoreRegistry sut{load};
+  sut.getScore(path);
+  EXPECT_THAT(sut.getNumScores(), Eq(0));
+  sut.getScore(path);
+  EXPECT_THAT(*load.numLoads, Eq(2));
+}
+
+TEST(ScoreRegistry, loads_modified_files_again) {
+  const auto path = getMidiFilePath();
+  CountingLoad load;
+  ScoreRegistry sut{load};
+  const auto before = sut.getScore(path);
+  fs::last_write_time(path,
+                      fs::last_write_time(path) + std::chrono::seconds{1});
+  const auto after = sut.getScore(path);
+  EXPECT_THAT(after, Ne(before));
+  EXPECT_THAT(*load.numLoads, Eq(2));
+  EXPECT_THAT(sut.getNumScores(), Eq(2));
+}
+
+TEST(ScoreRegistry, loads_once_for_concurrent_requests) {
+  const auto path = getMidiFilePath();
+  CountingLoad load;
+  load.delay = std::chrono::milliseconds{50};
+  ScoreRegistry sut{load};
+  std::vector<std::shared_ptr<const Score>> scores(8);
+  std::vector<std::thread> threads;
+  for (auto &score : scores) {
+    threads.emplace_back([&] { score = sut.getScore(path); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(*load.numLoads, Eq(1));
+  EXPECT_THAT(scores, Each(Eq(scores[0])));
+  EXPECT_THAT(scores[0], NotNull());
+}
+
+TEST(ScoreRegistry, returns_null_for_missing_files) {
+  CountingLoad load;
+  ScoreRegistry sut{load};
+  EXPECT_THAT(sut.getScore(fs::temp_directory_path() / "nowhere.mid"),
+              IsNull());
+  EXPECT_THAT(*load.numLoads, Eq(0));
+}
+} // namespace saint
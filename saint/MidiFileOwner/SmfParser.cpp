@@ -0,0 +1,245 @@
+#include "SmfParser.h"
+#include "MidiEventUtils.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace saint {
+namespace {
+// Below this, starting threads costs more than decoding the tracks.
+constexpr std::size_t minBytesForParallelDecoding = 1 << 16;
+
+struct TrackChunk {
+  const std::uint8_t *begin;
+  const std::uint8_t *end;
+};
+
+struct DecodedTrack {
+  std::vector<MidiNoteMsg> noteMessages;
+  std::optional<std::string> name;
+  std::optional<int> programChange;
+  // Only looked for in the first track.
+  std::optional<float> crotchetsPerSecond;
+  std::vector<TempoMap::TempoChange> tempoChanges;
+  std::vector<TimeSignaturePosition> timeSignatures;
+};
+
+std::uint32_t readBigEndian(const std::uint8_t *data, int numBytes) {
+  std::uint32_t value = 0;
+  for (auto i = 0; i < numBytes; ++i) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+bool hasId(const std::uint8_t *data, const char *id) {
+  return std::memcmp(data, id, 4) == 0;
+}
+
+// Returns false if the quantity runs past `end` or has more than 4 bytes.
+bool readVariableLength(const std::uint8_t *&data, const std::uint8_t *end,
+                        std::uint32_t &value) {
+  value = 0;
+  for (auto i = 0; i < 4 && data < end; ++i) {
+    const auto byte = *data++;
+    value = (value << 7) | (byte & 0x7f);
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int getNumDataBytes(std::uint8_t status) {
+  switch (status & 0xf0) {
+  case 0xc0:
+  case 0xd0:
+    return 1;
+  case 0xf0:
+    return status == 0xf2 ? 2 : status == 0xf1 || status == 0xf3 ? 1 : 0;
+  default:
+    return 2;
+  }
+}
+
+DecodedTrack decodeTrack(const TrackChunk &chunk, int ticksPerCrotchet,
+                         bool isFirstTrack) {
+  DecodedTrack track;
+  const auto *data = chunk.begin;
+  std::uint64_t tick = 0;
+  std::uint8_t runningStatus = 0;
+  while (data < chunk.end) {
+    std::uint32_t delta = 0;
+    if (!readVariableLength(data, chunk.end, delta) || data == chunk.end) {
+      break;
+    }
+    tick += delta;
+    auto status = *data;
+    if (status & 0x80) {
+      ++data;
+    } else if (runningStatus != 0) {
+      status = runningStatus;
+    } else {
+      break;
+    }
+
+    if (status == 0xff || status == 0xf0 || status == 0xf7) {
+      auto type = 0;
+      if (status == 0xff) {
+        if (data == chunk.end) {
+          break;
+        }
+        type = *data++;
+      }
+      std::uint32_t length = 0;
+      if (!readVariableLength(data, chunk.end, length) ||
+          length > static_cast<std::uint32_t>(chunk.end - data)) {
+        break;
+      }
+      if (status == 0xff) {
+        if (type == 0x03 && !track.name.has_value()) {
+          track.name.emplace(reinterpret_cast<const char *>(data), length);
+        } else if (isFirstTrack && type == 0x51 && length >= 3) {
+          const auto secondsPerCrotchet = readBigEndian(data, 3) / 1000000.0;
+          if (!track.crotchetsPerSecond.has_value()) {
+            track.crotchetsPerSecond =
+                1 / static_cast<float>(secondsPerCrotchet);
+          }
+          track.tempoChanges.push_back(
+              {static_cast<double>(tick) / ticksPerCrotchet,
+               1 / secondsPerCrotchet});
+        } else if (isFirstTrack && type == 0x58 && length == 4) {
+          addTimeSignature(track.timeSignatures, static_cast<double>(tick),
+                           {data[0], 1 << data[1]}, ticksPerCrotchet);
+        }
+      }
+      data += length;
+      continue;
+    }
+
+    const auto numDataBytes = getNumDataBytes(status);
+    if (chunk.end - data < numDataBytes) {
+      break;
+    }
+    if (status < 0xf0) {
+      runningStatus = status;
+    }
+    const auto type = status & 0xf0;
+    if (type == 0x80 || type == 0x90) {
+      track.noteMessages.push_back(
+          {getNoteCrotchet(static_cast<double>(tick), ticksPerCrotchet),
+           type == 0x90 && data[1] != 0, data[0] & 0x7f});
+    } else if (type == 0xc0 && !track.programChange.has_value()) {
+      track.programChange = data[0] & 0x7f;
+    }
+    data += numDataBytes;
+  }
+  sortNoteMessages(track.noteMessages);
+  return track;
+}
+
+std::vector<DecodedTrack> decodeTracks(const std::vector<TrackChunk> &chunks,
+                                       int ticksPerCrotchet) {
+  std::vector<DecodedTrack> tracks(chunks.size());
+  const auto decode = [&](size_t i) {
+    tracks[i] = decodeTrack(chunks[i], ticksPerCrotchet, i == 0);
+  };
+  std::size_t numBytes = 0;
+  for (const auto &chunk : chunks) {
+    numBytes += static_cast<std::size_t>(chunk.end - chunk.begin);
+  }
+  const auto numThreads = std::min<std::size_t>(
+      std::max(std::thread::hardware_concurrency(), 1u), chunks.size());
+  if (numThreads < 2 || numBytes < minBytesForParallelDecoding) {
+    for (auto i = 0u; i < chunks.size(); ++i) {
+      decode(i);
+    }
+    return tracks;
+  }
+  std::atomic<std::size_t> nextTrack = 0;
+  const auto work = [&] {
+    for (auto i = nextTrack++; i < chunks.size(); i = nextTrack++) {
+      decode(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (auto i = 1u; i < numThreads; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return tracks;
+}
+} // namespace
+
+std::optional<Score> parseStandardMidiFile(const void *data,
+                                           std::size_t size) {
+  const auto *begin = static_cast<const std::uint8_t *>(data);
+  const auto *const end = begin + size;
+  // RIFF-wrapped (.rmi) files have the standard file a few bytes in.
+  if (size >= 4 && hasId(begin, "RIFF")) {
+    const auto *const searchEnd = begin + std::min<std::size_t>(size, 64);
+    const char id[] = "MThd";
+    begin = std::search(begin, searchEnd, id, id + 4);
+  }
+  if (end - begin < 14 || !hasId(begin, "MThd")) {
+    return std::nullopt;
+  }
+  const auto headerSize = readBigEndian(begin + 4, 4);
+  const auto format = readBigEndian(begin + 8, 2);
+  const auto numTracks = readBigEndian(begin + 10, 2);
+  const auto division = readBigEndian(begin + 12, 2);
+  const auto ticksPerCrotchet = static_cast<int>(division);
+  const auto maxHeaderSize = static_cast<std::size_t>(end - begin) - 8;
+  if (headerSize < 6 || headerSize > maxHeaderSize || format > 2 ||
+      (division & 0x8000) || ticksPerCrotchet == 0) {
+    return std::nullopt;
+  }
+
+  std::vector<TrackChunk> chunks;
+  chunks.reserve(numTracks);
+  const auto *chunk = begin + 8 + headerSize;
+  while (end - chunk >= 8 && chunks.size() < numTracks) {
+    const auto chunkSize = readBigEndian(chunk + 4, 4);
+    const auto *const chunkData = chunk + 8;
+    if (chunkSize > static_cast<std::size_t>(end - chunkData)) {
+      break;
+    }
+    if (hasId(chunk, "MTrk")) {
+      chunks.push_back({chunkData, chunkData + chunkSize});
+    }
+    chunk = chunkData + chunkSize;
+  }
+
+  auto tracks = decodeTracks(chunks, ticksPerCrotchet);
+  Score score;
+  score.crotchetsPerSecond = 0.f;
+  if (!tracks.empty()) {
+    score.crotchetsPerSecond = tracks[0].crotchetsPerSecond.value_or(0.f);
+    score.tempoMap = TempoMap{std::move(tracks[0].tempoChanges)};
+    score.timeSignatures = std::move(tracks[0].timeSignatures);
+  }
+  score.noteMessages.reserve(tracks.size());
+  for (auto i = 0u; i < tracks.size(); ++i) {
+    auto &track = tracks[i];
+    if (!track.noteMessages.empty()) {
+      auto &name = score.trackNames[static_cast<int>(i)];
+      if (track.name.has_value()) {
+        name = std::move(*track.name);
+      } else if (track.programChange.has_value()) {
+        name = juce::MidiMessage::getGMInstrumentName(*track.programChange);
+      }
+    }
+    score.noteMessages.push_back(std::move(track.noteMessages));
+  }
+  return score;
+}
+} // namespace saint
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Score.h"
+
+#include <cstddef>
+#include <optional>
+
+namespace saint {
+// Decodes a Standard MIDI File in place, e.g. from a memory-mapped file,
+// keeping only what a `Score` needs: note ons and offs, tempi, time
+// signatures and track names. Nothing is copied but these, straight into the
+// score's per-track arrays, and the tracks of large files are decoded in
+// parallel. The result is what the JUCE-based helpers of JuceMidiFileUtils.h
+// make of the same file, but for its path, which is left empty.
+// Returns nullopt if `data` isn't a MIDI file, or one timed in SMPTE frames.
+std::optional<Score> parseStandardMidiFile(const void *data, std::size_t size);
+} // namespace saint
@@ -0,0 +1,198 @@
+#include "JuceMidiFileUtils.h"
+#include "SmfParser.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <tuple>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+// What the JUCE-based helpers make of a file.
+Score getJuceScore(const juce::MidiFile &midiFile) {
+  Score score;
+  score.trackNames = getTrackNames(midiFile);
+  score.crotchetsPerSecond = extractCrotchetsPerSecond(midiFile);
+  score.tempoMap = getTempoMap(midiFile);
+  score.timeSignatures = getTimeSignatures(midiFile);
+  for (auto i = 0; i < midiFile.getNumTracks(); ++i) {
+    score.noteMessages.push_back(getMidiNoteMessages(midiFile, i));
+  }
+  return score;
+}
+
+auto toTuples(const std::vector<MidiNoteMsg> &msgs) {
+  std::vector<std::tuple<float, bool, int>> tuples;
+  for (const auto &msg : msgs) {
+    tuples.emplace_back(msg.crotchet, msg.isNoteOn, msg.noteNumber);
+  }
+  return tuples;
+}
+
+auto toTuples(const std::vector<TimeSignaturePosition> &positions) {
+  std::vector<std::tuple<int, float, int, int>> tuples;
+  for (const auto &p : positions) {
+    tuples.emplace_back(p.barIndex, p.crotchet, p.timeSignature.num,
+                        p.timeSignature.den);
+  }
+  return tuples;
+}
+
+auto toTuples(const std::vector<TempoMap::TempoChange> &changes) {
+  std::vector<std::tuple<double, double>> tuples;
+  for (const auto &change : changes) {
+    tuples.emplace_back(change.crotchet, change.crotchetsPerSecond);
+  }
+  return tuples;
+}
+
+void expectSameScores(const Score &actual, const Score &expected) {
+  EXPECT_THAT(actual.trackNames, Eq(expected.trackNames));
+  EXPECT_THAT(actual.crotchetsPerSecond, Eq(expected.crotchetsPerSecond));
+  EXPECT_THAT(toTuples(actual.tempoMap.getTempoChanges()),
+              Eq(toTuples(expected.tempoMap.getTempoChanges())));
+  EXPECT_THAT(toTuples(actual.timeSignatures),
+              Eq(toTuples(expected.timeSignatures)));
+  ASSERT_THAT(actual.noteMessages.size(), Eq(expected.noteMessages.size()));
+  for (auto i = 0u; i < actual.noteMessages.size(); ++i) {
+    EXPECT_THAT(toTuples(actual.noteMessages[i]),
+                Eq(toTuples(expected.noteMessages[i])))
+        << "track " << i;
+  }
+}
+
+using Bytes = std::vector<std::uint8_t>;
+
+Bytes makeFile(int ticksPerCrotchet, const std::vector<Bytes> &tracks) {
+  Bytes file{'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0,
+             static_cast<std::uint8_t>(tracks.size())};
+  file.push_back(static_cast<std::uint8_t>(ticksPerCrotchet >> 8));
+  file.push_back(static_cast<std::uint8_t>(ticksPerCrotchet & 0xff));
+  for (const auto &track : tracks) {
+    const auto size = track.size();
+    file.insert(file.end(), {'M', 'T', 'r', 'k', 0, 0,
+                             static_cast<std::uint8_t>(size >> 8),
+                             static_cast<std::uint8_t>(size & 0xff)});
+    file.insert(file.end(), track.begin(), track.end());
+  }
+  return file;
+}
+} // namespace
+
+TEST(SmfParser, decodes_notes_tempo_time_signatures_and_track_names) {
+  const auto file = makeFile(
+      96, {
+              // Tempo of 500000 us per crotchet, twice as fast from the
+              // second crotchet, 3/4 then 6/8 in bar 1.
+              {0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20,       //
+               0x00, 0xff, 0x58, 0x04, 0x03, 0x02, 0x18, 0x08, //
+               0x60, 0xff, 0x51, 0x03, 0x03, 0xd0, 0x90,       //
+               0x81, 0x40, 0xff, 0x58, 0x04, 0x06, 0x03, 0x18, 0x08},
+              // Named, with running status and a zero-velocity note-on.
+              {0x00, 0xff, 0x03, 0x04, 'L', 'e', 'a', 'd', //
+               0x00, 0x90, 0x3c, 0x64,                     //
+               0x60, 0x3c, 0x00,                           //
+               0x18, 0x3e, 0x64,                           //
+               0x18, 0x80, 0x3e, 0x40},
+              // Named after its instrument.
+              {0x00, 0xc0, 0x28,       //
+               0x00, 0x90, 0x40, 0x64, //
+               0x60, 0x80, 0x40, 0x00},
+              // No notes, so not worth showing.
+              {0x00, 0xff, 0x03, 0x03, 'P', 'a', 'd'},
+          });
+  const auto score = parseStandardMidiFile(file.data(), file.size());
+  ASSERT_TRUE(score.has_value());
+  EXPECT_THAT(score->crotchetsPerSecond, Optional(2.f));
+  EXPECT_THAT(toTuples(score->tempoMap.getTempoChanges()),
+              ElementsAre(std::make_tuple(0., 2.), std::make_tuple(1., 4.)));
+  EXPECT_THAT(toTuples(score->timeSignatures),
+              ElementsAre(std::make_tuple(0, 0.f, 3, 4),
+                          std::make_tuple(1, 3.f, 6, 8)));
+  EXPECT_THAT(score->trackNames,
+              ElementsAre(Pair(1, "Lead"), Pair(2, "Violin")));
+  ASSERT_THAT(score->noteMessages.size(), Eq(4u));
+  EXPECT_THAT(toTuples(score->noteMessages[1]),
+              ElementsAre(std::make_tuple(0.f, true, 60),
+                          std::make_tuple(1.f, false, 60),
+                          std::make_tuple(1.25f, true, 62),
+                          std::make_tuple(1.5f, false, 62)));
+  EXPECT_THAT(toTuples(score->noteMessages[2]),
+              ElementsAre(std::make_tuple(0.f, true, 64),
+                          std::make_tuple(1.f, false, 64)));
+  EXPECT_THAT(score->noteMessages[3], IsEmpty());
+}
+
+TEST(SmfParser, rejects_data_that_isnt_a_midi_file) {
+  const std::string notMidi{"RIFF....WAVEfmt "};
+  EXPECT_FALSE(parseStandardMidiFile(notMidi.data(), notMidi.size()));
+  auto smpte = makeFile(96, {});
+  smpte[12] = 0xe7;
+  EXPECT_FALSE(parseStandardMidiFile(smpte.data(), smpte.size()));
+}
+
+TEST(SmfParser, parses_the_assets_like_juce) {
+  for (const auto name :
+       {"Hotel_California.mid", "Les_Petits_Poissons.mid",
+        "fourFourThenSixEightThenThreeFourThenFourFour.mid"}) {
+    SCOPED_TRACE(name);
+    const auto path = std::filesystem::absolute("./saint/_assets") / name;
+    std::ifstream stream{path, std::ios::binary};
+    const std::vector<char> data{std::istreambuf_iterator<char>{stream}, {}};
+    const auto score = parseStandardMidiFile(data.data(), data.size());
+    const auto midiFile = getJuceMidiFile(path.string());
+    ASSERT_TRUE(score.has_value());
+    ASSERT_TRUE(midiFile.has_value());
+    expectSameScores(*score, getJuceScore(*midiFile));
+  }
+}
+
+TEST(SmfParser, decodes_large_files_in_parallel_like_juce) {
+  constexpr auto numTracks = 8;
+  constexpr auto numNotesPerTrack = 4000;
+  juce::MidiFile midiFile;
+  midiFile.setTicksPerQuarterNote(480);
+  std::minstd_rand generator{0};
+  std::uniform_int_distribution<int> ticks{0, 500};
+  std::uniform_int_distribution<int> noteNumbers{60, 64};
+  for (auto track = 0; track < numTracks; ++track) {
+    juce::MidiMessageSequence seq;
+    if (track == 0) {
+      seq.addEvent(juce::MidiMessage::tempoMetaEvent(400000), 0.);
+      seq.addEvent(juce::MidiMessage::tempoMetaEvent(600000), 96000.);
+      seq.addEvent(juce::MidiMessage::timeSignatureMetaEvent(5, 4), 0.);
+    }
+    seq.addEvent(
+        juce::MidiMessage::textMetaEvent(3, "Track " + juce::String{track}));
+    auto tick = 0;
+    for (auto i = 0; i < numNotesPerTrack; ++i) {
+      // Off the 32nd grid, with notes played again before they're released.
+      tick += ticks(generator);
+      const auto noteNumber = noteNumbers(generator);
+      seq.addEvent(juce::MidiMessage::noteOn(1, noteNumber, 0.8f), tick);
+      seq.addEvent(juce::MidiMessage::noteOff(1, noteNumber),
+                   tick + ticks(generator));
+    }
+    midiFile.addTrack(seq);
+  }
+  juce::MemoryOutputStream stream;
+  ASSERT_TRUE(midiFile.writeTo(stream));
+
+  const auto score =
+      parseStandardMidiFile(stream.getData(), stream.getDataSize());
+  juce::MemoryInputStream input{stream.getData(), stream.getDataSize(), false};
+  juce::MidiFile expected;
+  ASSERT_TRUE(expected.readFrom(input));
+  ASSERT_TRUE(score.has_value());
+  expectSameScores(*score, getJuceScore(expected));
+}
+} // namespace saint
@@ -0,0 +1,86 @@
+#include "TempoMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace saint {
+TempoMap::TempoMap() : TempoMap(std::vector<TempoChange>{}) {}
+
+TempoMap::TempoMap(std::vector<TempoChange> tempoChanges)
+    : _tempoChanges(std::move(tempoChanges)) {
+  for (const auto &change : _tempoChanges) {
+    if (!std::isfinite(change.crotchetsPerSecond) ||
+        change.crotchetsPerSecond <= 0.) {
+      continue;
+    }
+    if (_segments.empty()) {
+      _segments.push_back({0., 0., change.crotchetsPerSecond});
+      continue;
+    }
+    auto &last = _segments.back();
+    if (change.crotchet <= last.crotchet) {
+      last.crotchetsPerSecond = change.crotchetsPerSecond;
+      continue;
+    }
+    const auto seconds =
+        last.seconds + (change.crotchet - last.crotchet) /
+                           last.crotchetsPerSecond;
+    _segments.push_back({change.crotchet, seconds, change.crotchetsPerSecond});
+  }
+  if (_segments.empty()) {
+    _segments.push_back({0., 0., defaultCrotchetsPerSecond});
+  }
+}
+
+const std::vector<TempoMap::TempoChange> &TempoMap::getTempoChanges() const {
+  return _tempoChanges;
+}
+
+double TempoMap::getCrotchet(double seconds) const {
+  return _getCrotchet(_getSegmentAtSeconds(seconds), seconds);
+}
+
+double TempoMap::getSeconds(double crotchet) const {
+  const auto it =
+      std::upper_bound(_segments.begin() + 1, _segments.end(), crotchet,
+                       [](double crotchet, const Segment &segment) {
+                         return crotchet < segment.crotchet;
+                       });
+  const auto &segment = *std::prev(it);
+  return segment.seconds +
+         (crotchet - segment.crotchet) / segment.crotchetsPerSecond;
+}
+
+std::size_t TempoMap::_getSegmentAtSeconds(double seconds) const {
+  const auto it =
+      std::upper_bound(_segments.begin() + 1, _segments.end(), seconds,
+                       [](double seconds, const Segment &segment) {
+                         return seconds < segment.seconds;
+                       });
+  return static_cast<std::size_t>(std::distance(_segments.begin(), it)) - 1u;
+}
+
+double TempoMap::_getCrotchet(std::size_t index, double seconds) const {
+  const auto &segment = _segments[index];
+  return segment.crotchet +
+         (seconds - segment.seconds) * segment.crotchetsPerSecond;
+}
+
+TempoMap::Cursor::Cursor(const TempoMap &map, int samplesPerSecond)
+    : _map(map), _samplesPerSecond(samplesPerSecond) {}
+
+double TempoMap::Cursor::getCrotchet(std::int64_t sample) {
+  const auto seconds = static_cast<double>(sample) / _samplesPerSecond;
+  const auto &segments = _map._segments;
+  const auto isPast = [&](std::size_t segment) {
+    return segment < segments.size() && segments[segment].seconds <= seconds;
+  };
+  if (seconds < segments[_segment].seconds || isPast(_segment + 2u)) {
+    _segment = _map._getSegmentAtSeconds(seconds);
+  } else if (isPast(_segment + 1u)) {
+    ++_segment;
+  }
+  return _map._getCrotchet(_segment, seconds);
+}
+} // namespace saint
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace saint {
+// Converts between score time, in crotchets, and performance time, in seconds
+// or samples, across the tempo changes of a MIDI file. Built once, when the
+// file is loaded, as a piecewise-linear table with the seconds elapsed at each
+// tempo change, so that a conversion is a binary search.
+class TempoMap {
+public:
+  struct TempoChange {
+    double crotchet = 0.;
+    double crotchetsPerSecond = 0.;
+  };
+
+  // That of a MIDI file without tempo event, i.e., 120 bpm.
+  static constexpr auto defaultCrotchetsPerSecond = 2.;
+
+  // At the default tempo throughout.
+  TempoMap();
+  // The first change applies from the start, whatever its crotchet. Changes
+  // must be in crotchet order ; of several at the same crotchet, the last one
+  // holds, and those with a tempo that isn't positive are ignored.
+  explicit TempoMap(std::vector<TempoChange>);
+
+  // As given to the constructor.
+  const std::vector<TempoChange> &getTempoChanges() const;
+
+  // Times before the start extrapolate the first tempo.
+  double getCrotchet(double seconds) const;
+  double getSeconds(double crotchet) const;
+
+  // Sample to crotchet conversions for the audio thread. As long as samples
+  // go forward by less than a tempo segment at a time, a conversion costs a
+  // comparison or two ; any other jump, a binary search.
+  class Cursor {
+  public:
+    // `map` must outlive the cursor.
+    Cursor(const TempoMap &map, int samplesPerSecond);
+    double getCrotchet(std::int64_t sample);
+
+  private:
+    const TempoMap &_map;
+    const double _samplesPerSecond;
+    std::size_t _segment = 0;
+  };
+
+private:
+  // The tempo from `crotchet`, reached after `seconds`, until the next
+  // segment.
+  struct Segment {
+    double crotchet = 0.;
+    double seconds = 0.;
+    double crotchetsPerSecond = 0.;
+  };
+
+  std::size_t _getSegmentAtSeconds(double seconds) const;
+  double _getCrotchet(std::size_t segment, double seconds) const;
+
+  std::vector<TempoChange> _tempoChanges;
+  // Never empty, and the first starts at 0.
+  std::vector<Segment> _segments;
+};
+} // namespace saint
@@ -0,0 +1,57 @@
+#include "TempoMap.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+// 120 bpm for 4 crotchets, then 60 bpm for 2, then 240 bpm.
+TempoMap getTempoMap() { return TempoMap{{{0., 2.}, {4., 1.}, {6., 4.}}}; }
+} // namespace
+
+TEST(TempoMap, is_at_120_bpm_without_tempo_changes) {
+  const TempoMap sut;
+  EXPECT_THAT(sut.getCrotchet(1.5), DoubleEq(3.));
+  EXPECT_THAT(sut.getSeconds(3.), DoubleEq(1.5));
+}
+
+TEST(TempoMap, converts_across_tempo_changes_both_ways) {
+  const auto sut = getTempoMap();
+  const std::vector<std::pair<double, double>> secondsAndCrotchets{
+      {-1., -2.}, {0., 0.}, {1., 2.}, {2., 4.},
+      {3., 5.},   {4., 6.}, {5., 10.}};
+  for (const auto &[seconds, crotchet] : secondsAndCrotchets) {
+    EXPECT_THAT(sut.getCrotchet(seconds), DoubleEq(crotchet)) << seconds;
+    EXPECT_THAT(sut.getSeconds(crotchet), DoubleEq(seconds)) << crotchet;
+  }
+}
+
+TEST(TempoMap, starts_with_the_first_tempo_and_keeps_the_last_of_a_crotchet) {
+  const TempoMap sut{{{1., 4.}, {2., 0.}, {2., 1.}, {2., 2.}}};
+  EXPECT_THAT(sut.getSeconds(2.), DoubleEq(0.5));
+  EXPECT_THAT(sut.getSeconds(4.), DoubleEq(1.5));
+  EXPECT_THAT(sut.getTempoChanges().size(), Eq(4u));
+}
+
+TEST(TempoMap, cursor_agrees_with_the_map_forward_and_after_jumps) {
+  constexpr auto samplesPerSecond = 100;
+  const auto sut = getTempoMap();
+  TempoMap::Cursor cursor{sut, samplesPerSecond};
+  const auto expectSame = [&](std::int64_t sample) {
+    EXPECT_THAT(cursor.getCrotchet(sample),
+                DoubleEq(sut.getCrotchet(
+                    static_cast<double>(sample) / samplesPerSecond)))
+        << sample;
+  };
+  for (auto sample = 0; sample < 600; sample += 7) {
+    expectSame(sample);
+  }
+  expectSame(150);
+  expectSame(-10);
+  expectSame(1000);
+  expectSame(250);
+}
+} // namespace saint
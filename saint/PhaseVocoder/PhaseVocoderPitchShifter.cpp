@@ -0,0 +1,242 @@
+#include "PhaseVocoderPitchShifter.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace saint {
+
+namespace {
+constexpr auto twoPi = 6.283185307179586f;
+
+float wrapPhase(float phase) {
+  return phase - twoPi * std::round(phase / twoPi);
+}
+
+std::vector<float> getSynthesisWindow(const std::vector<float> &analysisWindow,
+                                      int hopSize) {
+  const auto overlap = static_cast<int>(analysisWindow.size()) / hopSize;
+  if (overlap >= 4) {
+    return analysisWindow;
+  } else {
+    // Not enough overlap for a Hann^2 to sum up to a constant: don't window
+    // again and rely on the analysis window alone.
+    return std::vector<float>(analysisWindow.size(), 1.f);
+  }
+}
+
+float getOlaNormalizer(const std::vector<float> &analysisWindow,
+                       const std::vector<float> &synthesisWindow,
+                       int hopSize) {
+  // Average over one hop of the overlap-added product of both windows.
+  const auto windowSize = static_cast<int>(analysisWindow.size());
+  auto sum = 0.f;
+  for (auto i = 0; i < hopSize; ++i) {
+    for (auto j = i; j < windowSize; j += hopSize) {
+      sum += analysisWindow[j] * synthesisWindow[j];
+    }
+  }
+  const auto gain = sum / static_cast<float>(hopSize);
+  return gain > 0.f ? 1.f / gain : 1.f;
+}
+} // namespace
+
+PhaseVocoderPitchShifter::PhaseVocoderPitchShifter(
+    const std::vector<float> &analysisWindow, int fftSize, int hopSize)
+    : _windowSize(static_cast<int>(analysisWindow.size())), _fftSize(fftSize),
+      _spectrumSize(fftSize / 2), _hopSize(hopSize),
+      _maxPendingFrames(PitchDetector::maxBlockSize / hopSize + 1),
+      _synthesisWindow(getSynthesisWindow(analysisWindow, hopSize)),
+      _olaNormalizer(
+          getOlaNormalizer(analysisWindow, _synthesisWindow, hopSize)),
+      _fft(fftSize),
+      _pendingFrames(static_cast<size_t>(_maxPendingFrames * _spectrumSize)),
+      _lastAnalysisPhase(_spectrumSize, 0.f), _analysisMag(_spectrumSize),
+      _analysisFreq(_spectrumSize),
+      _synthMag(_spectrumSize), _synthFreq(_spectrumSize),
+      _synthPhase(_spectrumSize, 0.f), _peaks(_spectrumSize),
+      _synthSpectrum(_spectrumSize),
+      _synthFrame(fftSize), _olaAccumulator(_windowSize, 0.f),
+      _scratch(PitchDetector::maxBlockSize) {
+  assert(_windowSize <= _fftSize);
+  assert(_windowSize + PitchDetector::maxBlockSize < fifoSize);
+  // See `getLatency()` for where these figures come from.
+  const std::vector<float> zeros(_windowSize, 0.f);
+  _wetFifo.writeBuff(zeros.data(), _hopSize);
+  _dryFifo.writeBuff(zeros.data(), _windowSize);
+}
+
+void PhaseVocoderPitchShifter::onAnalysisFrame(
+    const std::complex<float> *spectrum, int spectrumSize) {
+  assert(spectrumSize == _spectrumSize);
+  if (_numPendingFrames == _maxPendingFrames) {
+    // Only happens if `processBuffer` isn't called after each detector
+    // `process` call.
+    assert(false);
+    return;
+  }
+  std::copy(spectrum, spectrum + spectrumSize,
+            _pendingFrames.begin() + _numPendingFrames * _spectrumSize);
+  ++_numPendingFrames;
+}
+
+void PhaseVocoderPitchShifter::_synthesizeFrame(
+    const std::complex<float> *spectrum) {
+  const auto ratio = std::pow(2.f, _semitoneShift / 12.f);
+  const auto expectedAdvance =
+      twoPi * static_cast<float>(_hopSize) / static_cast<float>(_fftSize);
+
+  // PFFFT packs the Nyquist bin in the imaginary part of the DC bin ; we just
+  // drop it.
+  for (auto k = 0; k < _spectrumSize; ++k) {
+    const auto X = k == 0 ? std::complex<float>{spectrum[0].real(), 0.f}
+                          : spectrum[k];
+    const auto phase = std::arg(X);
+    const auto delta =
+        wrapPhase(phase - _lastAnalysisPhase[k] - k * expectedAdvance);
+    _lastAnalysisPhase[k] = phase;
+    _analysisMag[k] = std::abs(X);
+    // True frequency of that bin's partial, in bins.
+    _analysisFreq[k] = static_cast<float>(k) + delta / expectedAdvance;
+  }
+  // Read each synthesis bin from where it comes from rather than pushing
+  // analysis bins to where they go, so that upward shifts leave no holes
+  // within a partial's main lobe.
+  for (auto k = 0; k < _spectrumSize; ++k) {
+    const auto source = static_cast<float>(k) / ratio;
+    const auto left = static_cast<int>(source);
+    if (left + 1 >= _spectrumSize) {
+      _synthMag[k] = 0.f;
+      _synthFreq[k] = 0.f;
+      continue;
+    }
+    const auto frac = source - static_cast<float>(left);
+    _synthMag[k] =
+        (1.f - frac) * _analysisMag[left] + frac * _analysisMag[left + 1];
+    _synthFreq[k] = _analysisFreq[frac < 0.5f ? left : left + 1] * ratio;
+  }
+  for (auto k = 0; k < _spectrumSize; ++k) {
+    _synthPhase[k] =
+        wrapPhase(_synthPhase[k] + _synthFreq[k] * expectedAdvance);
+  }
+  // Identity phase locking: bins around a peak keep the phase relationship
+  // they had in the analysis frame. Without it the lobe of a partial ends up
+  // with incoherent phases and its energy is smeared out of the window.
+  auto numPeaks = 0;
+  for (auto k = 1; k + 1 < _spectrumSize; ++k) {
+    if (_synthMag[k] > _synthMag[k - 1] && _synthMag[k] >= _synthMag[k + 1]) {
+      _peaks[numPeaks++] = k;
+    }
+  }
+  const auto getSourceBin = [&](int k) {
+    return std::min(static_cast<int>(static_cast<float>(k) / ratio + 0.5f),
+                    _spectrumSize - 1);
+  };
+  auto peakIndex = 0;
+  for (auto k = 0; k < _spectrumSize; ++k) {
+    if (numPeaks == 0) {
+      _synthSpectrum[k] = std::polar(_synthMag[k], _synthPhase[k]);
+      continue;
+    }
+    while (peakIndex + 1 < numPeaks &&
+           _peaks[peakIndex + 1] - k < k - _peaks[peakIndex]) {
+      ++peakIndex;
+    }
+    const auto peak = _peaks[peakIndex];
+    const auto phase = _synthPhase[peak] +
+                       _lastAnalysisPhase[getSourceBin(k)] -
+                       _lastAnalysisPhase[getSourceBin(peak)];
+    _synthSpectrum[k] = std::polar(_synthMag[k], phase);
+  }
+  _synthSpectrum[0] = {_synthSpectrum[0].real(), 0.f};
+  {
+    SAINT_TRACE_ZONE("pffft inverse");
+    _fft.inverse(_synthSpectrum.data(), _synthFrame.data());
+  }
+
+  // PFFFT's inverse isn't normalized.
+  const auto gain = _olaNormalizer / static_cast<float>(_fftSize);
+  for (auto i = 0; i < _windowSize; ++i) {
+    _olaAccumulator[i] += _synthFrame[i] * _synthesisWindow[i] * gain;
+  }
+  // The oldest hop won't get any more contributions.
+  _wetFifo.writeBuff(_olaAccumulator.data(), _hopSize);
+  std::copy(_olaAccumulator.begin() + _hopSize, _olaAccumulator.end(),
+            _olaAccumulator.begin());
+  std::fill(_olaAccumulator.end() - _hopSize, _olaAccumulator.end(), 0.f);
+}
+
+void PhaseVocoderPitchShifter::processBuffer(float *const *audio,
+                                             int numberOfChannels,
+                                             int numberOfSamples) {
+  SAINT_TRACE_ZONE("PhaseVocoderPitchShifter::processBuffer");
+  for (auto i = 0; i < _numPendingFrames; ++i) {
+    _synthesizeFrame(_pendingFrames.data() + i * _spectrumSize);
+  }
+  _numPendingFrames = 0;
+
+  const auto targetMix = _mixPercentage / 100.f;
+  const auto mixIncrement =
+      (targetMix - _currentMix) / static_cast<float>(numberOfSamples);
+  auto offset = 0;
+  while (offset < numberOfSamples) {
+    const auto n =
+        std::min(numberOfSamples - offset, PitchDetector::maxBlockSize);
+    const auto out = audio[0] + offset;
+    _dryFifo.writeBuff(out, n);
+    _dryFifo.readBuff(out, n);
+    const auto numWet = static_cast<int>(_wetFifo.readBuff(_scratch.data(), n));
+    if (numWet < n) {
+      // Shouldn't happen, see `getLatency()`.
+      ++_numBufferFailures;
+      std::fill(_scratch.begin() + numWet, _scratch.begin() + n, 0.f);
+    }
+    for (auto i = 0; i < n; ++i) {
+      _currentMix += mixIncrement;
+      out[i] = out[i] * (1.f - _currentMix) + _scratch[i] * _currentMix;
+    }
+    offset += n;
+  }
+  _currentMix = targetMix;
+  for (auto channel = 1; channel < numberOfChannels; ++channel) {
+    std::copy(audio[0], audio[0] + numberOfSamples, audio[channel]);
+  }
+}
+
+void PhaseVocoderPitchShifter::setFormantPreserving(bool) {
+  // Not supported by this engine.
+}
+
+void PhaseVocoderPitchShifter::setPitchHighSpeed(bool) {
+  // Already as cheap as it gets: the analysis FFT is done by the detector.
+}
+
+int PhaseVocoderPitchShifter::getLatency() {
+  // A frame's oldest hop is output as soon as that frame is analyzed, i.e.,
+  // `_windowSize - _hopSize` samples late. Pre-filling the wet FIFO with one
+  // hop of silence guarantees that it never runs dry, bringing the total to
+  // `_windowSize`.
+  return _windowSize;
+}
+
+void PhaseVocoderPitchShifter::setMixPercentage(float newPercentage) {
+  _mixPercentage = newPercentage;
+}
+
+void PhaseVocoderPitchShifter::setSemitoneShift(float newShift) {
+  _semitoneShift = newShift;
+}
+
+float PhaseVocoderPitchShifter::getMixPercentage() { return _mixPercentage; }
+
+float PhaseVocoderPitchShifter::getSemitoneShift() { return _semitoneShift; }
+
+int PhaseVocoderPitchShifter::getLatencyEstimationInSamples() {
+  return getLatency();
+}
+
+int PhaseVocoderPitchShifter::getNumBufferFailures() {
+  return _numBufferFailures;
+}
+} // namespace saint
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "DavidCNAntonia/IPitchShifter.h"
+#include "PitchDetector.h"
+
+#include <pffft.hpp>
+#include <ringbuffer.hpp>
+
+#include <complex>
+#include <vector>
+
+namespace saint {
+// A frequency-domain pitch shifter that does not transform its input itself,
+// but is fed the spectra of the pitch detector's analysis frames. Detection
+// and shifting then share one forward FFT per hop.
+// Frames received through `onAnalysisFrame` are synthesized by the next call
+// to `processBuffer`, with the semitone shift current at that time. The
+// caller must hence call `PitchDetector::process` and then `processBuffer` on
+// the same block.
+class PhaseVocoderPitchShifter : public DavidCNAntonia::IPitchShifter,
+                                 public PitchDetector::AnalysisFrameListener {
+public:
+  // Analysis overlap the detector should be created with. At 4, the Hann
+  // analysis window can also be used for synthesis.
+  static constexpr auto analysisOverlap = 4;
+
+  PhaseVocoderPitchShifter(const std::vector<float> &analysisWindow,
+                           int fftSize, int hopSize);
+
+  // PitchDetector::AnalysisFrameListener
+  void onAnalysisFrame(const std::complex<float> *spectrum,
+                       int spectrumSize) override;
+
+  // IPitchShifter
+  void setFormantPreserving(bool shouldPreserveFormants) override;
+  void setPitchHighSpeed(bool shouldUseHighSpeed) override;
+  int getLatency() override;
+  void processBuffer(float *const *audio, int numberOfChannels,
+                     int numberOfSamples) override;
+  void setMixPercentage(float newPercentage) override;
+  void setSemitoneShift(float newShift) override;
+  float getMixPercentage() override;
+  float getSemitoneShift() override;
+  int getLatencyEstimationInSamples() override;
+  int getNumBufferFailures() override;
+
+private:
+  static constexpr auto fifoSize = 4 * PitchDetector::maxBlockSize;
+
+  void _synthesizeFrame(const std::complex<float> *spectrum);
+
+  const int _windowSize;
+  const int _fftSize;
+  const int _spectrumSize;
+  const int _hopSize;
+  const int _maxPendingFrames;
+  const std::vector<float> _synthesisWindow;
+  const float _olaNormalizer;
+  pffft::Fft<float> _fft;
+  std::vector<std::complex<float>> _pendingFrames;
+  int _numPendingFrames = 0;
+  std::vector<float> _lastAnalysisPhase;
+  std::vector<float> _analysisMag;
+  std::vector<float> _analysisFreq;
+  std::vector<float> _synthMag;
+  std::vector<float> _synthFreq;
+  std::vector<float> _synthPhase;
+  std::vector<int> _peaks;
+  std::vector<std::complex<float>> _synthSpectrum;
+  std::vector<float> _synthFrame;
+  std::vector<float> _olaAccumulator;
+  std::vector<float> _scratch;
+  jnk0le::Ringbuffer<float, fifoSize> _wetFifo;
+  jnk0le::Ringbuffer<float, fifoSize> _dryFifo;
+  float _semitoneShift = 0.f;
+  float _mixPercentage = 0.f;
+  float _currentMix = 0.f;
+  int _numBufferFailures = 0;
+};
+} // namespace saint
@@ -0,0 +1,84 @@
+#include "PhaseVocoderPitchShifter.h"
+#include "PitchDetectorImpl.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+constexpr auto sampleRate = 44100;
+constexpr auto blockSize = 512;
+constexpr auto twoPi = 6.283185307179586;
+
+std::vector<float> makeSine(float freq, int numSamples) {
+  std::vector<float> sine(numSamples);
+  for (auto i = 0; i < numSamples; ++i) {
+    sine[i] = 0.5f * static_cast<float>(std::sin(twoPi * freq * i / sampleRate));
+  }
+  return sine;
+}
+
+float getZeroCrossingFrequency(const std::vector<float> &audio, int begin,
+                               int end) {
+  auto numCrossings = 0;
+  for (auto i = begin + 1; i < end; ++i) {
+    if ((audio[i - 1] < 0.f) != (audio[i] < 0.f)) {
+      ++numCrossings;
+    }
+  }
+  return numCrossings * sampleRate / 2.f / static_cast<float>(end - begin);
+}
+
+struct Chain {
+  Chain()
+      : detector(sampleRate, 110.f, std::nullopt,
+                 PhaseVocoderPitchShifter::analysisOverlap),
+        sut(detector.getAnalysisWindow(), detector.getFftSize(),
+            detector.getHopSize()) {
+    detector.setAnalysisFrameListener(&sut);
+  }
+  void process(std::vector<float> &audio) {
+    for (auto n = 0; n + blockSize <= static_cast<int>(audio.size());
+         n += blockSize) {
+      const auto p = audio.data() + n;
+      detector.process(p, blockSize);
+      sut.processBuffer(&p, 1, blockSize);
+    }
+  }
+  PitchDetectorImpl detector;
+  PhaseVocoderPitchShifter sut;
+};
+} // namespace
+
+TEST(PhaseVocoderPitchShifter, dry_signal_is_delayed_by_latency) {
+  Chain chain;
+  chain.sut.setMixPercentage(0.f);
+  const auto input = makeSine(220.f, sampleRate / 2);
+  auto output = input;
+  chain.process(output);
+  const auto latency = chain.sut.getLatency();
+  EXPECT_THAT(latency, Eq(static_cast<int>(chain.detector.getAnalysisWindow().size())));
+  for (auto i = latency; i < static_cast<int>(output.size()) - blockSize; ++i) {
+    ASSERT_FLOAT_EQ(output[i], input[i - latency]);
+  }
+}
+
+TEST(PhaseVocoderPitchShifter, shifts_an_octave_up) {
+  Chain chain;
+  chain.sut.setMixPercentage(100.f);
+  chain.sut.setSemitoneShift(12.f);
+  auto audio = makeSine(220.f, sampleRate);
+  chain.process(audio);
+  const auto begin = sampleRate / 4;
+  const auto end = sampleRate - blockSize;
+  EXPECT_THAT(getZeroCrossingFrequency(audio, begin, end),
+              FloatNear(440.f, 10.f));
+  EXPECT_THAT(chain.sut.getNumBufferFailures(), Eq(0));
+}
+
+} // namespace saint
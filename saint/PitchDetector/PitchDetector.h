@@ -1,16 +1,40 @@
 #pragma once
 
+#include <complex>
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace saint {
 class PitchDetector {
 public:
+  // Receives every analysis frame's spectrum right after the forward FFT, i.e.
+  // before the detector turns it into an autocorrelation. Lets a
+  // frequency-domain pitch shifter reuse the detector's transform.
+  class AnalysisFrameListener {
+  public:
+    virtual ~AnalysisFrameListener() = default;
+    virtual void onAnalysisFrame(const std::complex<float> *spectrum,
+                                 int spectrumSize) = 0;
+  };
+
+  // Number of analysis frames overlapping any given sample. 2 is enough for
+  // pitch detection ; a phase vocoder wants at least 4.
+  static constexpr auto defaultAnalysisOverlap = 2;
+
   static std::unique_ptr<PitchDetector>
   createInstance(int sampleRate,
-                 const std::optional<float> &leastFrequencyToDetect);
+                 const std::optional<float> &leastFrequencyToDetect,
+                 int analysisOverlap = defaultAnalysisOverlap);
   static constexpr auto maxBlockSize = 8192;
   virtual std::optional<float> process(const float *, int) = 0;
+  virtual void setAnalysisFrameListener(AnalysisFrameListener *) = 0;
+  virtual const std::vector<float> &getAnalysisWindow() const = 0;
+  virtual int getFftSize() const = 0;
+  virtual int getHopSize() const = 0;
+  // May be called between `process` calls. Only affects how often the pitch
+  // is updated.
+  virtual void setAnalysisOverlap(int) = 0;
   virtual ~PitchDetector() = default;
 };
-} // namespace saint
\ No newline at end of file
+} // namespace saint
@@ -1,9 +1,13 @@
 #include "PitchDetectorImpl.h"
-#include "PitchDetectorDebugCb.h"
+#include "DebugHooks.h"
+#include "PitchDetectorDebugSink.h"
+#include "Tracing.h"
 #include "Utils.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iterator>
 #include <limits>
 #include <math.h>
 #include <numeric>
@@ -12,17 +16,17 @@
 namespace saint {
 
 std::unique_ptr<PitchDetector> PitchDetector::createInstance(
-    int sampleRate, const std::optional<float> &leastFrequencyToDetect) {
-  const auto debug =
-      utils::getEnvironmentVariableAsBool("SAINT_DEBUG_PITCHDETECTOR");
-  if (debug && utils::isDebugBuild()) {
+    int sampleRate, const std::optional<float> &leastFrequencyToDetect,
+    int analysisOverlap) {
+#ifdef SAINT_DEBUG_HOOKS
+  if (utils::getEnvironmentVariableAsBool("SAINT_DEBUG_PITCHDETECTOR")) {
     return std::make_unique<PitchDetectorImpl>(
         sampleRate, leastFrequencyToDetect,
-        testUtils::getPitchDetectorDebugCb());
-  } else {
-    return std::make_unique<PitchDetectorImpl>(
-        sampleRate, leastFrequencyToDetect, std::nullopt);
+        testUtils::makePitchDetectorDebugSink(), analysisOverlap);
   }
+#endif
+  return std::make_unique<PitchDetectorImpl>(
+      sampleRate, leastFrequencyToDetect, nullptr, analysisOverlap);
 }
 
 namespace {
@@ -35,6 +39,10 @@ int getFftOrder(int windowSize) {
 
 int getFftSizeSamples(int windowSize) { return 1 << getFftOrder(windowSize); }
 
+int getHopSizeSamples(int windowSize, int analysisOverlap) {
+  return std::max(windowSize / std::max(analysisOverlap, 1), 1);
+}
+
 int getWindowSizeSamples(int sampleRate,
                          const std::optional<float> &leastFrequencyToDetect) {
   // If not provided, use the lower open-E of a guitar.
@@ -71,18 +79,27 @@ void applyWindow(const std::vector<float> &window, std::vector<float> &input) {
 }
 
 void getXCorr(pffft::Fft<float> &fft, std::vector<float> &time,
-              const std::vector<float> &lpWindow) {
-  Aligned<std::vector<std::complex<float>>> freq;
-  freq.value.resize(fft.getSpectrumSize());
-  auto freqData = freq.value.data();
+              std::vector<std::complex<float>> &freq,
+              const std::vector<float> &lpWindow,
+              PitchDetector::AnalysisFrameListener *listener = nullptr) {
+  auto freqData = freq.data();
   auto timeData = time.data();
-  fft.forward(timeData, freqData);
+  {
+    SAINT_TRACE_ZONE("pffft forward");
+    fft.forward(timeData, freqData);
+  }
+  if (listener) {
+    listener->onAnalysisFrame(freqData, fft.getSpectrumSize());
+  }
   for (auto i = 0; i < lpWindow.size(); ++i) {
     auto &X = freqData[i];
     X *= lpWindow[i] * std::complex<float>{X.real(), -X.imag()};
   }
   std::fill(freqData + lpWindow.size(), freqData + fft.getSpectrumSize(), 0.f);
-  fft.inverse(freqData, timeData);
+  {
+    SAINT_TRACE_ZONE("pffft inverse");
+    fft.inverse(freqData, timeData);
+  }
   const auto normalizer = 1.f / timeData[0];
   for (auto i = 0u; i < fft.getLength(); ++i) {
     timeData[i] *= normalizer;
@@ -111,71 +128,114 @@ std::vector<float> getWindowXCorr(pffft::Fft<float> &fftEngine,
   xcorr.resize((fftEngine.getLength()));
   std::copy(window.begin(), window.end(), xcorr.begin());
   std::fill(xcorr.begin() + window.size(), xcorr.end(), 0.f);
-  getXCorr(fftEngine, xcorr, lpWindow);
+  std::vector<std::complex<float>> freq(fftEngine.getSpectrumSize());
+  getXCorr(fftEngine, xcorr, freq, lpWindow);
   return xcorr;
 }
 } // namespace
 
 PitchDetectorImpl::PitchDetectorImpl(
     int sampleRate, const std::optional<float> &leastFrequencyToDetect,
-    std::optional<testUtils::PitchDetectorDebugCb> debugCb)
-    : _sampleRate(sampleRate), _debugCb(std::move(debugCb)),
-      _window(getAnalysisWindow(
+    [[maybe_unused]] std::unique_ptr<testUtils::PitchDetectorDebugSink>
+        debugSink,
+    int analysisOverlap)
+    : _sampleRate(sampleRate),
+#ifdef SAINT_DEBUG_HOOKS
+      _debugSink(std::move(debugSink)),
+#endif
+      _window(::saint::getAnalysisWindow(
           getWindowSizeSamples(sampleRate, leastFrequencyToDetect))),
       _fftSize(getFftSizeSamples(static_cast<int>(_window.size()))),
-      _fwdFft(_fftSize), _lpWindow(getLpWindow(sampleRate, _fftSize)),
+      _hopSize(getHopSizeSamples(static_cast<int>(_window.size()),
+                                 analysisOverlap)),
+      _fwdFft(_fftSize), _history(_window.size(), 0.f),
+      // Same as having the first frame half-filled with zeros when the
+      // overlap is 2.
+      _samplesUntilNextFrame(_hopSize), _time(_fftSize),
+      _freq(_fwdFft.getSpectrumSize()),
+      _lpWindow(getLpWindow(sampleRate, _fftSize)),
+      _windowXcor(getWindowXCorr(_fwdFft, _window, _lpWindow)),
       _lastSearchIndex(
-          std::min(_fftSize / 2, static_cast<int>(sampleRate / 70))),
-      _windowXcor(getWindowXCorr(_fwdFft, _window, _lpWindow)) {
+          std::min(_fftSize / 2, static_cast<int>(sampleRate / 70))) {}
+
+void PitchDetectorImpl::setAnalysisFrameListener(
+    AnalysisFrameListener *listener) {
+  _analysisFrameListener = listener;
+}
+
+const std::vector<float> &PitchDetectorImpl::getAnalysisWindow() const {
+  return _window;
+}
 
-  // Fill the first ring buffer with half the window size of zeros.
-  std::vector<float> zeros(_window.size() / 2);
-  std::fill(zeros.begin(), zeros.end(), 0.f);
-  _ringBuffers[0].writeBuff(zeros.data(), zeros.size());
+int PitchDetectorImpl::getFftSize() const { return _fftSize; }
+
+int PitchDetectorImpl::getHopSize() const { return _hopSize; }
+
+void PitchDetectorImpl::setAnalysisOverlap(int overlap) {
+  _hopSize = getHopSizeSamples(static_cast<int>(_window.size()), overlap);
+  _samplesUntilNextFrame = std::min(_samplesUntilNextFrame, _hopSize);
 }
 
 std::optional<float> PitchDetectorImpl::process(const float *audio,
                                                 int audioSize) {
-  _ringBuffers[0].writeBuff(audio, audioSize);
-  _ringBuffers[1].writeBuff(audio, audioSize);
-  std::vector<testUtils::PitchDetectorFftAnal> analyses;
-  while (_ringBuffers[_ringBufferIndex].readAvailable() >= _window.size()) {
-    std::vector<float> time(_fftSize);
-    _ringBuffers[_ringBufferIndex].readBuff(time.data(), _window.size());
-    std::fill(time.begin() + _window.size(), time.begin() + _fftSize, 0.f);
-    applyWindow(_window, time);
-    getXCorr(_fwdFft, time, _lpWindow);
-    auto &max = _maxima[_ringBufferIndex] = 0;
-    auto maxIndex = 0;
-    auto wentNegative = false;
-    for (auto i = 0; i < _lastSearchIndex; ++i) {
-      wentNegative |= time[i] < 0;
-      if (wentNegative && time[i] > max) {
-        max = time[i];
-        maxIndex = i;
-      }
-    }
-    max /= _windowXcor[maxIndex];
-    if (_debugCb) {
-      testUtils::PitchDetectorFftAnal analysis;
-      analysis.xcor = time;
-      analysis.windowSize = _window.size();
-      analysis.olapAnalIndex = _ringBufferIndex;
-      analysis.peakIndex = maxIndex;
-      analysis.scaledMax = max;
-      analysis.maxMin = std::min(_maxima[0], _maxima[1]);
-      analyses.push_back(analysis);
+  SAINT_TRACE_ZONE("PitchDetectorImpl::process");
+  auto remaining = audioSize;
+  while (remaining > 0) {
+    const auto n = std::min(remaining, _samplesUntilNextFrame);
+    _writeHistory(audio, n);
+    audio += n;
+    remaining -= n;
+    _samplesUntilNextFrame -= n;
+    if (_samplesUntilNextFrame == 0) {
+      _samplesUntilNextFrame = _hopSize;
+      _analyzeFrame(audioSize - remaining);
     }
-    _ringBufferIndex = (_ringBufferIndex + 1) % _ringBuffers.size();
-    if (max > 0.9) {
-      _detectedPitch = _sampleRate / maxIndex;
-    } else {
-      _detectedPitch.reset();
+  }
+  SAINT_DEBUG_HOOK(_debugSink, onBlockProcessed(_detectedPitch, audioSize));
+  return _detectedPitch;
+}
+
+void PitchDetectorImpl::_writeHistory(const float *audio, int size) {
+  const auto historySize = static_cast<int>(_history.size());
+  while (size > 0) {
+    const auto n = std::min(size, historySize - _historyWriteIndex);
+    std::copy(audio, audio + n, _history.begin() + _historyWriteIndex);
+    audio += n;
+    size -= n;
+    _historyWriteIndex = (_historyWriteIndex + n) % historySize;
+  }
+}
+
+void PitchDetectorImpl::_analyzeFrame([[maybe_unused]] int blockOffset) {
+  // Oldest sample first.
+  const auto oldest = _history.begin() + _historyWriteIndex;
+  std::copy(oldest, _history.end(), _time.begin());
+  std::copy(_history.begin(), oldest,
+            _time.begin() + std::distance(oldest, _history.end()));
+  std::fill(_time.begin() + _window.size(), _time.end(), 0.f);
+  applyWindow(_window, _time);
+  getXCorr(_fwdFft, _time, _freq, _lpWindow, _analysisFrameListener);
+  auto &max = _maxima[_olapAnalIndex] = 0;
+  auto maxIndex = 0;
+  auto wentNegative = false;
+  for (auto i = 0; i < _lastSearchIndex; ++i) {
+    wentNegative |= _time[i] < 0;
+    if (wentNegative && _time[i] > max) {
+      max = _time[i];
+      maxIndex = i;
     }
   }
-  if (_debugCb) {
-    (*_debugCb)({analyses, _detectedPitch, audioSize});
+  max /= _windowXcor[maxIndex];
+  SAINT_DEBUG_HOOK(_debugSink,
+                   onAnalysis({static_cast<int>(_window.size()), _time,
+                               _olapAnalIndex, maxIndex, max,
+                               std::min(_maxima[0], _maxima[1]),
+                               blockOffset}));
+  _olapAnalIndex = (_olapAnalIndex + 1) % _maxima.size();
+  if (max > 0.9) {
+    _detectedPitch = _sampleRate / maxIndex;
+  } else {
+    _detectedPitch.reset();
   }
-  return _detectedPitch;
 }
 } // namespace saint
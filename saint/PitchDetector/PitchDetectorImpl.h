@@ -1,13 +1,13 @@
 #pragma once
 
 #include "PitchDetector.h"
-#include "PitchDetectorDebugCb.h"
+#include "PitchDetectorDebugSink.h"
 
 #include <pffft.hpp>
-#include <ringbuffer.hpp>
 
 #include <array>
-#include <functional>
+#include <complex>
+#include <memory>
 #include <optional>
 
 namespace saint {
@@ -20,23 +20,42 @@ template <typename T> struct alignas(16) Aligned {
 class PitchDetectorImpl : public PitchDetector {
 public:
   // Don't even try instantiating me if the block size exceeds this.
-  PitchDetectorImpl(int sampleRate,
-                    const std::optional<float> &leastFrequencyToDetect,
-                    std::optional<testUtils::PitchDetectorDebugCb>);
+  // `debugSink` is ignored unless SAINT_DEBUG_HOOKS is defined.
+  PitchDetectorImpl(
+      int sampleRate, const std::optional<float> &leastFrequencyToDetect,
+      std::unique_ptr<testUtils::PitchDetectorDebugSink> debugSink,
+      int analysisOverlap = defaultAnalysisOverlap);
   std::optional<float> process(const float *, int) override;
+  void setAnalysisFrameListener(AnalysisFrameListener *) override;
+  const std::vector<float> &getAnalysisWindow() const override;
+  int getFftSize() const override;
+  int getHopSize() const override;
+  void setAnalysisOverlap(int) override;
 
 private:
+  void _writeHistory(const float *, int);
+  void _analyzeFrame(int blockOffset);
+
   const float _sampleRate;
-  const std::optional<testUtils::PitchDetectorDebugCb> _debugCb;
+#ifdef SAINT_DEBUG_HOOKS
+  const std::unique_ptr<testUtils::PitchDetectorDebugSink> _debugSink;
+#endif
   const std::vector<float> _window;
   const int _fftSize;
+  int _hopSize;
   pffft::Fft<float> _fwdFft;
-  std::array<jnk0le::Ringbuffer<float, maxBlockSize>, 2> _ringBuffers;
-  std::array<float, 2> _maxima;
-  int _ringBufferIndex = 0;
+  // The last `_window.size()` input samples, circularly.
+  std::vector<float> _history;
+  int _historyWriteIndex = 0;
+  int _samplesUntilNextFrame;
+  std::vector<float> _time;
+  std::vector<std::complex<float>> _freq;
+  std::array<float, 2> _maxima = {0.f, 0.f};
+  int _olapAnalIndex = 0;
   const std::vector<float> _lpWindow;
   const std::vector<float> _windowXcor;
   const int _lastSearchIndex;
   std::optional<float> _detectedPitch;
+  AnalysisFrameListener *_analysisFrameListener = nullptr;
 };
 } // namespace saint
@@ -22,7 +22,7 @@ std::vector<float> makeNyquistWave(int numSamples) {
 } // namespace
 
 TEST(PitchDetectorImpl, firstPfftBinIsDcAndNyquist) {
-  PitchDetectorImpl sut(44100, std::nullopt, std::nullopt);
+  PitchDetectorImpl sut(44100, std::nullopt, nullptr);
   constexpr auto blockSize = 512;
   const auto audio = makeNyquistWave(blockSize);
   pffft::Fft<float> fftEngine(blockSize);
@@ -33,13 +33,12 @@ TEST(PitchDetectorImpl, firstPfftBinIsDcAndNyquist) {
 }
 
 TEST(PitchDetectorImpl, stuff) {
-  const auto debugCb = testUtils::getPitchDetectorDebugCb();
   constexpr auto blockSize = 512;
   // const auto src = testUtils::getJuceWavFileReader(
   //     "C:/Users/saint/Downloads/TOP-80-GREATEST-GUITAR-INTROS.wav");
   const auto src = testUtils::getJuceWavFileReader(
       fs::absolute("./saint/_assets/Les_Petits_Poissons.wav"));
-  PitchDetectorImpl sut(44100, 83.f, std::move(debugCb));
+  PitchDetectorImpl sut(44100, 83.f, testUtils::makePitchDetectorDebugSink());
   for (auto n = 0; n + blockSize < src->lengthInSamples; n += blockSize) {
     std::vector<float> buffer(blockSize);
     std::vector<float *> channels(1);
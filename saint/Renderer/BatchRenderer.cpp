@@ -0,0 +1,122 @@
+#include "BatchRenderer.h"
+#include "Score.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace saint {
+namespace fs = std::filesystem;
+
+namespace {
+class SharedScores {
+public:
+  std::shared_ptr<const Score> get(const fs::path &path) {
+    std::promise<std::shared_ptr<const Score>> promise;
+    std::shared_future<std::shared_ptr<const Score>> future;
+    auto mustLoad = false;
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      const auto key = fs::absolute(path).lexically_normal();
+      const auto it = _scores.find(key);
+      if (it == _scores.end()) {
+        future = promise.get_future().share();
+        _scores.emplace(key, future);
+        mustLoad = true;
+      } else {
+        future = it->second;
+      }
+    }
+    if (mustLoad) {
+      // Other jobs on the same file block until this is done, but only for as
+      // long as they would have taken loading it themselves.
+      std::shared_ptr<const Score> score;
+      try {
+        score = loadScore(path);
+      } catch (...) {
+        // Failing this job and the others on the file alike, rather than
+        // leaving them waiting on a promise that never gets kept.
+      }
+      promise.set_value(std::move(score));
+    }
+    return future.get();
+  }
+
+  int size() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return static_cast<int>(_scores.size());
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::map<fs::path, std::shared_future<std::shared_ptr<const Score>>> _scores;
+};
+
+std::uintmax_t getFileSize(const fs::path &path) {
+  std::error_code ec;
+  const auto size = fs::file_size(path, ec);
+  return ec ? 0u : size;
+}
+} // namespace
+
+double BatchReport::getThroughput() const {
+  return wallSeconds > 0. ? audioSeconds / wallSeconds : 0.;
+}
+
+int BatchReport::getNumFailedJobs() const {
+  return static_cast<int>(
+      std::count_if(jobs.begin(), jobs.end(),
+                    [](const BatchJobResult &job) { return !job.report; }));
+}
+
+BatchReport renderBatch(const std::vector<RenderConfig> &jobs,
+                        int numThreads) {
+  const auto start = std::chrono::steady_clock::now();
+  BatchReport batch;
+  batch.jobs.resize(jobs.size());
+  SharedScores scores;
+  {
+    WorkStealingPool pool{numThreads};
+    batch.numThreads = pool.getNumThreads();
+    // Workers take the latest task of their queue first: submitting the
+    // shortest jobs first has the longest ones start first, so that the pool
+    // doesn't end up waiting on a long take started last. Input file size is
+    // a good enough proxy for duration.
+    std::vector<size_t> order(jobs.size());
+    std::vector<std::uintmax_t> sizes(jobs.size());
+    for (auto i = 0u; i < jobs.size(); ++i) {
+      order[i] = i;
+      sizes[i] = getFileSize(jobs[i].inputWav);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return sizes[a] < sizes[b]; });
+    for (const auto i : order) {
+      pool.submit([&, i] {
+        const auto &config = jobs[i];
+        auto &result = batch.jobs[i];
+        const auto score = scores.get(config.midiFile);
+        if (!score) {
+          result.error = "could not read " + config.midiFile.string();
+          return;
+        }
+        result.report = render(config, score, result.error);
+      });
+    }
+    pool.wait();
+  }
+  batch.numScoresLoaded = scores.size();
+  for (const auto &job : batch.jobs) {
+    if (job.report) {
+      batch.audioSeconds += job.report->audioSeconds;
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  batch.wallSeconds = elapsed.count();
+  return batch;
+}
+} // namespace saint
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Renderer.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace saint {
+struct BatchJobResult {
+  std::optional<RenderReport> report;
+  std::string error;
+};
+
+struct BatchReport {
+  // Same order as the jobs.
+  std::vector<BatchJobResult> jobs;
+  int numThreads = 0;
+  int numScoresLoaded = 0;
+  // Summed over successful jobs.
+  double audioSeconds = 0.;
+  double wallSeconds = 0.;
+
+  // Audio seconds rendered per second of wall-clock time, all jobs together.
+  double getThroughput() const;
+  int getNumFailedJobs() const;
+};
+
+// Renders all `jobs` concurrently on a work-stealing pool of `numThreads`
+// (one per hardware thread if <= 0). Jobs using the same MIDI file share a
+// single parsed score, loaded by whichever job needs it first.
+BatchReport renderBatch(const std::vector<RenderConfig> &jobs,
+                        int numThreads = 0);
+} // namespace saint
@@ -0,0 +1,151 @@
+#include "Renderer.h"
+#include "DefaultMidiFileOwner.h"
+#include "Playheads/ProcessCallbackDrivenPlayhead.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace saint {
+namespace fs = std::filesystem;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double getSecondsSince(Clock::time_point &start) {
+  const auto now = Clock::now();
+  const std::chrono::duration<double> elapsed = now - start;
+  start = now;
+  return elapsed.count();
+}
+
+std::optional<std::vector<float>> readMonoWav(const fs::path &path,
+                                              int &sampleRate) {
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+  const std::unique_ptr<juce::AudioFormatReader> reader{
+      formatManager.createReaderFor(juce::File{path.string()})};
+  if (!reader || reader->numChannels == 0) {
+    return std::nullopt;
+  }
+  const auto numChannels = static_cast<int>(reader->numChannels);
+  const auto numSamples = static_cast<int>(reader->lengthInSamples);
+  juce::AudioBuffer<float> buffer{numChannels, numSamples};
+  if (!reader->read(&buffer, 0, numSamples, 0, true, true)) {
+    return std::nullopt;
+  }
+  std::vector<float> mono(static_cast<size_t>(numSamples), 0.f);
+  for (auto channel = 0; channel < numChannels; ++channel) {
+    const auto p = buffer.getReadPointer(channel);
+    for (auto i = 0; i < numSamples; ++i) {
+      mono[i] += p[i] / static_cast<float>(numChannels);
+    }
+  }
+  sampleRate = static_cast<int>(reader->sampleRate);
+  return mono;
+}
+} // namespace
+
+bool writeMonoWav(const fs::path &path, const std::vector<float> &audio,
+                  int sampleRate) {
+  if (fs::exists(path)) {
+    fs::remove(path);
+  }
+  juce::WavAudioFormat format;
+  auto stream = std::make_unique<juce::FileOutputStream>(
+      juce::File{path.string()});
+  if (stream->failedToOpen()) {
+    return false;
+  }
+  const std::unique_ptr<juce::AudioFormatWriter> writer{format.createWriterFor(
+      stream.get(), static_cast<double>(sampleRate), 1, 24, {}, 0)};
+  if (!writer) {
+    return false;
+  }
+  // The writer now owns the stream.
+  stream.release();
+  const auto p = audio.data();
+  return writer->writeFromFloatArrays(&p, 1, static_cast<int>(audio.size()));
+}
+
+double RenderReport::getRealTimeFactor() const {
+  return processSeconds > 0. ? audioSeconds / processSeconds : 0.;
+}
+
+std::optional<RenderReport> render(const RenderConfig &config,
+                                   std::string &error) {
+  const auto start = Clock::now();
+  auto score = loadScore(config.midiFile);
+  if (!score) {
+    error = "could not read " + config.midiFile.string();
+    return std::nullopt;
+  }
+  const std::chrono::duration<double> loadSeconds = Clock::now() - start;
+  auto report = render(config, std::move(score), error);
+  if (report) {
+    report->loadSeconds += loadSeconds.count();
+  }
+  return report;
+}
+
+std::optional<RenderReport> render(const RenderConfig &config,
+                                   std::shared_ptr<const Score> score,
+                                   std::string &error) {
+  RenderReport report;
+  auto start = Clock::now();
+
+  auto sampleRate = 0;
+  auto audio = readMonoWav(config.inputWav, sampleRate);
+  if (!audio) {
+    error = "could not read " + config.inputWav.string();
+    return std::nullopt;
+  }
+  const auto midiFileOwner = std::make_shared<DefaultMidiFileOwner>(
+      [](float) {}, [](PlayheadCommand) { return false; });
+  midiFileOwner->setSampleRate(sampleRate);
+  midiFileOwner->setScore(std::move(score));
+  midiFileOwner->setPlayedTrack(config.playedTrack);
+  midiFileOwner->setHarmonyTrack(config.harmonyTrack);
+  if (!midiFileOwner->hasIntervalGetter()) {
+    error = "could not get intervals from tracks " +
+            std::to_string(config.playedTrack) + " and " +
+            std::to_string(config.harmonyTrack) + " of " +
+            config.midiFile.string();
+    return std::nullopt;
+  }
+  report.loadSeconds = getSecondsSince(start);
+
+  ProcessCallbackDrivenPlayhead playhead{sampleRate,
+                                         midiFileOwner->getTempoMap()};
+  SoloHarmonizer harmonizer{midiFileOwner, playhead};
+  const auto blockSize =
+      std::clamp(config.blockSize, 1, PitchDetector::maxBlockSize);
+  harmonizer.prepareToPlay(sampleRate, blockSize, config.processingMode);
+  const auto latency = harmonizer.getLatency();
+  const auto numInputSamples = static_cast<int>(audio->size());
+  // Flush what's still in the shifter at the end of the input.
+  audio->resize(audio->size() + latency, 0.f);
+  report.prepareSeconds = getSecondsSince(start);
+
+  const auto numSamples = static_cast<int>(audio->size());
+  for (auto offset = 0; offset < numSamples; offset += blockSize) {
+    const auto n = std::min(blockSize, numSamples - offset);
+    harmonizer.processBlock(audio->data() + offset, n);
+    playhead.incrementSampleCount(n);
+  }
+  report.processSeconds = getSecondsSince(start);
+  report.stages = harmonizer.getStageDurations();
+
+  audio->erase(audio->begin(), audio->begin() + latency);
+  if (!writeMonoWav(config.outputWav, *audio, sampleRate)) {
+    error = "could not write " + config.outputWav.string();
+    return std::nullopt;
+  }
+  report.writeSeconds = getSecondsSince(start);
+  report.sampleRate = sampleRate;
+  report.audioSeconds =
+      static_cast<double>(numInputSamples) / static_cast<double>(sampleRate);
+  return report;
+}
+} // namespace saint
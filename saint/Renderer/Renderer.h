@@ -0,0 +1,52 @@
+#pragma once
+
+#include "DavidCNAntonia/IPitchShifter.h"
+#include "Score.h"
+#include "SoloHarmonizer.h"
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace saint {
+struct RenderConfig {
+  std::filesystem::path inputWav;
+  std::filesystem::path midiFile;
+  std::filesystem::path outputWav;
+  int playedTrack = 0;
+  int harmonyTrack = 0;
+  int blockSize = 512;
+  DavidCNAntonia::ProcessingMode processingMode =
+      DavidCNAntonia::ProcessingMode::offline;
+};
+
+struct RenderReport {
+  int sampleRate = 0;
+  double audioSeconds = 0.;
+  double loadSeconds = 0.;
+  double prepareSeconds = 0.;
+  double processSeconds = 0.;
+  double writeSeconds = 0.;
+  SoloHarmonizer::StageDurations stages;
+
+  // How many seconds of audio are rendered per second of processing.
+  double getRealTimeFactor() const;
+};
+
+// Renders `config.inputWav` harmonized, aligned with the input, i.e., the
+// shifter latency is compensated for. Multichannel input is mixed down to
+// mono. On failure, returns nullopt and sets `error`.
+std::optional<RenderReport> render(const RenderConfig &config,
+                                   std::string &error);
+
+// Same, with `config.midiFile` already loaded as `score`, which may be shared
+// with concurrent renders.
+std::optional<RenderReport> render(const RenderConfig &config,
+                                   std::shared_ptr<const Score> score,
+                                   std::string &error);
+
+// Overwrites `path` with a 24-bit mono WAV file.
+bool writeMonoWav(const std::filesystem::path &path,
+                  const std::vector<float> &audio, int sampleRate);
+} // namespace saint
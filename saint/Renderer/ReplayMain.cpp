@@ -0,0 +1,92 @@
+#include "Replayer.h"
+#include "Tracing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " --capture <file.saintcap> [--output <out.wav>]"
+               " [--trace <file.json>]\n"
+               "  Replays a session captured by the plugin with "
+               "SAINT_CAPTURE_SESSION=1.\n"
+               "  --output  write what the plugin output (not "
+               "latency-compensated).\n"
+               "  --trace   write the trace zones to a Chrome trace file "
+               "(builds with\n"
+               "            SAINT_TRACING only).\n";
+}
+
+// Load shedding depends on how busy the machine is, which would make replays
+// take different code paths from one run to the next.
+void disableLoadSheddingUnlessSet() {
+  if (std::getenv("SAINT_LOAD_SHEDDING")) {
+    return;
+  }
+#ifdef _WIN32
+  _putenv_s("SAINT_LOAD_SHEDDING", "0");
+#else
+  setenv("SAINT_LOAD_SHEDDING", "0", 0);
+#endif
+}
+
+void printTiming(const char *name, double seconds, double total) {
+  std::printf("  %-16s %9.3f s %6.1f %%\n", name, seconds,
+              total > 0. ? 100. * seconds / total : 0.);
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string capture;
+  std::optional<std::filesystem::path> output;
+  std::string traceFile;
+  for (auto i = 1; i + 1 < argc; i += 2) {
+    const std::string arg{argv[i]};
+    if (arg == "--capture") {
+      capture = argv[i + 1];
+    } else if (arg == "--output") {
+      output = argv[i + 1];
+    } else if (arg == "--trace") {
+      traceFile = argv[i + 1];
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (capture.empty() || argc % 2 == 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  disableLoadSheddingUnlessSet();
+  std::string error;
+  const auto report = saint::replay(capture, output, error);
+  if (!report) {
+    std::cerr << "error: " << error << "\n";
+    return 1;
+  }
+  if (!traceFile.empty() && !saint::tracing::dumpChromeTrace(traceFile)) {
+    std::cerr << "error: could not write " << traceFile
+              << " (is tracing compiled in ?)\n";
+    return 1;
+  }
+  const auto &stages = report->stages;
+  std::printf("%d blocks, %.2f s of audio at %d Hz", report->numBlocks,
+              report->audioSeconds, report->sampleRate);
+  if (report->numDroppedBlocks > 0) {
+    std::printf(" (%d blocks missing from the capture)",
+                report->numDroppedBlocks);
+  }
+  std::printf("\nreal-time factor: %.1fx\n", report->getRealTimeFactor());
+  std::printf("process breakdown:\n");
+  printTiming("pitch detection", stages.pitchDetection, stages.total);
+  printTiming("interval lookup", stages.intervalLookup, stages.total);
+  printTiming("pitch shifting", stages.pitchShifting, stages.total);
+  printTiming("other", stages.total - stages.pitchDetection -
+                           stages.intervalLookup - stages.pitchShifting,
+              stages.total);
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "Replayer.h"
+#include "DefaultMidiFileOwner.h"
+#include "Playhead.h"
+#include "Renderer.h"
+#include "SessionCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <variant>
+
+namespace saint {
+namespace fs = std::filesystem;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Tells the time the plugin's playhead told when the block was captured.
+class RecordedPlayhead : public Playhead {
+public:
+  void setBlock(const capture::Block &block) {
+    _time = block.timeInCrotchets;
+    _jumps = block.jumps;
+    _partTimes = block.partTimes;
+  }
+  std::optional<float> incrementSampleCount(int) override { return _time; }
+  std::optional<float> getTimeInCrotchets() override { return _time; }
+  // Parts left out of the capture replay without a time.
+  std::optional<float> getTimeInCrotchetsAt(int sampleOffset) override {
+    const auto it =
+        std::find_if(_partTimes.begin(), _partTimes.end(),
+                     [sampleOffset](const capture::PartTime &partTime) {
+                       return partTime.sampleOffset == sampleOffset;
+                     });
+    return it == _partTimes.end() ? std::nullopt : it->timeInCrotchets;
+  }
+  std::optional<Jump> getJump(int fromSample, int numSamples) override {
+    const auto it = std::find_if(
+        _jumps.begin(), _jumps.end(), [fromSample](const Jump &jump) {
+          return jump.numSamplesBefore >= fromSample;
+        });
+    if (it == _jumps.end() ||
+        it->numSamplesBefore >= fromSample + numSamples) {
+      return std::nullopt;
+    }
+    return *it;
+  }
+
+private:
+  std::optional<float> _time;
+  std::vector<Jump> _jumps;
+  std::vector<capture::PartTime> _partTimes;
+};
+} // namespace
+
+double ReplayReport::getRealTimeFactor() const {
+  return processSeconds > 0. ? audioSeconds / processSeconds : 0.;
+}
+
+std::optional<ReplayReport> replay(const fs::path &capture,
+                                   const std::optional<fs::path> &outputWav,
+                                   std::string &error) {
+  CaptureReader reader{capture};
+  if (!reader.isOpen()) {
+    error = "could not read " + capture.string() + " as a session capture";
+    return std::nullopt;
+  }
+  const auto midiFileOwner = std::make_shared<DefaultMidiFileOwner>(
+      [](float) {}, [](PlayheadCommand) { return false; });
+  RecordedPlayhead playhead;
+  SoloHarmonizer harmonizer{midiFileOwner, playhead};
+  ReplayReport report;
+  auto isPrepared = false;
+  std::vector<float> block;
+  std::vector<float> output;
+
+  while (const auto record = reader.next()) {
+    if (const auto score = std::get_if<capture::Score>(&*record)) {
+      if (midiFileOwner->getMidiFile() != score->midiFile) {
+        auto loaded =
+            score->midiFile.empty() ? nullptr : loadScore(score->midiFile);
+        if (!score->midiFile.empty() && !loaded) {
+          error = "could not read " + score->midiFile.string();
+          return std::nullopt;
+        }
+        midiFileOwner->setScore(std::move(loaded));
+      }
+      if (score->playedTrack.has_value()) {
+        midiFileOwner->setPlayedTrack(*score->playedTrack);
+      }
+      if (score->harmonyTrack.has_value()) {
+        midiFileOwner->setHarmonyTrack(*score->harmonyTrack);
+      }
+    } else if (const auto prepare = std::get_if<capture::Prepare>(&*record)) {
+      midiFileOwner->setSampleRate(prepare->sampleRate);
+      harmonizer.prepareToPlay(prepare->sampleRate,
+                               std::clamp(prepare->samplesPerBlock, 1,
+                                          PitchDetector::maxBlockSize),
+                               prepare->processingMode);
+      report.sampleRate = prepare->sampleRate;
+      isPrepared = true;
+    } else if (const auto captured = std::get_if<capture::Block>(&*record)) {
+      const auto size = static_cast<int>(captured->samples.size());
+      if (!isPrepared) {
+        error = "unexpected block in " + capture.string();
+        return std::nullopt;
+      }
+      if (captured->processingMode != harmonizer.getProcessingMode()) {
+        // Switched without `prepareToPlay`, keeping the harmonizer's state.
+        harmonizer.setProcessingMode(captured->processingMode);
+      }
+      block = captured->samples;
+      playhead.setBlock(*captured);
+      const auto start = Clock::now();
+      harmonizer.processBlock(block.data(), size);
+      const std::chrono::duration<double> elapsed = Clock::now() - start;
+      report.processSeconds += elapsed.count();
+      report.audioSeconds +=
+          static_cast<double>(size) / static_cast<double>(report.sampleRate);
+      ++report.numBlocks;
+      if (outputWav) {
+        output.insert(output.end(), block.begin(), block.end());
+      }
+    } else if (const auto gap = std::get_if<capture::Gap>(&*record)) {
+      report.numDroppedBlocks += gap->numDroppedBlocks;
+    }
+  }
+  if (reader.hasError()) {
+    error = capture.string() + " is corrupt";
+    return std::nullopt;
+  }
+  report.stages = harmonizer.getStageDurations();
+  if (outputWav && !writeMonoWav(*outputWav, output, report.sampleRate)) {
+    error = "could not write " + outputWav->string();
+    return std::nullopt;
+  }
+  return report;
+}
+} // namespace saint
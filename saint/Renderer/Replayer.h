@@ -0,0 +1,33 @@
+#pragma once
+
+#include "SoloHarmonizer.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace saint {
+struct ReplayReport {
+  // Of the last `prepare` record.
+  int sampleRate = 0;
+  int numBlocks = 0;
+  // Blocks the recorder had to drop, which the replay hence misses.
+  int numDroppedBlocks = 0;
+  double audioSeconds = 0.;
+  double processSeconds = 0.;
+  SoloHarmonizer::StageDurations stages;
+
+  // How many seconds of audio are processed per second of processing.
+  double getRealTimeFactor() const;
+};
+
+// Feeds a capture made with SAINT_CAPTURE_SESSION through a `SoloHarmonizer`,
+// with the blocks, playhead times, MIDI file and track selection the plugin
+// had. If `outputWav` is given, the output is written there as the plugin
+// produced it, i.e., delayed by the shifter latency. On failure, returns
+// nullopt and sets `error`.
+std::optional<ReplayReport>
+replay(const std::filesystem::path &capture,
+       const std::optional<std::filesystem::path> &outputWav,
+       std::string &error);
+} // namespace saint
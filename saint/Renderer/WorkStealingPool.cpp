@@ -0,0 +1,118 @@
+#include "WorkStealingPool.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <string>
+
+namespace saint {
+
+namespace {
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local int currentWorkerIndex = -1;
+
+int getDefaultNumThreads() {
+  return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int numThreads) {
+  if (numThreads <= 0) {
+    numThreads = getDefaultNumThreads();
+  }
+  for (auto i = 0; i < numThreads; ++i) {
+    _queues.push_back(std::make_unique<Queue>());
+  }
+  for (auto i = 0; i < numThreads; ++i) {
+    _threads.emplace_back([this, i] { _work(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _stop = true;
+  }
+  _workAvailable.notify_all();
+  for (auto &thread : _threads) {
+    thread.join();
+  }
+}
+
+int WorkStealingPool::getNumThreads() const {
+  return static_cast<int>(_threads.size());
+}
+
+void WorkStealingPool::submit(Task task) {
+  const auto numQueues = static_cast<unsigned>(_queues.size());
+  const auto index = currentPool == this
+                         ? static_cast<unsigned>(currentWorkerIndex)
+                         : _nextQueue++ % numQueues;
+  {
+    // Counted before being queued, or another worker could steal and finish
+    // it, and let `wait()` return, before its submitter is done. Under the
+    // lock so that a worker about to sleep can't miss the notification.
+    std::lock_guard<std::mutex> lock{_mutex};
+    ++_numQueued;
+    ++_numUnfinished;
+  }
+  {
+    auto &queue = *_queues[index];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.tasks.push_back(std::move(task));
+  }
+  _workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+  std::unique_lock<std::mutex> lock{_mutex};
+  _allDone.wait(lock, [this] { return _numUnfinished == 0; });
+}
+
+void WorkStealingPool::_work(int workerIndex) {
+  currentPool = this;
+  currentWorkerIndex = workerIndex;
+  tracing::setThreadName("worker " + std::to_string(workerIndex));
+  while (true) {
+    Task task;
+    if (_pop(workerIndex, task) || _steal(workerIndex, task)) {
+      --_numQueued;
+      task();
+      std::lock_guard<std::mutex> lock{_mutex};
+      if (--_numUnfinished == 0) {
+        _allDone.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock{_mutex};
+    _workAvailable.wait(lock, [this] { return _stop || _numQueued > 0; });
+    if (_stop && _numQueued <= 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::_pop(int workerIndex, Task &task) {
+  auto &queue = *_queues[workerIndex];
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::_steal(int workerIndex, Task &task) {
+  const auto numQueues = static_cast<int>(_queues.size());
+  for (auto i = 1; i < numQueues; ++i) {
+    auto &queue = *_queues[(workerIndex + i) % numQueues];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace saint
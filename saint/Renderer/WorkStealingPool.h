@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace saint {
+// A fixed-size thread pool where each worker has its own task queue. A worker
+// takes the most recently pushed task of its own queue, and when that is
+// empty, steals the oldest task of another worker's. Tasks submitted from a
+// worker go to that worker's queue, others are spread round-robin.
+class WorkStealingPool {
+public:
+  using Task = std::function<void()>;
+
+  // `numThreads <= 0` means one per hardware thread.
+  explicit WorkStealingPool(int numThreads = 0);
+  // Runs whatever is still queued before returning.
+  ~WorkStealingPool();
+
+  int getNumThreads() const;
+  void submit(Task);
+  // Blocks until all tasks submitted so far, and those they submitted, have
+  // run. Must not be called from a worker.
+  void wait();
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void _work(int workerIndex);
+  bool _pop(int workerIndex, Task &);
+  bool _steal(int workerIndex, Task &);
+
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread> _threads;
+  std::atomic<unsigned> _nextQueue = 0;
+  std::atomic<int> _numQueued = 0;
+  std::mutex _mutex;
+  std::condition_variable _workAvailable;
+  std::condition_variable _allDone;
+  int _numUnfinished = 0;
+  bool _stop = false;
+};
+} // namespace saint
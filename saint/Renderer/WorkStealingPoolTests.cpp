@@ -0,0 +1,88 @@
+#include "WorkStealingPool.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace saint {
+
+using namespace ::testing;
+
+TEST(WorkStealingPool, runs_every_task_once) {
+  WorkStealingPool sut{4};
+  constexpr auto numTasks = 1000;
+  std::vector<std::atomic<int>> counts(numTasks);
+  for (auto i = 0; i < numTasks; ++i) {
+    sut.submit([&counts, i] { ++counts[i]; });
+  }
+  sut.wait();
+  for (auto i = 0; i < numTasks; ++i) {
+    ASSERT_THAT(counts[i].load(), Eq(1));
+  }
+}
+
+TEST(WorkStealingPool, waits_for_tasks_submitted_by_tasks) {
+  WorkStealingPool sut{3};
+  std::atomic<int> count = 0;
+  for (auto i = 0; i < 10; ++i) {
+    sut.submit([&] {
+      for (auto j = 0; j < 10; ++j) {
+        sut.submit([&] { ++count; });
+      }
+    });
+  }
+  sut.wait();
+  EXPECT_THAT(count.load(), Eq(100));
+}
+
+TEST(WorkStealingPool, waits_for_a_task_whose_child_finished_first) {
+  WorkStealingPool sut{4};
+  for (auto i = 0; i < 1000; ++i) {
+    std::atomic<bool> parentDone = false;
+    sut.submit([&] {
+      sut.submit([] {});
+      std::this_thread::yield();
+      parentDone = true;
+    });
+    sut.wait();
+    ASSERT_TRUE(parentDone.load()) << i;
+  }
+}
+
+TEST(WorkStealingPool, idle_workers_steal_from_busy_ones) {
+  WorkStealingPool sut{4};
+  std::mutex mutex;
+  std::set<std::thread::id> threadIds;
+  // All children go to the queue of the worker running the parent, which
+  // then is kept busy: only stealing can get them run elsewhere.
+  sut.submit([&] {
+    for (auto i = 0; i < 40; ++i) {
+      sut.submit([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        std::lock_guard<std::mutex> lock{mutex};
+        threadIds.insert(std::this_thread::get_id());
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  });
+  sut.wait();
+  EXPECT_THAT(threadIds.size(), Gt(1u));
+}
+
+TEST(WorkStealingPool, runs_queued_tasks_before_destruction) {
+  std::atomic<int> count = 0;
+  {
+    WorkStealingPool sut{2};
+    for (auto i = 0; i < 100; ++i) {
+      sut.submit([&] { ++count; });
+    }
+  }
+  EXPECT_THAT(count.load(), Eq(100));
+}
+
+} // namespace saint
@@ -0,0 +1,189 @@
+#include "BatchRenderer.h"
+#include "Renderer.h"
+#include "Tracing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " --input <in.wav> --midi <file.mid> --played <track index>"
+               " --harmony <track index> --output <out.wav>"
+               " [--block-size <samples>] [--realtime] [--trace <file.json>]\n"
+            << "       " << program
+            << " --batch <jobs file> [--threads <count>]"
+               " [--block-size <samples>] [--realtime] [--trace <file.json>]\n"
+               "  --realtime  render with the live shifter settings rather "
+               "than the offline ones.\n"
+               "  --batch     render concurrently the jobs listed in the file,"
+               " one per line as\n"
+               "              <in.wav> <file.mid> <played> <harmony> "
+               "<out.wav>\n"
+               "  --trace     write the trace zones to a Chrome trace file "
+               "(builds with\n"
+               "              SAINT_TRACING only).\n";
+}
+
+// Returns false only if a trace was asked for and could not be written.
+bool dumpTrace(const std::string &traceFile) {
+  if (traceFile.empty()) {
+    return true;
+  }
+  if (!saint::tracing::dumpChromeTrace(traceFile)) {
+    std::cerr << "error: could not write " << traceFile
+              << " (is tracing compiled in ?)\n";
+    return false;
+  }
+  return true;
+}
+
+// Lines that are empty or start with '#' are skipped.
+bool readJobs(const std::string &path, const saint::RenderConfig &defaults,
+              std::vector<saint::RenderConfig> &jobs) {
+  std::ifstream file{path};
+  if (!file) {
+    std::cerr << "error: could not read " << path << "\n";
+    return false;
+  }
+  std::string line;
+  auto lineNumber = 0;
+  while (std::getline(file, line)) {
+    ++lineNumber;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream stream{line};
+    std::string input, midi, output;
+    auto job = defaults;
+    if (!(stream >> input >> midi >> job.playedTrack >> job.harmonyTrack >>
+          output)) {
+      std::cerr << "error: " << path << ":" << lineNumber
+                << ": expected <in.wav> <file.mid> <played> <harmony> "
+                   "<out.wav>\n";
+      return false;
+    }
+    job.inputWav = input;
+    job.midiFile = midi;
+    job.outputWav = output;
+    jobs.push_back(std::move(job));
+  }
+  return true;
+}
+
+int runBatch(const std::string &jobsFile, const saint::RenderConfig &defaults,
+             int numThreads) {
+  std::vector<saint::RenderConfig> jobs;
+  if (!readJobs(jobsFile, defaults, jobs)) {
+    return 1;
+  }
+  const auto batch = saint::renderBatch(jobs, numThreads);
+  for (auto i = 0u; i < jobs.size(); ++i) {
+    if (!batch.jobs[i].report) {
+      std::cerr << "error: " << jobs[i].inputWav.string() << ": "
+                << batch.jobs[i].error << "\n";
+    }
+  }
+  std::printf("%d jobs (%d failed), %d MIDI files, %d threads\n",
+              static_cast<int>(jobs.size()), batch.getNumFailedJobs(),
+              batch.numScoresLoaded, batch.numThreads);
+  std::printf("%.2f s of audio in %.2f s: %.1f audio-seconds per second\n",
+              batch.audioSeconds, batch.wallSeconds, batch.getThroughput());
+  return batch.getNumFailedJobs() == 0 ? 0 : 1;
+}
+
+void printTiming(const char *name, double seconds, double total) {
+  std::printf("  %-16s %9.3f s %6.1f %%\n", name, seconds,
+              total > 0. ? 100. * seconds / total : 0.);
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  saint::RenderConfig config;
+  auto hasPlayedTrack = false;
+  auto hasHarmonyTrack = false;
+  std::string jobsFile;
+  std::string traceFile;
+  auto numThreads = 0;
+  for (auto i = 1; i < argc; ++i) {
+    const std::string arg{argv[i]};
+    const auto hasValue = i + 1 < argc;
+    if (arg == "--realtime") {
+      config.processingMode = DavidCNAntonia::ProcessingMode::realtime;
+    } else if (!hasValue) {
+      printUsage(argv[0]);
+      return 1;
+    } else if (arg == "--input") {
+      config.inputWav = argv[++i];
+    } else if (arg == "--midi") {
+      config.midiFile = argv[++i];
+    } else if (arg == "--output") {
+      config.outputWav = argv[++i];
+    } else if (arg == "--played") {
+      config.playedTrack = std::atoi(argv[++i]);
+      hasPlayedTrack = true;
+    } else if (arg == "--harmony") {
+      config.harmonyTrack = std::atoi(argv[++i]);
+      hasHarmonyTrack = true;
+    } else if (arg == "--block-size") {
+      config.blockSize = std::atoi(argv[++i]);
+    } else if (arg == "--batch") {
+      jobsFile = argv[++i];
+    } else if (arg == "--threads") {
+      numThreads = std::atoi(argv[++i]);
+    } else if (arg == "--trace") {
+      traceFile = argv[++i];
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (!jobsFile.empty()) {
+    if (config.blockSize <= 0) {
+      printUsage(argv[0]);
+      return 1;
+    }
+    const auto result = runBatch(jobsFile, config, numThreads);
+    return dumpTrace(traceFile) ? result : 1;
+  }
+  if (config.inputWav.empty() || config.midiFile.empty() ||
+      config.outputWav.empty() || !hasPlayedTrack || !hasHarmonyTrack ||
+      config.blockSize <= 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  std::string error;
+  const auto report = saint::render(config, error);
+  if (!report) {
+    std::cerr << "error: " << error << "\n";
+    return 1;
+  }
+  if (!dumpTrace(traceFile)) {
+    return 1;
+  }
+  const auto &stages = report->stages;
+  std::printf("%.2f s of audio at %d Hz, block size %d\n", report->audioSeconds,
+              report->sampleRate, config.blockSize);
+  std::printf("real-time factor: %.1fx\n", report->getRealTimeFactor());
+  std::printf("timing:\n");
+  const auto total = report->loadSeconds + report->prepareSeconds +
+                     report->processSeconds + report->writeSeconds;
+  printTiming("load", report->loadSeconds, total);
+  printTiming("prepare", report->prepareSeconds, total);
+  printTiming("process", report->processSeconds, total);
+  printTiming("write", report->writeSeconds, total);
+  std::printf("process breakdown:\n");
+  printTiming("pitch detection", stages.pitchDetection, stages.total);
+  printTiming("interval lookup", stages.intervalLookup, stages.total);
+  printTiming("pitch shifting", stages.pitchShifting, stages.total);
+  printTiming("other", stages.total - stages.pitchDetection -
+                           stages.intervalLookup - stages.pitchShifting,
+              stages.total);
+  return 0;
+}
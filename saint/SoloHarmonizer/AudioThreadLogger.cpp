@@ -0,0 +1,236 @@
+#include "AudioThreadLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace saint {
+
+namespace {
+// Latency of the log output, not of the audio.
+constexpr std::chrono::milliseconds pollPeriod{10};
+
+// Replaces `{0}`, `{1}`, ... or `{}` placeholders with the arguments.
+std::string format(const char *format, const std::string *args, int numArgs) {
+  std::string result;
+  auto nextArg = 0;
+  for (auto p = format; *p != '\0'; ++p) {
+    if (*p != '{') {
+      result += *p;
+      continue;
+    }
+    auto q = p + 1;
+    auto index = 0;
+    auto hasIndex = false;
+    while (*q >= '0' && *q <= '9') {
+      index = 10 * index + (*q - '0');
+      hasIndex = true;
+      ++q;
+    }
+    if (*q != '}') {
+      result += *p;
+      continue;
+    }
+    if (!hasIndex) {
+      index = nextArg++;
+    }
+    if (index < numArgs) {
+      result += args[index];
+    }
+    p = q;
+  }
+  return result;
+}
+} // namespace
+
+AudioThreadLogger::Arg::Arg(int value)
+    : _type(Type::integer), _integer(value) {}
+
+AudioThreadLogger::Arg::Arg(unsigned value)
+    : _type(Type::unsignedInteger), _unsignedInteger(value) {}
+
+AudioThreadLogger::Arg::Arg(long value)
+    : _type(Type::integer), _integer(value) {}
+
+AudioThreadLogger::Arg::Arg(unsigned long value)
+    : _type(Type::unsignedInteger), _unsignedInteger(value) {}
+
+AudioThreadLogger::Arg::Arg(long long value)
+    : _type(Type::integer), _integer(value) {}
+
+AudioThreadLogger::Arg::Arg(unsigned long long value)
+    : _type(Type::unsignedInteger), _unsignedInteger(value) {}
+
+AudioThreadLogger::Arg::Arg(float value) : _type(Type::real), _real(value) {}
+
+AudioThreadLogger::Arg::Arg(double value) : _type(Type::real), _real(value) {}
+
+AudioThreadLogger::Arg::Arg(bool value)
+    : _type(Type::boolean), _boolean(value) {}
+
+AudioThreadLogger::Arg::Arg(const char *value)
+    : _type(Type::text), _text(value) {}
+
+AudioThreadLogger::Arg::Arg(const std::optional<float> &value)
+    : Arg(value.has_value() ? Arg{*value} : Arg{"nullopt"}) {}
+
+AudioThreadLogger::Arg::Arg(const std::optional<int> &value)
+    : Arg(value.has_value() ? Arg{*value} : Arg{"nullopt"}) {}
+
+std::string AudioThreadLogger::Arg::toString() const {
+  switch (_type) {
+  case Type::integer:
+    return std::to_string(_integer);
+  case Type::unsignedInteger:
+    return std::to_string(_unsignedInteger);
+  case Type::real:
+    return std::to_string(_real);
+  case Type::boolean:
+    return _boolean ? "true" : "false";
+  case Type::text:
+    return _text;
+  case Type::none:
+  default:
+    return "";
+  }
+}
+
+// Drains the rings of all instances from one thread, rather than each
+// instance waking its own up. The thread is started once a registered
+// instance is enabled, waits without timeout while none is, and stops with the
+// last instance.
+class AudioThreadLogger::Drainer {
+public:
+  static Drainer &getInstance() {
+    static Drainer instance;
+    return instance;
+  }
+
+  ~Drainer() {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _stop(lock);
+  }
+
+  void add(AudioThreadLogger &logger) {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _loggers.push_back(&logger);
+    _wake();
+  }
+
+  // Once this returns, the background thread doesn't use `logger` anymore.
+  void remove(AudioThreadLogger &logger) {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _loggers.erase(std::remove(_loggers.begin(), _loggers.end(), &logger),
+                   _loggers.end());
+    if (_loggers.empty()) {
+      _stop(lock);
+    }
+  }
+
+  void onLevelChanged() {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _wake();
+  }
+
+private:
+  bool _isAnyEnabled() const {
+    return std::any_of(_loggers.begin(), _loggers.end(), [](auto logger) {
+      return logger->_logger->level() != spdlog::level::off;
+    });
+  }
+
+  void _wake() {
+    if (!_isAnyEnabled()) {
+      return;
+    }
+    if (_thread.joinable()) {
+      _cv.notify_one();
+    } else {
+      _thread = std::thread([this, generation = _generation] {
+        _run(generation);
+      });
+    }
+  }
+
+  void _stop(std::unique_lock<std::mutex> &lock) {
+    if (!_thread.joinable()) {
+      return;
+    }
+    // A thread started after this one was told to stop has the next
+    // generation, and isn't affected.
+    ++_generation;
+    _cv.notify_one();
+    auto thread = std::move(_thread);
+    lock.unlock();
+    thread.join();
+    lock.lock();
+  }
+
+  void _run(std::uint64_t generation) {
+    std::unique_lock<std::mutex> lock{_mutex};
+    while (generation == _generation) {
+      if (!_isAnyEnabled()) {
+        _cv.wait(lock);
+        continue;
+      }
+      // With the lock held, for `remove` to wait for the logger it removes
+      // to be drained.
+      for (auto logger : _loggers) {
+        logger->_drain();
+      }
+      _cv.wait_for(lock, pollPeriod);
+    }
+  }
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::vector<AudioThreadLogger *> _loggers;
+  std::uint64_t _generation = 0;
+  std::thread _thread;
+};
+
+AudioThreadLogger::AudioThreadLogger(std::shared_ptr<spdlog::logger> logger)
+    : _logger(std::move(logger)) {
+  Drainer::getInstance().add(*this);
+}
+
+AudioThreadLogger::~AudioThreadLogger() {
+  Drainer::getInstance().remove(*this);
+  _drain();
+}
+
+void AudioThreadLogger::setLevel(spdlog::level::level_enum level) {
+  _logger->set_level(level);
+  Drainer::getInstance().onLevelChanged();
+}
+
+void AudioThreadLogger::flush() {
+  _drain();
+  _logger->flush();
+}
+
+std::uint64_t AudioThreadLogger::getNumDropped() const { return _numDropped; }
+
+void AudioThreadLogger::_drain() {
+  // `flush` may be called concurrently with the background thread, but the
+  // ring only supports one consumer at a time.
+  std::lock_guard<std::mutex> lock{_drainMutex};
+  Record record;
+  std::array<std::string, maxArgs> args;
+  while (_ring.remove(record)) {
+    for (auto i = 0; i < record.numArgs; ++i) {
+      args[i] = record.args[i].toString();
+    }
+    _logger->log(record.level, format(record.format, args.data(),
+                                      record.numArgs));
+  }
+  const auto numDropped = _numDropped.load();
+  if (numDropped != _numDroppedReported) {
+    _logger->warn("{0} audio thread log records dropped",
+                  numDropped - _numDroppedReported);
+    _numDroppedReported = numDropped;
+  }
+}
+} // namespace saint
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <ringbuffer.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace saint {
+// Logging front end for the audio thread. `log` and friends only push a
+// fixed-size record into a wait-free single-producer single-consumer ring ;
+// a background thread, shared by all instances, formats the records and hands
+// them to the spdlog logger. That thread only runs while some instance's
+// logger is enabled. Records that don't fit in the ring are dropped and
+// counted, the count being logged as soon as there is room again.
+// Only one thread may log at a time. Format strings and string arguments are
+// stored as pointers: they must outlive the logger, i.e., be literals.
+class AudioThreadLogger {
+public:
+  class Arg {
+  public:
+    Arg() = default;
+    Arg(int);
+    Arg(unsigned);
+    Arg(long);
+    Arg(unsigned long);
+    Arg(long long);
+    Arg(unsigned long long);
+    Arg(float);
+    Arg(double);
+    Arg(bool);
+    Arg(const char *);
+    Arg(const std::optional<float> &);
+    Arg(const std::optional<int> &);
+    std::string toString() const;
+
+  private:
+    enum class Type { none, integer, unsignedInteger, real, boolean, text };
+    Type _type = Type::none;
+    union {
+      long long _integer = 0;
+      unsigned long long _unsignedInteger;
+      double _real;
+      bool _boolean;
+      const char *_text;
+    };
+  };
+
+  static constexpr auto maxArgs = 4;
+  static constexpr auto capacity = 1024;
+
+  AudioThreadLogger(std::shared_ptr<spdlog::logger>);
+  // Writes what's still in the ring.
+  ~AudioThreadLogger();
+
+  template <typename... Args>
+  void log(spdlog::level::level_enum level, const char *format,
+           const Args &...args) {
+    static_assert(sizeof...(Args) <= maxArgs, "too many arguments");
+    if (!_logger->should_log(level)) {
+      return;
+    }
+    Record record{level, format, sizeof...(Args), {Arg{args}...}};
+    if (!_ring.insert(record)) {
+      ++_numDropped;
+    }
+  }
+
+  template <typename... Args>
+  void trace(const char *format, const Args &...args) {
+    log(spdlog::level::trace, format, args...);
+  }
+
+  template <typename... Args>
+  void debug(const char *format, const Args &...args) {
+    log(spdlog::level::debug, format, args...);
+  }
+
+  template <typename... Args>
+  void info(const char *format, const Args &...args) {
+    log(spdlog::level::info, format, args...);
+  }
+
+  // Sets the spdlog logger's level. Enabling it that way rather than directly
+  // on the spdlog logger wakes the background thread up. Not for the audio
+  // thread.
+  void setLevel(spdlog::level::level_enum);
+  // Blocks until all records logged so far are written. Not for the audio
+  // thread.
+  void flush();
+  std::uint64_t getNumDropped() const;
+
+private:
+  struct Record {
+    spdlog::level::level_enum level = spdlog::level::off;
+    const char *format = "";
+    int numArgs = 0;
+    std::array<Arg, maxArgs> args;
+  };
+
+  class Drainer;
+
+  void _drain();
+
+  const std::shared_ptr<spdlog::logger> _logger;
+  jnk0le::Ringbuffer<Record, capacity> _ring;
+  std::atomic<std::uint64_t> _numDropped = 0;
+  std::uint64_t _numDroppedReported = 0;
+  std::mutex _drainMutex;
+};
+} // namespace saint
@@ -0,0 +1,145 @@
+#include "AudioThreadLogger.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+class TestSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+  std::vector<std::string> getMessages() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return _messages;
+  }
+  std::function<void()> onWrite;
+
+protected:
+  void sink_it_(const spdlog::details::log_msg &msg) override {
+    if (onWrite) {
+      onWrite();
+    }
+    _messages.emplace_back(msg.payload.begin(), msg.payload.end());
+  }
+  void flush_() override {}
+
+private:
+  std::vector<std::string> _messages;
+};
+
+struct AudioThreadLoggerTest : Test {
+  AudioThreadLoggerTest()
+      : sink(std::make_shared<TestSink>()),
+        logger(std::make_shared<spdlog::logger>("AudioThreadLoggerTest", sink)) {
+    logger->set_level(spdlog::level::debug);
+  }
+  const std::shared_ptr<TestSink> sink;
+  const std::shared_ptr<spdlog::logger> logger;
+};
+
+// Without flushing, i.e. as written by the background thread.
+bool waitForMessages(TestSink &sink, size_t numMessages) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{5};
+  while (sink.getMessages().size() < numMessages) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  return true;
+}
+} // namespace
+
+TEST_F(AudioThreadLoggerTest, formats_arguments) {
+  AudioThreadLogger sut{logger};
+  sut.info("no argument");
+  sut.info("{0} -> {1} ({2})", 1, 2, 0.5f);
+  sut.debug("{} and {}", "this", true);
+  sut.debug("returned {0}", std::optional<float>{});
+  sut.flush();
+  EXPECT_THAT(sink->getMessages(),
+              ElementsAre("no argument", "1 -> 2 (0.500000)", "this and true",
+                          "returned nullopt"));
+}
+
+TEST_F(AudioThreadLoggerTest, formats_integers_of_any_width) {
+  AudioThreadLogger sut{logger};
+  sut.info("{0} {1} {2}", std::int64_t{-3}, std::size_t{4}, 5u);
+  sut.flush();
+  EXPECT_THAT(sink->getMessages(), ElementsAre("-3 4 5"));
+}
+
+TEST_F(AudioThreadLoggerTest, filters_by_level) {
+  AudioThreadLogger sut{logger};
+  sut.trace("not logged");
+  sut.debug("logged");
+  sut.flush();
+  EXPECT_THAT(sink->getMessages(), ElementsAre("logged"));
+}
+
+TEST_F(AudioThreadLoggerTest, drops_and_counts_records_when_full) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  auto writing = false;
+  auto release = false;
+  sink->onWrite = [&] {
+    std::unique_lock<std::mutex> lock{mutex};
+    writing = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return release; });
+  };
+  AudioThreadLogger sut{logger};
+  sut.info("blocks the background thread");
+  {
+    std::unique_lock<std::mutex> lock{mutex};
+    cv.wait(lock, [&] { return writing; });
+  }
+  constexpr auto numOverflowing = 10;
+  for (auto i = 0; i < AudioThreadLogger::capacity + numOverflowing; ++i) {
+    sut.info("record {0}", i);
+  }
+  EXPECT_THAT(sut.getNumDropped(), Ge(static_cast<unsigned>(numOverflowing)));
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    release = true;
+  }
+  cv.notify_all();
+  sut.flush();
+  const auto messages = sink->getMessages();
+  ASSERT_THAT(messages, Not(IsEmpty()));
+  EXPECT_THAT(messages.back(), HasSubstr("audio thread log records dropped"));
+}
+
+TEST_F(AudioThreadLoggerTest, all_instances_are_drained_in_the_background) {
+  const auto otherSink = std::make_shared<TestSink>();
+  const auto otherLogger = std::make_shared<spdlog::logger>(
+      "AudioThreadLoggerTest_other", otherSink);
+  AudioThreadLogger sut{logger};
+  AudioThreadLogger other{otherLogger};
+  sut.info("one");
+  other.info("other");
+  EXPECT_TRUE(waitForMessages(*sink, 1));
+  EXPECT_TRUE(waitForMessages(*otherSink, 1));
+}
+
+TEST_F(AudioThreadLoggerTest, is_drained_in_the_background_once_enabled) {
+  logger->set_level(spdlog::level::off);
+  AudioThreadLogger sut{logger};
+  sut.setLevel(spdlog::level::info);
+  sut.info("enabled");
+  EXPECT_TRUE(waitForMessages(*sink, 1));
+}
+} // namespace saint
@@ -0,0 +1,27 @@
+#include "DelayLine.h"
+
+#include <algorithm>
+
+namespace saint {
+DelayLine::DelayLine(int delay) : _buffer(delay, 0.f) {}
+
+void DelayLine::process(const float *in, float *out, int numSamples) {
+  const auto delay = static_cast<int>(_buffer.size());
+  if (delay == 0) {
+    std::copy(in, in + numSamples, out);
+    return;
+  }
+  for (auto i = 0; i < numSamples; ++i) {
+    out[i] = _buffer[_index];
+    _buffer[_index] = in[i];
+    if (++_index == delay) {
+      _index = 0;
+    }
+  }
+}
+
+void DelayLine::clear() {
+  std::fill(_buffer.begin(), _buffer.end(), 0.f);
+  _index = 0;
+}
+} // namespace saint
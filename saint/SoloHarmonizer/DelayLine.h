@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+namespace saint {
+class DelayLine {
+public:
+  explicit DelayLine(int delay);
+  // `in` and `out` may not overlap.
+  void process(const float *in, float *out, int numSamples);
+  // Back to silence, without allocating.
+  void clear();
+
+private:
+  std::vector<float> _buffer;
+  int _index = 0;
+};
+} // namespace saint
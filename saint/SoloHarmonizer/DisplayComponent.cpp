@@ -1,10 +1,12 @@
 #include "DisplayComponent.h"
 #include "CommonTypes.h"
 #include "DisplayComponentHelper.h"
+#include "Tracing.h"
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <limits>
-#include <xlocale>
 
 namespace saint {
 DisplayComponent::DisplayComponent(const juce::Colour &backgroundColour)
@@ -80,6 +82,7 @@ float DisplayComponent::_getNoteY(int noteNumber) const {
 }
 
 void DisplayComponent::paint(juce::Graphics &g) {
+  SAINT_TRACE_ZONE("DisplayComponent::paint");
   g.fillAll(_backgroundColour);
   g.setColour(juce::Colours::whitesmoke);
   g.drawLine(_width / 2, 0, _width / 2, _height);
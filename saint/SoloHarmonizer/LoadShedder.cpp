@@ -0,0 +1,31 @@
+#include "LoadShedder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace saint {
+LoadShedder::LoadShedder(Config config) : _config(std::move(config)) {}
+
+void LoadShedder::reset() {
+  _level = 0;
+  _smoothedLoad = 0.f;
+  _secondsAtLevel = 0.f;
+}
+
+int LoadShedder::update(float load, float blockSeconds) {
+  const auto alpha = 1.f - std::exp(-blockSeconds / _config.smoothingSeconds);
+  _smoothedLoad += alpha * (load - _smoothedLoad);
+  _secondsAtLevel += blockSeconds;
+  const auto maxLevel = std::max(_config.numLevels - 1, 0);
+  if (_smoothedLoad > _config.highLoad && _level < maxLevel &&
+      _secondsAtLevel >= _config.stepDownHoldSeconds) {
+    ++_level;
+    _secondsAtLevel = 0.f;
+  } else if (_smoothedLoad < _config.lowLoad && _level > 0 &&
+             _secondsAtLevel >= _config.stepUpHoldSeconds) {
+    --_level;
+    _secondsAtLevel = 0.f;
+  }
+  return _level;
+}
+} // namespace saint
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace saint {
+// Smoothes the ratio of processing time over block duration and tells, with
+// hysteresis, how many steps down the quality ladder the caller should be.
+// 0 is full quality ; the meaning of the other levels is the caller's.
+class LoadShedder {
+public:
+  struct Config {
+    int numLevels = 1;
+    // Step down when the smoothed load exceeds this ...
+    float highLoad = 0.6f;
+    // ... and up again when it falls below that.
+    float lowLoad = 0.3f;
+    float smoothingSeconds = 0.5f;
+    // Minimal time spent at a level before stepping down, respectively up.
+    // Stepping up is more cautious, not to oscillate.
+    float stepDownHoldSeconds = 0.5f;
+    float stepUpHoldSeconds = 3.f;
+  };
+
+  explicit LoadShedder(Config);
+
+  // `load` is processing time divided by `blockSeconds`.
+  // Returns the new level.
+  int update(float load, float blockSeconds);
+  // Back to full quality, forgetting the load so far.
+  void reset();
+  int getLevel() const { return _level; }
+  float getSmoothedLoad() const { return _smoothedLoad; }
+
+private:
+  const Config _config;
+  int _level = 0;
+  float _smoothedLoad = 0.f;
+  float _secondsAtLevel = 0.f;
+};
+} // namespace saint
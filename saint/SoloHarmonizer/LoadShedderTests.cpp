@@ -0,0 +1,75 @@
+#include "LoadShedder.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+constexpr auto blockSeconds = 0.01f;
+
+LoadShedder::Config getConfig() {
+  LoadShedder::Config config;
+  config.numLevels = 3;
+  return config;
+}
+
+int runFor(LoadShedder &sut, float load, float seconds) {
+  for (auto t = 0.f; t < seconds; t += blockSeconds) {
+    sut.update(load, blockSeconds);
+  }
+  return sut.getLevel();
+}
+} // namespace
+
+TEST(LoadShedder, ignores_load_spikes) {
+  LoadShedder sut{getConfig()};
+  runFor(sut, 0.1f, 1.f);
+  EXPECT_THAT(sut.update(5.f, blockSeconds), Eq(0));
+  EXPECT_THAT(runFor(sut, 0.1f, 1.f), Eq(0));
+}
+
+TEST(LoadShedder, steps_down_one_level_at_a_time_under_sustained_load) {
+  LoadShedder sut{getConfig()};
+  EXPECT_THAT(runFor(sut, 0.9f, 1.f), Eq(1));
+  EXPECT_THAT(runFor(sut, 0.9f, 0.5f), Eq(2));
+  // Can't go any lower.
+  EXPECT_THAT(runFor(sut, 0.9f, 10.f), Eq(2));
+}
+
+TEST(LoadShedder, steps_back_up_cautiously) {
+  LoadShedder sut{getConfig()};
+  runFor(sut, 0.9f, 2.f);
+  ASSERT_THAT(sut.getLevel(), Eq(2));
+  EXPECT_THAT(runFor(sut, 0.1f, 2.f), Eq(2));
+  EXPECT_THAT(runFor(sut, 0.1f, 2.f), Eq(1));
+  EXPECT_THAT(runFor(sut, 0.1f, 3.f), Eq(0));
+}
+
+TEST(LoadShedder, holds_full_quality_between_thresholds) {
+  LoadShedder sut{getConfig()};
+  EXPECT_THAT(runFor(sut, 0.45f, 10.f), Eq(0));
+}
+
+TEST(LoadShedder, holds_lower_level_between_thresholds) {
+  LoadShedder sut{getConfig()};
+  runFor(sut, 0.9f, 0.7f);
+  ASSERT_THAT(sut.getLevel(), Eq(1));
+  // Let the smoothed load settle below the high threshold ...
+  runFor(sut, 0.2f, 0.3f);
+  // ... and stay in between.
+  EXPECT_THAT(runFor(sut, 0.45f, 10.f), Eq(1));
+}
+
+TEST(LoadShedder, starts_over_at_full_quality_after_a_reset) {
+  LoadShedder sut{getConfig()};
+  runFor(sut, 0.9f, 1.f);
+  ASSERT_THAT(sut.getLevel(), Eq(1));
+  sut.reset();
+  EXPECT_THAT(sut.getLevel(), Eq(0));
+  EXPECT_THAT(sut.update(0.45f, blockSeconds), Eq(0));
+}
+
+} // namespace saint
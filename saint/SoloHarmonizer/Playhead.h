@@ -5,10 +5,35 @@
 namespace saint {
 class Playhead {
 public:
+  // Where, within a block, the time jumps rather than goes on, e.g. back to
+  // the beginning of a loop.
+  struct Jump {
+    int numSamplesBefore = 0;
+    float timeInCrotchetsAfter = 0.f;
+  };
+
   // Should return new time in crotchets
   virtual std::optional<float> incrementSampleCount(int) = 0;
   virtual void mixMetronome(float *, int) {}
   virtual std::optional<float> getTimeInCrotchets() = 0;
+  // `sampleOffset` samples into the block about to be processed, i.e. after
+  // the time `getTimeInCrotchets()` returned last, at the playhead's tempo.
+  // For parts of large blocks to be timed as the playhead would have.
+  virtual std::optional<float> getTimeInCrotchetsAt(int sampleOffset) = 0;
+  // The first among samples `fromSample` to `fromSample + numSamples` of the
+  // block about to be processed, if any. A jump on the block's first sample
+  // is also in `getTimeInCrotchets()`, and one right after the block is seen
+  // in the next block's time.
+  virtual std::optional<Jump> getJump(int /*fromSample*/,
+                                      int /*numSamples*/) {
+    return std::nullopt;
+  }
+  // Loops between the two times from now on, or stops looping if `end` isn't
+  // after `begin`. Returns false if the playhead doesn't loop, e.g. because
+  // it follows the host's time, in which case it's up to the caller.
+  virtual bool setLoop(float /*beginCrotchet*/, float /*endCrotchet*/) {
+    return false;
+  }
   virtual ~Playhead() = default;
 };
-} // namespace saint
\ No newline at end of file
+} // namespace saint
@@ -4,14 +4,18 @@
 
 namespace saint {
 HostDrivenPlayhead::HostDrivenPlayhead(
-    const JuceAudioPlayHeadProvider &playheadProvider)
-    : _playheadProvider(playheadProvider) {}
+    const JuceAudioPlayHeadProvider &playheadProvider, int samplesPerSecond)
+    : _playheadProvider(playheadProvider),
+      _samplesPerSecond(samplesPerSecond) {}
 
-std::optional<float> HostDrivenPlayhead::incrementSampleCount(int) {
-  return getTimeInCrotchets();
+std::optional<float> HostDrivenPlayhead::incrementSampleCount(int numSamples) {
+  _numSamplesSinceQuery += numSamples;
+  return getTimeInCrotchetsAt(_numSamplesSinceQuery);
 }
 
 std::optional<float> HostDrivenPlayhead::getTimeInCrotchets() {
+  _snapshot.reset();
+  _numSamplesSinceQuery = 0;
   const juce::AudioPlayHead *playhead =
       _playheadProvider.getJuceAudioPlayHead();
   if (!playhead) {
@@ -19,7 +23,8 @@ std::optional<float> HostDrivenPlayhead::getTimeInCrotchets() {
     return std::nullopt;
   }
   const auto position = playhead->getPosition();
-  if (!position) {
+  if (!position || !position->getIsPlaying()) {
+    // Same as a standalone playhead that was stopped: there is no time.
     return std::nullopt;
   }
   const auto ppq = position->getPpqPosition();
@@ -27,7 +32,21 @@ std::optional<float> HostDrivenPlayhead::getTimeInCrotchets() {
     // TODO log
     return std::nullopt;
   }
-  return *ppq;
+  const auto bpm = position->getBpm();
+  // Without a tempo, the time stands still until the next query.
+  const auto crotchetsPerSample =
+      bpm && *bpm > 0. ? *bpm / 60. / _samplesPerSecond : 0.;
+  _snapshot = Snapshot{*ppq, crotchetsPerSample};
+  return getTimeInCrotchetsAt(0);
 }
 
-} // namespace saint
\ No newline at end of file
+std::optional<float>
+HostDrivenPlayhead::getTimeInCrotchetsAt(int sampleOffset) {
+  if (!_snapshot.has_value()) {
+    return std::nullopt;
+  }
+  return static_cast<float>(_snapshot->ppq +
+                            sampleOffset * _snapshot->crotchetsPerSample);
+}
+
+} // namespace saint
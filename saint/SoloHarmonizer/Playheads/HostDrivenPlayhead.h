@@ -6,12 +6,30 @@
 namespace saint {
 class HostDrivenPlayhead : public Playhead {
 public:
-  HostDrivenPlayhead(const JuceAudioPlayHeadProvider &);
+  HostDrivenPlayhead(const JuceAudioPlayHeadProvider &, int samplesPerSecond);
+  // Extrapolates from the last query rather than asking the host again.
   std::optional<float> incrementSampleCount(int) override;
+  // Queries the host, which some make costly: once per block, before
+  // processing it.
   std::optional<float> getTimeInCrotchets() override;
+  // `sampleOffset` samples into the block of the last query, at the tempo the
+  // host then gave.
+  std::optional<float> getTimeInCrotchetsAt(int sampleOffset) override;
 
 private:
+  // What the host said at the start of the block, if it was playing.
+  struct Snapshot {
+    double ppq = 0.;
+    // 0 if the host didn't tell its tempo.
+    double crotchetsPerSample = 0.;
+  };
+
   const JuceAudioPlayHeadProvider &_playheadProvider;
+  const double _samplesPerSecond;
+  // Only ever touched by the audio thread ; other threads get the time
+  // published by the processor.
+  std::optional<Snapshot> _snapshot;
+  int _numSamplesSinceQuery = 0;
 };
 
 } // namespace saint
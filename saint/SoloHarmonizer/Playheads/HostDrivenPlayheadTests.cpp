@@ -0,0 +1,67 @@
+#include "HostDrivenPlayhead.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+constexpr auto samplesPerSecond = 48000;
+
+class FakeAudioPlayHead : public juce::AudioPlayHead {
+public:
+  juce::Optional<PositionInfo> getPosition() const override {
+    ++numQueries;
+    return position;
+  }
+  PositionInfo position;
+  mutable int numQueries = 0;
+};
+
+class FakeAudioPlayHeadProvider : public JuceAudioPlayHeadProvider {
+public:
+  juce::AudioPlayHead *getJuceAudioPlayHead() const override {
+    return &playhead;
+  }
+  mutable FakeAudioPlayHead playhead;
+};
+} // namespace
+
+TEST(HostDrivenPlayhead, queries_the_host_once_per_block_and_extrapolates) {
+  FakeAudioPlayHeadProvider provider;
+  auto &position = provider.playhead.position;
+  position.setIsPlaying(true);
+  position.setPpqPosition(10.);
+  position.setBpm(120.);
+  HostDrivenPlayhead sut{provider, samplesPerSecond};
+  EXPECT_THAT(sut.getTimeInCrotchets(), Optional(FloatEq(10.f)));
+  EXPECT_THAT(sut.getTimeInCrotchetsAt(samplesPerSecond / 4),
+              Optional(FloatEq(10.5f)));
+  EXPECT_THAT(sut.incrementSampleCount(samplesPerSecond / 2),
+              Optional(FloatEq(11.f)));
+  EXPECT_THAT(provider.playhead.numQueries, Eq(1));
+  // The host jumped.
+  position.setPpqPosition(3.);
+  EXPECT_THAT(sut.getTimeInCrotchets(), Optional(FloatEq(3.f)));
+  EXPECT_THAT(provider.playhead.numQueries, Eq(2));
+}
+
+TEST(HostDrivenPlayhead, stands_still_without_tempo_and_has_no_time_stopped) {
+  FakeAudioPlayHeadProvider provider;
+  auto &position = provider.playhead.position;
+  position.setIsPlaying(true);
+  position.setPpqPosition(10.);
+  HostDrivenPlayhead sut{provider, samplesPerSecond};
+  EXPECT_THAT(sut.getTimeInCrotchets(), Optional(FloatEq(10.f)));
+  EXPECT_THAT(sut.incrementSampleCount(samplesPerSecond),
+              Optional(FloatEq(10.f)));
+  position.setIsPlaying(false);
+  EXPECT_THAT(sut.getTimeInCrotchets(), Eq(std::nullopt));
+  EXPECT_THAT(sut.incrementSampleCount(samplesPerSecond), Eq(std::nullopt));
+}
+
+} // namespace saint
@@ -1,5 +1,6 @@
 #include "ProcessCallbackDrivenPlayhead.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <optional>
@@ -15,7 +16,7 @@ constexpr auto decayDb = -60.f;
 
 std::array<double, 2> getCoefs(int samplesPerSecond) {
   const auto resonanceRadians = twoPi * resonanceHz / samplesPerSecond;
-  const auto r = std::powf(10.f, decayDb / (decayTime * samplesPerSecond));
+  const auto r = std::pow(10.f, decayDb / (decayTime * samplesPerSecond));
   const auto a1 = -2 * r * std::cos(resonanceRadians);
   const auto a2 = r * r;
   return {a1, a2};
@@ -23,8 +24,10 @@ std::array<double, 2> getCoefs(int samplesPerSecond) {
 } // namespace
 
 ProcessCallbackDrivenPlayhead::ProcessCallbackDrivenPlayhead(
-    int samplesPerSecond, float crotchetsPerSample)
-    : _crotchetsPerSample(crotchetsPerSample), _a(getCoefs(samplesPerSecond)) {}
+    int samplesPerSecond, std::shared_ptr<const TempoMap> tempoMap)
+    : _samplesPerSecond(samplesPerSecond), _tempoMap(std::move(tempoMap)),
+      _cursor(*_tempoMap, samplesPerSecond),
+      _a(getCoefs(samplesPerSecond)) {}
 
 std::optional<float>
 ProcessCallbackDrivenPlayhead::incrementSampleCount(int numSamples) {
@@ -33,11 +36,11 @@ ProcessCallbackDrivenPlayhead::incrementSampleCount(int numSamples) {
 }
 
 void ProcessCallbackDrivenPlayhead::mixMetronome(float *audio, int numSamples) {
-  for (auto i = 0u; i < static_cast<size_t>(numSamples); ++i) {
-    const auto newCrotchetCount = static_cast<int>(
-        _crotchetsPerSample *
-        (_sampleCount + static_cast<decltype(_sampleCount)>(i)));
-    const auto isTick = newCrotchetCount > _crotchetCount;
+  for (auto i = 0; i < numSamples; ++i) {
+    const auto newCrotchetCount =
+        static_cast<int>(_getCrotchet(_sampleCount + i));
+    // Also when looping back.
+    const auto isTick = newCrotchetCount != _crotchetCount;
     _crotchetCount = newCrotchetCount;
     const auto x = isTick ? 1.0 : 0.0;
     const auto y = gainCoef * x - _a[0] * _z[0] - _a[1] * _z[1];
@@ -48,6 +51,62 @@ void ProcessCallbackDrivenPlayhead::mixMetronome(float *audio, int numSamples) {
 }
 
 std::optional<float> ProcessCallbackDrivenPlayhead::getTimeInCrotchets() {
-  return static_cast<float>(_sampleCount) * _crotchetsPerSample;
+  return _getCrotchet(_sampleCount);
+}
+
+std::optional<float>
+ProcessCallbackDrivenPlayhead::getTimeInCrotchetsAt(int sampleOffset) {
+  return _getCrotchet(_sampleCount + sampleOffset);
+}
+
+std::optional<Playhead::Jump>
+ProcessCallbackDrivenPlayhead::getJump(int fromSample, int numSamples) {
+  if (_loopNumSamples == 0) {
+    return std::nullopt;
+  }
+  // The loop wraps on samples whose count is a multiple of its length, but
+  // for the very first one.
+  const auto fromCount = _sampleCount + fromSample;
+  const auto remainder = fromCount % _loopNumSamples;
+  const auto wrapCount = remainder == 0 && fromCount > 0
+                             ? fromCount
+                             : fromCount - remainder + _loopNumSamples;
+  const auto numSamplesBefore = wrapCount - _sampleCount;
+  if (numSamplesBefore >= fromSample + numSamples) {
+    return std::nullopt;
+  }
+  const auto loopBeginSeconds =
+      static_cast<double>(_loopBeginSample) / _samplesPerSecond;
+  return Jump{static_cast<int>(numSamplesBefore),
+              static_cast<float>(_tempoMap->getCrotchet(loopBeginSeconds))};
+}
+
+bool ProcessCallbackDrivenPlayhead::setLoop(float beginCrotchet,
+                                            float endCrotchet) {
+  if (beginCrotchet == _loopBeginCrotchet && endCrotchet == _loopEndCrotchet) {
+    return true;
+  }
+  _loopBeginCrotchet = beginCrotchet;
+  _loopEndCrotchet = endCrotchet;
+  const auto toSample = [this](float crotchet) {
+    return std::llround(_tempoMap->getSeconds(crotchet) * _samplesPerSecond);
+  };
+  _loopBeginSample = toSample(beginCrotchet);
+  _loopNumSamples =
+      endCrotchet > beginCrotchet
+          ? std::max<std::int64_t>(toSample(endCrotchet) - _loopBeginSample, 0)
+          : 0;
+  return true;
+}
+
+std::int64_t
+ProcessCallbackDrivenPlayhead::_getScoreSample(std::int64_t sampleCount) const {
+  return _loopNumSamples == 0
+             ? sampleCount
+             : _loopBeginSample + sampleCount % _loopNumSamples;
+}
+
+float ProcessCallbackDrivenPlayhead::_getCrotchet(std::int64_t sampleCount) {
+  return static_cast<float>(_cursor.getCrotchet(_getScoreSample(sampleCount)));
 }
 } // namespace saint
\ No newline at end of file
@@ -1,24 +1,46 @@
 #pragma once
 
 #include "../Playhead.h"
+#include "TempoMap.h"
 
 #include <ringbuffer.hpp>
 
 #include <array>
+#include <cstdint>
+#include <memory>
 
 namespace saint {
 class ProcessCallbackDrivenPlayhead : public Playhead {
 public:
-  ProcessCallbackDrivenPlayhead(int samplesPerSecond, float crotchetsPerSample);
+  ProcessCallbackDrivenPlayhead(int samplesPerSecond,
+                                std::shared_ptr<const TempoMap>);
   std::optional<float> incrementSampleCount(int numSamples) override;
   void mixMetronome(float *, int) override;
   std::optional<float> getTimeInCrotchets() override;
+  // Loops back as the playhead would, from the tempo map.
+  std::optional<float> getTimeInCrotchetsAt(int sampleOffset) override;
+  std::optional<Jump> getJump(int fromSample, int numSamples) override;
+  // The loop is kept in samples, for it to stay exact however long it plays.
+  bool setLoop(float beginCrotchet, float endCrotchet) override;
 
 private:
-  const float _crotchetsPerSample;
+  // Where in the score the playhead is `sampleCount` samples after it
+  // started, looping or not.
+  std::int64_t _getScoreSample(std::int64_t sampleCount) const;
+  float _getCrotchet(std::int64_t sampleCount);
+
+  const int _samplesPerSecond;
+  // Kept alive for the cursor.
+  const std::shared_ptr<const TempoMap> _tempoMap;
+  TempoMap::Cursor _cursor;
   const std::array<double, 2> _a;
   std::array<double, 2> _z = {0.f, 0.f};
-  long long _sampleCount = 0;
+  std::int64_t _sampleCount = 0;
   int _crotchetCount = -1;
+  float _loopBeginCrotchet = 0.f;
+  float _loopEndCrotchet = 0.f;
+  std::int64_t _loopBeginSample = 0;
+  // 0 if not looping.
+  std::int64_t _loopNumSamples = 0;
 };
 } // namespace saint
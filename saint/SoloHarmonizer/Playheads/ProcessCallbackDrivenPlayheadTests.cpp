@@ -2,24 +2,101 @@
 #include "WavFileWriter.h"
 #include "testUtils.h"
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 namespace saint {
 
+using namespace ::testing;
+
 constexpr auto samplesPerSecond = 44100;
-constexpr auto crotchetsPerSecond = 2;
-constexpr auto crotchetsPerSample =
-    static_cast<float>(crotchetsPerSecond) / samplesPerSecond;
 
 namespace fs = std::filesystem;
 
 TEST(ProcessCallbackDrivenPlayhead, stuff) {
   auto writer = testUtils::WavFileWriter(
       fs::path{testUtils::getOutDir() + "metronome.wav"});
-  ProcessCallbackDrivenPlayhead sut{samplesPerSecond, crotchetsPerSample};
+  ProcessCallbackDrivenPlayhead sut{samplesPerSecond,
+                                    std::make_shared<TempoMap>()};
   std::vector<float> metronome(2 * samplesPerSecond);
   sut.mixMetronome(metronome.data(), 2 * samplesPerSecond);
   writer.write(metronome);
 }
 
+TEST(ProcessCallbackDrivenPlayhead, follows_tempo_changes) {
+  // 120 bpm for 2 crotchets, then 60 bpm.
+  ProcessCallbackDrivenPlayhead sut{
+      samplesPerSecond,
+      std::make_shared<TempoMap>(
+          std::vector<TempoMap::TempoChange>{{0., 2.}, {2., 1.}})};
+  EXPECT_THAT(sut.incrementSampleCount(samplesPerSecond / 2),
+              Optional(FloatEq(1.f)));
+  EXPECT_THAT(sut.incrementSampleCount(samplesPerSecond),
+              Optional(FloatEq(2.5f)));
+  EXPECT_THAT(sut.incrementSampleCount(samplesPerSecond * 60),
+              Optional(FloatEq(62.5f)));
+}
+
+TEST(ProcessCallbackDrivenPlayhead, tells_times_within_the_block) {
+  // 120 bpm for 2 crotchets, then 60 bpm.
+  ProcessCallbackDrivenPlayhead sut{
+      samplesPerSecond,
+      std::make_shared<TempoMap>(
+          std::vector<TempoMap::TempoChange>{{0., 2.}, {2., 1.}})};
+  sut.incrementSampleCount(samplesPerSecond / 2);
+  EXPECT_THAT(sut.getTimeInCrotchetsAt(samplesPerSecond),
+              Optional(FloatEq(2.5f)));
+  // Within the loop.
+  sut.setLoop(0.f, 1.f);
+  EXPECT_THAT(sut.getTimeInCrotchetsAt(samplesPerSecond / 4),
+              Optional(FloatEq(0.5f)));
+  // The block's time is unchanged.
+  EXPECT_THAT(sut.getTimeInCrotchets(), Optional(FloatEq(0.f)));
+}
+
+TEST(ProcessCallbackDrivenPlayhead, loops_sample_accurately_for_hours) {
+  // At 120 bpm, bars 2 and 3 of 4/4 last 2 seconds.
+  ProcessCallbackDrivenPlayhead sut{samplesPerSecond,
+                                    std::make_shared<TempoMap>()};
+  ASSERT_TRUE(sut.setLoop(4.f, 8.f));
+  EXPECT_THAT(sut.getTimeInCrotchets(), Optional(4.f));
+  constexpr auto loopSamples = 2 * samplesPerSecond;
+  EXPECT_THAT(sut.getJump(0, loopSamples), Eq(std::nullopt));
+  const auto jump = sut.getJump(0, loopSamples + 1);
+  ASSERT_TRUE(jump.has_value());
+  EXPECT_THAT(jump->numSamplesBefore, Eq(loopSamples));
+  EXPECT_THAT(jump->timeInCrotchetsAfter, Eq(4.f));
+  EXPECT_THAT(sut.incrementSampleCount(loopSamples - 1),
+              Optional(FloatEq(8.f - 2.f / samplesPerSecond)));
+  EXPECT_THAT(sut.incrementSampleCount(1), Optional(4.f));
+  // Wrapped on the block boundary.
+  const auto boundaryJump = sut.getJump(0, 1);
+  ASSERT_TRUE(boundaryJump.has_value());
+  EXPECT_THAT(boundaryJump->numSamplesBefore, Eq(0));
+  EXPECT_THAT(sut.getJump(1, loopSamples - 1), Eq(std::nullopt));
+  // Ten hours on, to the sample.
+  EXPECT_THAT(sut.incrementSampleCount(36000 * samplesPerSecond),
+              Optional(4.f));
+  sut.setLoop(0.f, 0.f);
+  EXPECT_THAT(sut.getJump(0, loopSamples + 1), Eq(std::nullopt));
+}
+
+TEST(ProcessCallbackDrivenPlayhead, jumps_several_times_in_a_long_block) {
+  // One crotchet at 120 bpm.
+  ProcessCallbackDrivenPlayhead sut{samplesPerSecond,
+                                    std::make_shared<TempoMap>()};
+  sut.setLoop(4.f, 5.f);
+  constexpr auto loopSamples = samplesPerSecond / 2;
+  constexpr auto blockSize = 3 * loopSamples - 1;
+  const auto first = sut.getJump(0, blockSize);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_THAT(first->numSamplesBefore, Eq(loopSamples));
+  const auto second = sut.getJump(loopSamples + 1, blockSize - loopSamples - 1);
+  ASSERT_TRUE(second.has_value());
+  EXPECT_THAT(second->numSamplesBefore, Eq(2 * loopSamples));
+  EXPECT_THAT(second->timeInCrotchetsAfter, Eq(4.f));
+  EXPECT_THAT(sut.getJump(2 * loopSamples + 1, loopSamples - 2),
+              Eq(std::nullopt));
+}
+
 } // namespace saint
@@ -0,0 +1,155 @@
+#include "ProcessingStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace saint {
+namespace {
+constexpr auto microsecondsPerSecond = 1e6;
+constexpr auto loadUnitsPerPercent = 100.;
+
+const char *toString(ProcessingStats::Stage stage) {
+  switch (stage) {
+  case ProcessingStats::Stage::pitchDetection:
+    return "pitch detection";
+  case ProcessingStats::Stage::intervalLookup:
+    return "interval lookup";
+  case ProcessingStats::Stage::pitchShifting:
+    return "pitch shifting";
+  case ProcessingStats::Stage::total:
+  default:
+    return "total";
+  }
+}
+
+ProcessingStats::Distribution scaled(ProcessingStats::Distribution d,
+                                     double factor) {
+  d.p50 = static_cast<float>(d.p50 * factor);
+  d.p99 = static_cast<float>(d.p99 * factor);
+  d.max = static_cast<float>(d.max * factor);
+  return d;
+}
+} // namespace
+
+void ProcessingStats::addStageDuration(Stage stage, double seconds) {
+  _stages[static_cast<int>(stage)].add(seconds * microsecondsPerSecond);
+}
+
+void ProcessingStats::addBlock(double processingSeconds, double blockSeconds,
+                               bool isRealtime) {
+  addStageDuration(Stage::total, processingSeconds);
+  if (blockSeconds <= 0.) {
+    return;
+  }
+  const auto load = processingSeconds / blockSeconds;
+  _load.add(load * 100. * loadUnitsPerPercent);
+  if (isRealtime && load > 1.) {
+    _numDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ProcessingStats::addXrun() {
+  _numXruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProcessingStats::addShifterBufferFailures(int count) {
+  if (count > 0) {
+    _numShifterBufferFailures.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+ProcessingStats::Summary ProcessingStats::getSummary() {
+  Summary summary;
+  for (auto i = 0; i < numStages; ++i) {
+    summary.stages[i] =
+        scaled(_stages[i].takeDistribution(), 1. / microsecondsPerSecond);
+  }
+  summary.load = scaled(_load.takeDistribution(), 1. / loadUnitsPerPercent);
+  summary.numDeadlineMisses = _numDeadlineMisses.load();
+  summary.numXruns = _numXruns.load();
+  summary.numShifterBufferFailures = _numShifterBufferFailures.load();
+  return summary;
+}
+
+void ProcessingStats::Histogram::add(double value) {
+  auto &count = _counts[_getBucketIndex(value)];
+  // Single writer: no need for an atomic read-modify-write.
+  count.store(count.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+  if (value > _max.load(std::memory_order_relaxed)) {
+    _max.store(value, std::memory_order_relaxed);
+  }
+}
+
+ProcessingStats::Distribution ProcessingStats::Histogram::takeDistribution() {
+  std::array<uint32_t, numBuckets> counts;
+  uint32_t total = 0;
+  for (auto i = 0; i < numBuckets; ++i) {
+    const auto count = _counts[i].load(std::memory_order_relaxed);
+    // Unsigned arithmetic: fine even if the counter wrapped around.
+    counts[i] = count - _countsAtLastRead[i];
+    _countsAtLastRead[i] = count;
+    total += counts[i];
+  }
+  const auto max = _max.exchange(0., std::memory_order_relaxed);
+  Distribution distribution;
+  if (total == 0) {
+    return distribution;
+  }
+  const auto getPercentile = [&](double p) {
+    const auto rank = static_cast<uint32_t>(std::ceil(p * total));
+    uint32_t cumulated = 0;
+    for (auto i = 0; i < numBuckets; ++i) {
+      cumulated += counts[i];
+      if (cumulated >= rank) {
+        const auto bound = _getBucketUpperBound(i);
+        // The max may have been reset by a previous read while the audio
+        // thread was adding this value.
+        return static_cast<float>(max > 0. ? std::min(bound, max) : bound);
+      }
+    }
+    return static_cast<float>(max);
+  };
+  distribution.p50 = getPercentile(0.5);
+  distribution.p99 = getPercentile(0.99);
+  distribution.max = static_cast<float>(max);
+  distribution.count = static_cast<int>(total);
+  return distribution;
+}
+
+int ProcessingStats::Histogram::_getBucketIndex(double value) {
+  if (!(value >= 1.)) {
+    return 0;
+  }
+  const auto index =
+      1 + static_cast<int>(std::floor(bucketsPerOctave * std::log2(value)));
+  return std::min(index, numBuckets - 1);
+}
+
+double ProcessingStats::Histogram::_getBucketUpperBound(int index) {
+  return std::exp2(static_cast<double>(index) / bucketsPerOctave);
+}
+
+std::string toString(const ProcessingStats::Summary &summary) {
+  std::string text;
+  char line[128];
+  for (auto i = 0; i < ProcessingStats::numStages; ++i) {
+    const auto &d = summary.stages[i];
+    std::snprintf(line, sizeof(line),
+                  "%s: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+                  toString(static_cast<ProcessingStats::Stage>(i)),
+                  d.p50 * 1000, d.p99 * 1000, d.max * 1000);
+    text += line;
+  }
+  std::snprintf(line, sizeof(line), "load: p50 %.1f%%, p99 %.1f%%, max %.1f%%\n",
+                summary.load.p50, summary.load.p99, summary.load.max);
+  text += line;
+  std::snprintf(line, sizeof(line),
+                "deadline misses: %d, xruns: %d, shifter buffer failures: %d",
+                summary.numDeadlineMisses, summary.numXruns,
+                summary.numShifterBufferFailures);
+  text += line;
+  return text;
+}
+} // namespace saint
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace saint {
+// Statistics about `SoloHarmonizer::processBlock`, cheap enough to be always
+// on. Written by the audio thread only, and read, without locking, by one
+// other thread (the one updating the editor).
+class ProcessingStats {
+public:
+  enum class Stage {
+    pitchDetection,
+    intervalLookup,
+    pitchShifting,
+    // All of `processBlock`.
+    total,
+  };
+  static constexpr auto numStages = 4;
+
+  // Percentiles have the resolution of the histogram buckets, i.e., about
+  // 20%. All are 0 if nothing was recorded.
+  struct Distribution {
+    float p50 = 0.f;
+    float p99 = 0.f;
+    float max = 0.f;
+    int count = 0;
+  };
+
+  struct Summary {
+    // In seconds.
+    std::array<Distribution, numStages> stages;
+    // Processing time over block duration, in percent.
+    Distribution load;
+    // These are totals since construction.
+    int numDeadlineMisses = 0;
+    int numXruns = 0;
+    int numShifterBufferFailures = 0;
+  };
+
+  // Audio thread.
+  void addStageDuration(Stage, double seconds);
+  // In real time, also counts a deadline miss if processing took longer than
+  // the block lasts.
+  void addBlock(double processingSeconds, double blockSeconds,
+                bool isRealtime = true);
+  void addXrun();
+  void addShifterBufferFailures(int);
+
+  // What was added since the previous call, and the totals. Not to be called
+  // concurrently with itself.
+  Summary getSummary();
+
+private:
+  // Four log-spaced buckets per octave, the first one catching everything
+  // below 1.
+  class Histogram {
+  public:
+    void add(double value);
+    // In the same unit as the added values.
+    Distribution takeDistribution();
+
+  private:
+    static constexpr auto bucketsPerOctave = 4;
+    static constexpr auto numOctaves = 24;
+    static constexpr auto numBuckets = 1 + bucketsPerOctave * numOctaves;
+
+    static int _getBucketIndex(double value);
+    static double _getBucketUpperBound(int index);
+
+    std::array<std::atomic<uint32_t>, numBuckets> _counts{};
+    std::atomic<double> _max = 0.;
+    // Reader side.
+    std::array<uint32_t, numBuckets> _countsAtLastRead{};
+  };
+
+  // Durations are recorded in microseconds and load in hundredths of a
+  // percent, which fits them in the histograms' range with a good resolution.
+  std::array<Histogram, numStages> _stages;
+  Histogram _load;
+  std::atomic<int> _numDeadlineMisses = 0;
+  std::atomic<int> _numXruns = 0;
+  std::atomic<int> _numShifterBufferFailures = 0;
+};
+
+// One line per stage, e.g. for display in the editor.
+std::string toString(const ProcessingStats::Summary &);
+} // namespace saint
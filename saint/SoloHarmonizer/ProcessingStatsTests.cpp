@@ -0,0 +1,70 @@
+#include "ProcessingStats.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+constexpr auto blockSeconds = 0.01;
+// The resolution of the histogram.
+constexpr auto tolerance = 0.2f;
+} // namespace
+
+TEST(ProcessingStats, summary_is_empty_if_nothing_was_recorded) {
+  ProcessingStats sut;
+  const auto summary = sut.getSummary();
+  EXPECT_THAT(summary.load.count, Eq(0));
+  EXPECT_THAT(summary.load.max, Eq(0.f));
+  EXPECT_THAT(summary.numDeadlineMisses, Eq(0));
+}
+
+TEST(ProcessingStats, gives_percentiles_of_the_load) {
+  ProcessingStats sut;
+  // 98 blocks at 10% load, one at 50% and one at 200%.
+  for (auto i = 0; i < 98; ++i) {
+    sut.addBlock(0.1 * blockSeconds, blockSeconds);
+  }
+  sut.addBlock(0.5 * blockSeconds, blockSeconds);
+  sut.addBlock(2. * blockSeconds, blockSeconds);
+  const auto load = sut.getSummary().load;
+  EXPECT_THAT(load.count, Eq(100));
+  EXPECT_THAT(load.p50, FloatNear(10.f, 10.f * tolerance));
+  EXPECT_THAT(load.p99, FloatNear(50.f, 50.f * tolerance));
+  EXPECT_THAT(load.max, FloatEq(200.f));
+}
+
+TEST(ProcessingStats, counts_deadline_misses) {
+  ProcessingStats sut;
+  sut.addBlock(0.9 * blockSeconds, blockSeconds);
+  sut.addBlock(1.1 * blockSeconds, blockSeconds);
+  sut.addBlock(3. * blockSeconds, blockSeconds);
+  EXPECT_THAT(sut.getSummary().numDeadlineMisses, Eq(2));
+  // No deadline when rendering offline.
+  sut.addBlock(3. * blockSeconds, blockSeconds, false);
+  EXPECT_THAT(sut.getSummary().numDeadlineMisses, Eq(2));
+}
+
+TEST(ProcessingStats, distributions_cover_what_was_added_since_last_summary) {
+  ProcessingStats sut;
+  sut.addStageDuration(ProcessingStats::Stage::pitchShifting, 0.002);
+  sut.addXrun();
+  const auto first = sut.getSummary();
+  const auto &firstShifting =
+      first.stages[static_cast<int>(ProcessingStats::Stage::pitchShifting)];
+  EXPECT_THAT(firstShifting.count, Eq(1));
+  EXPECT_THAT(firstShifting.p50, FloatNear(0.002f, 0.002f * tolerance));
+  EXPECT_THAT(firstShifting.max, FloatEq(0.002f));
+
+  sut.addStageDuration(ProcessingStats::Stage::pitchShifting, 0.0001);
+  const auto second = sut.getSummary();
+  const auto &secondShifting =
+      second.stages[static_cast<int>(ProcessingStats::Stage::pitchShifting)];
+  EXPECT_THAT(secondShifting.count, Eq(1));
+  EXPECT_THAT(secondShifting.max, FloatEq(0.0001f));
+  // Totals, on the other hand, aren't reset.
+  EXPECT_THAT(second.numXruns, Eq(1));
+}
+} // namespace saint
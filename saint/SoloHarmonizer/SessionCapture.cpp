@@ -0,0 +1,301 @@
+#include "SessionCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace saint {
+namespace {
+constexpr char magic[] = {'S', 'A', 'I', 'N', 'T', 'C', 'A', 'P'};
+constexpr std::uint32_t formatVersion = 4;
+constexpr auto pollPeriod = std::chrono::milliseconds{10};
+// Sanity limits for reading.
+constexpr std::uint32_t maxPathSize = 1 << 16;
+constexpr std::int32_t maxBlockSize = 1 << 20;
+
+template <typename T> void append(std::vector<char> &bytes, const T &value) {
+  const auto p = reinterpret_cast<const char *>(&value);
+  bytes.insert(bytes.end(), p, p + sizeof(T));
+}
+
+template <typename T> void write(std::ofstream &file, const T &value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> bool read(std::ifstream &file, T &value) {
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+std::int32_t toInt32(const std::optional<int> &value) {
+  return value.has_value() ? *value : -1;
+}
+
+std::optional<int> toOptional(std::int32_t value) {
+  return value >= 0 ? std::optional<int>{value} : std::nullopt;
+}
+} // namespace
+
+SessionRecorder::SessionRecorder(const std::filesystem::path &path)
+    : _file(path, std::ios::binary),
+      _headers(std::make_unique<
+               jnk0le::Ringbuffer<BlockHeader, maxPendingBlocks>>()),
+      _samples(
+          std::make_unique<jnk0le::Ringbuffer<float, maxPendingSamples>>()),
+      _blockSamples(maxPendingSamples) {
+  _file.write(magic, sizeof(magic));
+  write(_file, formatVersion);
+  _thread = std::thread{[this] { _run(); }};
+}
+
+SessionRecorder::~SessionRecorder() {
+  _isRunning = false;
+  _thread.join();
+  _writePending(true);
+}
+
+bool SessionRecorder::isOpen() const { return _file.good(); }
+
+void SessionRecorder::recordPrepare(const capture::Prepare &prepare) {
+  std::vector<char> bytes;
+  append(bytes, capture::RecordType::prepare);
+  append(bytes, static_cast<std::int32_t>(prepare.sampleRate));
+  append(bytes, static_cast<std::int32_t>(prepare.samplesPerBlock));
+  append(bytes, static_cast<std::uint8_t>(prepare.processingMode));
+  _pushRecord(std::move(bytes));
+}
+
+void SessionRecorder::recordScore(const capture::Score &score) {
+  const auto path = score.midiFile.string();
+  std::vector<char> bytes;
+  append(bytes, capture::RecordType::score);
+  append(bytes, static_cast<std::uint32_t>(path.size()));
+  bytes.insert(bytes.end(), path.begin(), path.end());
+  append(bytes, toInt32(score.playedTrack));
+  append(bytes, toInt32(score.harmonyTrack));
+  _pushRecord(std::move(bytes));
+}
+
+void SessionRecorder::recordBlock(const float *samples, int numSamples,
+                                  DavidCNAntonia::ProcessingMode processingMode,
+                                  const std::optional<float> &timeInCrotchets,
+                                  const Playhead::Jump *jumps, int numJumps) {
+  // Single producer: no need for an atomic read-modify-write.
+  const auto index = _numBlocks.load(std::memory_order_relaxed);
+  _numBlocks.store(index + 1, std::memory_order_relaxed);
+  // In case the last one wasn't: its samples are in already.
+  finishBlock();
+  if (_headers->writeAvailable() == 0 ||
+      _samples->writeAvailable() < static_cast<size_t>(numSamples)) {
+    _numDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // Samples first: once the writer sees the header, they're there.
+  _samples->writeBuff(samples, static_cast<size_t>(numSamples));
+  auto &header = _pendingHeader;
+  header.index = index;
+  header.numSamples = numSamples;
+  header.processingMode = processingMode;
+  header.timeInCrotchets = timeInCrotchets;
+  header.numJumps = std::clamp(numJumps, 0, maxJumpsPerBlock);
+  std::copy(jumps, jumps + header.numJumps, header.jumps.begin());
+  header.numPartTimes = 0;
+  _hasPendingHeader = true;
+}
+
+void SessionRecorder::recordPartTime(const capture::PartTime &partTime) {
+  auto &header = _pendingHeader;
+  if (_hasPendingHeader && header.numPartTimes < maxPartTimesPerBlock) {
+    header.partTimes[header.numPartTimes++] = partTime;
+  }
+}
+
+void SessionRecorder::finishBlock() {
+  if (_hasPendingHeader) {
+    _headers->insert(_pendingHeader);
+    _hasPendingHeader = false;
+  }
+}
+
+int SessionRecorder::getNumDroppedBlocks() const { return _numDroppedBlocks; }
+
+void SessionRecorder::_pushRecord(std::vector<char> bytes) {
+  std::lock_guard<std::mutex> lock{_recordsMutex};
+  _records.push_back({_numBlocks.load(), std::move(bytes)});
+}
+
+void SessionRecorder::_run() {
+  while (_isRunning) {
+    _writePending(false);
+    std::this_thread::sleep_for(pollPeriod);
+  }
+}
+
+void SessionRecorder::_writePending(bool isLastCall) {
+  BlockHeader header;
+  while (_headers->remove(header)) {
+    _writeRecordsDueBefore(header.index);
+    const auto numSamples = static_cast<std::int32_t>(header.numSamples);
+    _samples->readBuff(_blockSamples.data(), static_cast<size_t>(numSamples));
+    write(_file, capture::RecordType::block);
+    write(_file, numSamples);
+    write(_file, static_cast<std::uint8_t>(header.processingMode));
+    write(_file, static_cast<std::uint8_t>(header.timeInCrotchets.has_value()));
+    write(_file, header.timeInCrotchets.value_or(0.f));
+    write(_file, static_cast<std::uint8_t>(header.numJumps));
+    for (auto i = 0; i < header.numJumps; ++i) {
+      write(_file, static_cast<std::int32_t>(header.jumps[i].numSamplesBefore));
+      write(_file, header.jumps[i].timeInCrotchetsAfter);
+    }
+    write(_file, static_cast<std::uint8_t>(header.numPartTimes));
+    for (auto i = 0; i < header.numPartTimes; ++i) {
+      const auto &partTime = header.partTimes[i];
+      write(_file, static_cast<std::int32_t>(partTime.sampleOffset));
+      write(_file,
+            static_cast<std::uint8_t>(partTime.timeInCrotchets.has_value()));
+      write(_file, partTime.timeInCrotchets.value_or(0.f));
+    }
+    _file.write(reinterpret_cast<const char *>(_blockSamples.data()),
+                numSamples * sizeof(float));
+    _numBlocksWritten = header.index + 1;
+  }
+  // Records made after the last block we got can be written already, unless
+  // blocks were dropped after it, in which case we wait for the next block to
+  // know where the gap ends. Unless there won't be any more blocks.
+  _writeRecordsDueBefore(isLastCall ? _numBlocks.load() : _numBlocksWritten);
+  _file.flush();
+}
+
+void SessionRecorder::_writeRecordsDueBefore(std::uint64_t blockIndex) {
+  const auto writeGapUntil = [this](std::uint64_t index) {
+    if (index > _numBlocksWritten) {
+      write(_file, capture::RecordType::gap);
+      write(_file, static_cast<std::uint32_t>(index - _numBlocksWritten));
+      _numBlocksWritten = index;
+    }
+  };
+  std::lock_guard<std::mutex> lock{_recordsMutex};
+  while (!_records.empty() && _records.front().blockIndex <= blockIndex) {
+    const auto &record = _records.front();
+    writeGapUntil(record.blockIndex);
+    _file.write(record.bytes.data(), record.bytes.size());
+    _records.pop_front();
+  }
+  writeGapUntil(blockIndex);
+}
+
+CaptureReader::CaptureReader(const std::filesystem::path &path)
+    : _file(path, std::ios::binary) {
+  char fileMagic[sizeof(magic)];
+  std::uint32_t version = 0;
+  _isOpen = _file.read(fileMagic, sizeof(fileMagic)) &&
+            std::memcmp(fileMagic, magic, sizeof(magic)) == 0 &&
+            read(_file, version) && version == formatVersion;
+}
+
+bool CaptureReader::isOpen() const { return _isOpen; }
+
+bool CaptureReader::hasError() const { return _hasError; }
+
+std::optional<capture::Record> CaptureReader::next() {
+  if (!_isOpen || _hasError ||
+      _file.peek() == std::ifstream::traits_type::eof()) {
+    return std::nullopt;
+  }
+  auto type = capture::RecordType{};
+  read(_file, type);
+  switch (type) {
+  case capture::RecordType::prepare: {
+    std::int32_t sampleRate = 0;
+    std::int32_t samplesPerBlock = 0;
+    std::uint8_t mode = 0;
+    if (read(_file, sampleRate) && read(_file, samplesPerBlock) &&
+        read(_file, mode)) {
+      return capture::Prepare{
+          sampleRate, samplesPerBlock,
+          static_cast<DavidCNAntonia::ProcessingMode>(mode)};
+    }
+    break;
+  }
+  case capture::RecordType::score: {
+    std::uint32_t pathSize = 0;
+    if (!read(_file, pathSize) || pathSize > maxPathSize) {
+      break;
+    }
+    std::string path(pathSize, '\0');
+    std::int32_t playedTrack = 0;
+    std::int32_t harmonyTrack = 0;
+    if (_file.read(path.data(), pathSize) && read(_file, playedTrack) &&
+        read(_file, harmonyTrack)) {
+      return capture::Score{path, toOptional(playedTrack),
+                            toOptional(harmonyTrack)};
+    }
+    break;
+  }
+  case capture::RecordType::block: {
+    std::int32_t numSamples = 0;
+    std::uint8_t mode = 0;
+    std::uint8_t hasTime = 0;
+    auto time = 0.f;
+    std::uint8_t numJumps = 0;
+    if (!read(_file, numSamples) || numSamples < 0 ||
+        numSamples > maxBlockSize || !read(_file, mode) ||
+        !read(_file, hasTime) ||
+        !read(_file, time) || !read(_file, numJumps) ||
+        numJumps > SessionRecorder::maxJumpsPerBlock) {
+      break;
+    }
+    capture::Block block;
+    block.processingMode = static_cast<DavidCNAntonia::ProcessingMode>(mode);
+    if (hasTime) {
+      block.timeInCrotchets = time;
+    }
+    for (auto i = 0; i < numJumps; ++i) {
+      std::int32_t numSamplesBefore = 0;
+      auto timeAfter = 0.f;
+      if (!read(_file, numSamplesBefore) || !read(_file, timeAfter)) {
+        break;
+      }
+      block.jumps.push_back({numSamplesBefore, timeAfter});
+    }
+    std::uint8_t numPartTimes = 0;
+    if (!read(_file, numPartTimes) ||
+        numPartTimes > SessionRecorder::maxPartTimesPerBlock) {
+      break;
+    }
+    for (auto i = 0; i < numPartTimes; ++i) {
+      std::int32_t sampleOffset = 0;
+      std::uint8_t hasPartTime = 0;
+      auto partTime = 0.f;
+      if (!read(_file, sampleOffset) || !read(_file, hasPartTime) ||
+          !read(_file, partTime)) {
+        break;
+      }
+      block.partTimes.push_back(
+          {sampleOffset, hasPartTime ? std::optional<float>{partTime}
+                                     : std::nullopt});
+    }
+    block.samples.resize(static_cast<size_t>(numSamples));
+    if (_file.read(reinterpret_cast<char *>(block.samples.data()),
+                   numSamples * sizeof(float))) {
+      return block;
+    }
+    break;
+  }
+  case capture::RecordType::gap: {
+    std::uint32_t numBlocks = 0;
+    if (read(_file, numBlocks) &&
+        numBlocks <= static_cast<std::uint32_t>(
+                         std::numeric_limits<std::int32_t>::max())) {
+      return capture::Gap{static_cast<int>(numBlocks)};
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  _hasError = true;
+  return std::nullopt;
+}
+} // namespace saint
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "DavidCNAntonia/IPitchShifter.h"
+#include "Playhead.h"
+
+#include <ringbuffer.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace saint {
+// Captures of what the plugin was given to process, for a session to be
+// replayed offline, e.g. to profile it.
+// A capture file starts with "SAINTCAP" and a uint32 format version, followed
+// by records, each being a uint8 `capture::RecordType` and the record's
+// fields, all in native byte order:
+//   prepare: int32 sample rate, int32 samples per block, uint8 processing mode
+//   score:   uint32 path size, path, int32 played and harmony tracks (-1: none)
+//   block:   int32 sample count, uint8 processing mode, uint8 has time, float
+//            time in crotchets, uint8 jump count, {int32 samples before,
+//            float time in crotchets after}[jump count], uint8 part time
+//            count, {int32 sample offset, uint8 has time, float time in
+//            crotchets}[part time count], float samples[sample count]
+//   gap:     uint32 number of blocks the recorder had to drop
+namespace capture {
+enum class RecordType : uint8_t {
+  prepare = 1,
+  score,
+  block,
+  gap,
+};
+
+struct Prepare {
+  int sampleRate = 0;
+  int samplesPerBlock = 0;
+  DavidCNAntonia::ProcessingMode processingMode =
+      DavidCNAntonia::ProcessingMode::realtime;
+};
+
+struct Score {
+  std::filesystem::path midiFile;
+  std::optional<int> playedTrack;
+  std::optional<int> harmonyTrack;
+};
+
+// Where a part of a block the harmonizer processes in several started, as
+// the playhead told.
+struct PartTime {
+  int sampleOffset = 0;
+  std::optional<float> timeInCrotchets;
+};
+
+// A processing mode other than that of the block before is a switch made
+// without `prepareToPlay`, see `SoloHarmonizer::setProcessingMode`.
+struct Block {
+  DavidCNAntonia::ProcessingMode processingMode =
+      DavidCNAntonia::ProcessingMode::realtime;
+  std::optional<float> timeInCrotchets;
+  // Of the playhead within the block, in order.
+  std::vector<Playhead::Jump> jumps;
+  std::vector<PartTime> partTimes;
+  std::vector<float> samples;
+};
+
+struct Gap {
+  int numDroppedBlocks = 0;
+};
+
+using Record = std::variant<Prepare, Score, Block, Gap>;
+} // namespace capture
+
+// Streams records to a capture file. Blocks are handed over to a background
+// writer thread through wait-free rings, without allocating ; the other
+// records go through a queue under a mutex. Records are written in the order
+// they were made.
+class SessionRecorder {
+public:
+  // Jumps past those of a block are left out. Loops last at least a bar.
+  static constexpr auto maxJumpsPerBlock = 16;
+  // Also left out past that, as are the blocks of over 30 seconds at 48kHz
+  // that would need more.
+  static constexpr auto maxPartTimesPerBlock = 32;
+
+  explicit SessionRecorder(const std::filesystem::path &);
+  // Writes what's still pending.
+  ~SessionRecorder();
+
+  bool isOpen() const;
+
+  // Not for the audio thread. Prepare records are for `prepareToPlay` calls:
+  // the processing mode of each block is recorded with it.
+  void recordPrepare(const capture::Prepare &);
+  void recordScore(const capture::Score &);
+
+  // Audio thread only, with the block about to be processed. The block is
+  // dropped, and a gap recorded instead, if the writer is lagging behind.
+  void recordBlock(const float *samples, int numSamples,
+                   DavidCNAntonia::ProcessingMode,
+                   const std::optional<float> &timeInCrotchets,
+                   const Playhead::Jump *jumps = nullptr, int numJumps = 0);
+  // Audio thread only, while the block is processed.
+  void recordPartTime(const capture::PartTime &);
+  // Audio thread only, once the block is processed: hands it over to the
+  // writer.
+  void finishBlock();
+  int getNumDroppedBlocks() const;
+
+private:
+  static constexpr auto maxPendingBlocks = 1024;
+  // Over 20 seconds at 48kHz.
+  static constexpr auto maxPendingSamples = 1 << 20;
+
+  struct BlockHeader {
+    std::uint64_t index = 0;
+    int numSamples = 0;
+    DavidCNAntonia::ProcessingMode processingMode =
+        DavidCNAntonia::ProcessingMode::realtime;
+    std::optional<float> timeInCrotchets;
+    std::array<Playhead::Jump, maxJumpsPerBlock> jumps;
+    int numJumps = 0;
+    std::array<capture::PartTime, maxPartTimesPerBlock> partTimes;
+    int numPartTimes = 0;
+  };
+
+  // Other records, to be written before the block of that index.
+  struct PendingRecord {
+    std::uint64_t blockIndex = 0;
+    std::vector<char> bytes;
+  };
+
+  void _run();
+  void _writePending(bool isLastCall);
+  void _writeRecordsDueBefore(std::uint64_t blockIndex);
+  void _pushRecord(std::vector<char>);
+
+  std::ofstream _file;
+  const std::unique_ptr<jnk0le::Ringbuffer<BlockHeader, maxPendingBlocks>>
+      _headers;
+  const std::unique_ptr<jnk0le::Ringbuffer<float, maxPendingSamples>> _samples;
+  // Blocks passed to `recordBlock`, including dropped ones.
+  std::atomic<std::uint64_t> _numBlocks = 0;
+  std::atomic<int> _numDroppedBlocks = 0;
+  // Audio thread side: the block being processed, unless dropped.
+  BlockHeader _pendingHeader;
+  bool _hasPendingHeader = false;
+  std::mutex _recordsMutex;
+  std::deque<PendingRecord> _records;
+  // Writer side.
+  std::uint64_t _numBlocksWritten = 0;
+  std::vector<float> _blockSamples;
+  std::atomic<bool> _isRunning = true;
+  std::thread _thread;
+};
+
+// Reads a capture file one record at a time, so that long sessions needn't
+// fit in memory.
+class CaptureReader {
+public:
+  explicit CaptureReader(const std::filesystem::path &);
+
+  // False if the file couldn't be opened or isn't a capture.
+  bool isOpen() const;
+  // Nullopt at the end of the file, or if it is corrupt, in which case
+  // `hasError()` is true.
+  std::optional<capture::Record> next();
+  bool hasError() const;
+
+private:
+  std::ifstream _file;
+  bool _isOpen = false;
+  bool _hasError = false;
+};
+} // namespace saint
@@ -0,0 +1,115 @@
+#include "SessionCapture.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+namespace saint {
+
+using namespace ::testing;
+
+namespace {
+std::filesystem::path getCapturePath() {
+  return std::filesystem::temp_directory_path() /
+         "SessionCaptureTests.saintcap";
+}
+
+std::vector<capture::Record> readAll(CaptureReader &reader) {
+  std::vector<capture::Record> records;
+  while (auto record = reader.next()) {
+    records.push_back(std::move(*record));
+  }
+  return records;
+}
+} // namespace
+
+TEST(SessionCapture, replays_records_in_the_order_they_were_made) {
+  const auto path = getCapturePath();
+  const std::vector<float> samples{0.1f, 0.2f, 0.3f};
+  {
+    SessionRecorder sut{path};
+    ASSERT_TRUE(sut.isOpen());
+    sut.recordScore({"song.mid", 1, std::nullopt});
+    sut.recordPrepare(
+        {44100, 512, DavidCNAntonia::ProcessingMode::offline});
+    sut.recordBlock(samples.data(), 3, DavidCNAntonia::ProcessingMode::offline,
+                    1.5f);
+    sut.finishBlock();
+    // Finished by the next.
+    sut.recordBlock(samples.data(), 2, DavidCNAntonia::ProcessingMode::offline,
+                    std::nullopt);
+    sut.recordScore({"song.mid", 1, 2});
+    const Playhead::Jump jump{1, 4.f};
+    // Switched without a `prepareToPlay`.
+    sut.recordBlock(samples.data() + 1, 2,
+                    DavidCNAntonia::ProcessingMode::realtime, 2.f, &jump, 1);
+    sut.recordPartTime({1, 4.f});
+    sut.recordPartTime({2, std::nullopt});
+    sut.finishBlock();
+  }
+  CaptureReader reader{path};
+  ASSERT_TRUE(reader.isOpen());
+  const auto records = readAll(reader);
+  EXPECT_FALSE(reader.hasError());
+  ASSERT_THAT(records.size(), Eq(6u));
+
+  const auto &score = std::get<capture::Score>(records[0]);
+  EXPECT_THAT(score.midiFile, Eq(std::filesystem::path{"song.mid"}));
+  EXPECT_THAT(score.playedTrack, Optional(1));
+  EXPECT_THAT(score.harmonyTrack, Eq(std::nullopt));
+
+  const auto &prepare = std::get<capture::Prepare>(records[1]);
+  EXPECT_THAT(prepare.sampleRate, Eq(44100));
+  EXPECT_THAT(prepare.samplesPerBlock, Eq(512));
+  EXPECT_THAT(prepare.processingMode,
+              Eq(DavidCNAntonia::ProcessingMode::offline));
+
+  const auto &first = std::get<capture::Block>(records[2]);
+  EXPECT_THAT(first.processingMode,
+              Eq(DavidCNAntonia::ProcessingMode::offline));
+  EXPECT_THAT(first.timeInCrotchets, Optional(1.5f));
+  EXPECT_THAT(first.jumps, IsEmpty());
+  EXPECT_THAT(first.partTimes, IsEmpty());
+  EXPECT_THAT(first.samples, ElementsAre(0.1f, 0.2f, 0.3f));
+  const auto &second = std::get<capture::Block>(records[3]);
+  EXPECT_THAT(second.timeInCrotchets, Eq(std::nullopt));
+  EXPECT_THAT(second.samples, ElementsAre(0.1f, 0.2f));
+  EXPECT_THAT(std::get<capture::Score>(records[4]).harmonyTrack, Optional(2));
+  const auto &third = std::get<capture::Block>(records[5]);
+  EXPECT_THAT(third.processingMode,
+              Eq(DavidCNAntonia::ProcessingMode::realtime));
+  ASSERT_THAT(third.jumps.size(), Eq(1u));
+  EXPECT_THAT(third.jumps[0].numSamplesBefore, Eq(1));
+  EXPECT_THAT(third.jumps[0].timeInCrotchetsAfter, Eq(4.f));
+  ASSERT_THAT(third.partTimes.size(), Eq(2u));
+  EXPECT_THAT(third.partTimes[0].sampleOffset, Eq(1));
+  EXPECT_THAT(third.partTimes[0].timeInCrotchets, Optional(4.f));
+  EXPECT_THAT(third.partTimes[1].sampleOffset, Eq(2));
+  EXPECT_THAT(third.partTimes[1].timeInCrotchets, Eq(std::nullopt));
+  EXPECT_THAT(third.samples, ElementsAre(0.2f, 0.3f));
+}
+
+TEST(SessionCapture, reports_truncated_files) {
+  const auto path = getCapturePath();
+  const std::vector<float> samples(256, 0.5f);
+  {
+    SessionRecorder sut{path};
+    sut.recordBlock(samples.data(), 256,
+                    DavidCNAntonia::ProcessingMode::realtime, 0.f);
+    sut.finishBlock();
+  }
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+  CaptureReader reader{path};
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_THAT(readAll(reader), IsEmpty());
+  EXPECT_TRUE(reader.hasError());
+}
+
+TEST(SessionCapture, rejects_files_that_arent_captures) {
+  const auto path = getCapturePath();
+  std::ofstream{path} << "RIFF....WAVE";
+  CaptureReader reader{path};
+  EXPECT_FALSE(reader.isOpen());
+}
+} // namespace saint
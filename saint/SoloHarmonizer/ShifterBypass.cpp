@@ -0,0 +1,67 @@
+#include "ShifterBypass.h"
+
+#include <algorithm>
+
+namespace saint {
+namespace {
+// Counts don't need to go any further than the threshold they're compared
+// with ; saturating them avoids overflow on sessions idling for hours.
+int accumulate(int count, int numSamples, int threshold) {
+  return std::min(count + numSamples, threshold);
+}
+} // namespace
+
+ShifterBypass::ShifterBypass(int latency, int holdSamples)
+    : _latency(latency), _holdSamples(std::max(holdSamples, latency)) {}
+
+void ShifterBypass::reset() {
+  _state = State::idle;
+  _unneededSamples = 0;
+  _warmUpRemaining = 0;
+  _shifterSilentTail = 0;
+  _inputSilentTail = 0;
+}
+
+ShifterBypass::State ShifterBypass::update(bool shifterIsNeeded,
+                                           bool inputIsSilent, int blockSize) {
+  switch (_state) {
+  case State::active:
+    _unneededSamples = shifterIsNeeded ? 0
+                                       : accumulate(_unneededSamples,
+                                                    blockSize, _holdSamples);
+    if (_unneededSamples >= _holdSamples) {
+      _state = State::idle;
+    }
+    break;
+  case State::idle:
+    if (shifterIsNeeded) {
+      if (_shifterSilentTail >= _latency && _inputSilentTail >= _latency) {
+        _state = State::active;
+        _unneededSamples = 0;
+      } else {
+        _state = State::warmingUp;
+        _warmUpRemaining = _latency;
+      }
+    }
+    break;
+  case State::warmingUp:
+    if (!shifterIsNeeded) {
+      _state = State::idle;
+    } else if (_warmUpRemaining <= 0) {
+      _state = State::active;
+      _unneededSamples = 0;
+    }
+    break;
+  }
+  if (_state != State::idle) {
+    _shifterSilentTail =
+        inputIsSilent ? accumulate(_shifterSilentTail, blockSize, _latency) : 0;
+  }
+  if (_state == State::warmingUp) {
+    _warmUpRemaining -= blockSize;
+  }
+  _inputSilentTail =
+      inputIsSilent ? accumulate(_inputSilentTail, blockSize, _latency) : 0;
+  return _state;
+}
+} // namespace saint
@@ -0,0 +1,41 @@
+#pragma once
+
+namespace saint {
+// Decides, block after block, whether the pitch shifter needs running.
+// When it doesn't, the caller outputs its input through a delay line matching
+// the shifter's latency instead. Both paths must be fed the same input at all
+// times but in `idle` state, for switching between them to be inaudible:
+// * active -> idle only happens once the shifter hasn't been needed for
+//   `holdSamples`, enough for its wet signal to have faded out ;
+// * idle -> active goes through `warmingUp`, where the shifter is run but the
+//   delay line is still output, until the shifter has refilled its own dry
+//   delay. That step is skipped if both the shifter and the delay line only
+//   hold silence.
+class ShifterBypass {
+public:
+  enum class State {
+    active,
+    warmingUp,
+    idle,
+  };
+
+  ShifterBypass(int latency, int holdSamples);
+
+  State update(bool shifterIsNeeded, bool inputIsSilent, int blockSize);
+  State getState() const { return _state; }
+  // Goes idle, not knowing what the shifter and the delay line hold, e.g.
+  // because they were last fed a while ago: the shifter warms up before it
+  // is output again.
+  void reset();
+
+private:
+  const int _latency;
+  const int _holdSamples;
+  State _state = State::active;
+  int _unneededSamples = 0;
+  int _warmUpRemaining = 0;
+  // Consecutive silent samples last fed to the shifter, and to the delay line.
+  int _shifterSilentTail = 0;
+  int _inputSilentTail = 0;
+};
+} // namespace saint
@@ -0,0 +1,74 @@
+#include "ShifterBypass.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace saint {
+
+using namespace ::testing;
+using State = ShifterBypass::State;
+
+namespace {
+constexpr auto latency = 1000;
+constexpr auto holdSamples = 2000;
+constexpr auto blockSize = 500;
+} // namespace
+
+TEST(ShifterBypass, goes_idle_only_after_hold_time) {
+  ShifterBypass sut{latency, holdSamples};
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::active));
+  for (auto n = blockSize; n < holdSamples; n += blockSize) {
+    EXPECT_THAT(sut.update(false, false, blockSize), Eq(State::active));
+  }
+  EXPECT_THAT(sut.update(false, false, blockSize), Eq(State::idle));
+}
+
+TEST(ShifterBypass, warms_up_for_the_latency_before_resuming) {
+  ShifterBypass sut{latency, holdSamples};
+  for (auto n = 0; n < holdSamples; n += blockSize) {
+    sut.update(false, false, blockSize);
+  }
+  ASSERT_THAT(sut.getState(), Eq(State::idle));
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::warmingUp));
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::warmingUp));
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::active));
+}
+
+TEST(ShifterBypass, warm_up_is_interrupted_if_shifter_no_longer_needed) {
+  ShifterBypass sut{latency, holdSamples};
+  for (auto n = 0; n < holdSamples; n += blockSize) {
+    sut.update(false, false, blockSize);
+  }
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::warmingUp));
+  EXPECT_THAT(sut.update(false, false, blockSize), Eq(State::idle));
+}
+
+TEST(ShifterBypass, resumes_immediately_after_silence) {
+  ShifterBypass sut{latency, holdSamples};
+  for (auto n = 0; n < holdSamples; n += blockSize) {
+    sut.update(false, true, blockSize);
+  }
+  ASSERT_THAT(sut.getState(), Eq(State::idle));
+  EXPECT_THAT(sut.update(false, true, blockSize), Eq(State::idle));
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::active));
+}
+
+TEST(ShifterBypass, warms_up_if_delay_line_got_audio_while_idle) {
+  ShifterBypass sut{latency, holdSamples};
+  for (auto n = 0; n < holdSamples; n += blockSize) {
+    sut.update(false, true, blockSize);
+  }
+  // E.g. transport stopped but someone's playing.
+  EXPECT_THAT(sut.update(false, false, blockSize), Eq(State::idle));
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::warmingUp));
+}
+
+TEST(ShifterBypass, warms_up_after_a_reset) {
+  ShifterBypass sut{latency, holdSamples};
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::active));
+  sut.reset();
+  EXPECT_THAT(sut.getState(), Eq(State::idle));
+  EXPECT_THAT(sut.update(true, false, blockSize), Eq(State::warmingUp));
+}
+
+} // namespace saint
@@ -1,15 +1,85 @@
 #include "SoloHarmonizer.h"
 #include "IntervalGetter.h"
 #include "MidiFileOwner.h"
+#include "PhaseVocoderPitchShifter.h"
 #include "SoloHarmonizerHelper.h"
+#include "Tracing.h"
 
 #include "spdlog/common.h"
 #include "spdlog/logger.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
 
 namespace saint {
 namespace {
 static std::atomic<int> instanceCounter = 0;
+
+// About -60dB.
+constexpr auto silenceThreshold = 0.001f;
+// Until the tempo can be measured, assume a fast one, so as to rather warm up
+// the shifter too early than too late.
+constexpr auto defaultCrotchetsPerSecond = 4.f;
+// Enough for the shifter's mix to have faded out before bypassing it.
+constexpr auto bypassHoldSeconds = 0.2f;
+// Hosts that double-buffer may call twice in a row and then wait for two
+// block durations ; beyond that, some deadline surely was missed.
+constexpr auto xrunPeriodFactor = 2.5;
+
+// Steps of the quality ladder, cheapest last. Each is cumulative with the
+// ones before.
+enum LoadLevel {
+  fullQuality,
+  noFormantPreservation,
+  highSpeedPitchShifting,
+  sparsePitchDetection,
+  numLoadLevels,
+};
+
+using Clock = std::chrono::steady_clock;
+
+double getSecondsSince(Clock::time_point &start) {
+  const auto now = Clock::now();
+  const std::chrono::duration<double> elapsed = now - start;
+  start = now;
+  return elapsed.count();
+}
+
+bool isSilent(const float *block, int size) {
+  return std::all_of(block, block + size, [](float x) {
+    return std::abs(x) < silenceThreshold;
+  });
+}
+
+const char *toString(DavidCNAntonia::ProcessingMode mode) {
+  return mode == DavidCNAntonia::ProcessingMode::offline ? "offline"
+                                                         : "realtime";
+}
+
+const char *toString(ShifterBypass::State state) {
+  switch (state) {
+  case ShifterBypass::State::active:
+    return "active";
+  case ShifterBypass::State::warmingUp:
+    return "warmingUp";
+  case ShifterBypass::State::idle:
+  default:
+    return "idle";
+  }
+}
+
+// With its level set already, for the audio thread logger not to start
+// draining it if logging is off.
+std::shared_ptr<spdlog::logger> createLogger(const std::string &name) {
+  const auto logger =
+      spdlog::basic_logger_mt(name, saint::generateLogFilename(name).string());
+  logger->set_level(saint::getLogLevelFromEnv());
+  return logger;
+}
 } // namespace
 
 SoloHarmonizer::SoloHarmonizer(std::shared_ptr<MidiFileOwner> midiFileOwner,
@@ -17,63 +87,318 @@ SoloHarmonizer::SoloHarmonizer(std::shared_ptr<MidiFileOwner> midiFileOwner,
     : _midiFileOwner(std::move(midiFileOwner)),
       _loggerName(std::string{"SoloHarmonizer_"} +
                   std::to_string(instanceCounter++)),
-      _logger(spdlog::basic_logger_mt(
-          _loggerName, saint::generateLogFilename(_loggerName).string())),
+      _logger(createLogger(_loggerName)),
+      _audioThreadLogger(std::make_unique<AudioThreadLogger>(_logger)),
       _playhead(playhead) {
-  _logger->set_level(saint::getLogLevelFromEnv());
   _logger->info("ctor {0}", _loggerName);
 }
 
-SoloHarmonizer::~SoloHarmonizer() { _logger->info("dtor {0}", _loggerName); }
+SoloHarmonizer::~SoloHarmonizer() {
+  _logger->info("dtor {0}", _loggerName);
+  // Else the registry keeps the logger, and its file, open forever.
+  spdlog::drop(_loggerName);
+}
 
-void SoloHarmonizer::prepareToPlay(int sampleRate, int samplesPerBlock) {
-  _pitchShifter = DavidCNAntonia::IPitchShifter::createInstance(
-      1, static_cast<double>(sampleRate), samplesPerBlock);
-  _pitchDetector = PitchDetector::createInstance(
-      sampleRate, _midiFileOwner->getLowestPlayedTrackHarmonizedFrequency());
-  _logger->info("prepareToPlay sampleRate={0} samplesPerBlock={1}", sampleRate,
-                samplesPerBlock);
+void SoloHarmonizer::prepareToPlay(int sampleRate, int samplesPerBlock,
+                                   DavidCNAntonia::ProcessingMode mode) {
+  const auto engine = getShifterEngineFromEnv();
+  const auto leastFrequency =
+      _midiFileOwner->getLowestPlayedTrackHarmonizedFrequency();
+  const auto otherMode = mode == DavidCNAntonia::ProcessingMode::offline
+                             ? DavidCNAntonia::ProcessingMode::realtime
+                             : DavidCNAntonia::ProcessingMode::offline;
+  if (engine == ShifterEngine::phaseVocoder) {
+    _pitchDetector = PitchDetector::createInstance(
+        sampleRate, leastFrequency, PhaseVocoderPitchShifter::analysisOverlap);
+    auto shifter = std::make_unique<PhaseVocoderPitchShifter>(
+        _pitchDetector->getAnalysisWindow(), _pitchDetector->getFftSize(),
+        _pitchDetector->getHopSize());
+    _pitchDetector->setAnalysisFrameListener(shifter.get());
+    _pitchShifter = std::move(shifter);
+    // Works the same in both modes.
+    _standby.pitchShifter.reset();
+  } else {
+    // Larger blocks are processed in parts of at most that size.
+    const auto maxBlockSize =
+        std::min(samplesPerBlock, PitchDetector::maxBlockSize);
+    _pitchShifter = DavidCNAntonia::IPitchShifter::createInstance(
+        1, static_cast<double>(sampleRate), maxBlockSize, mode);
+    _standby.pitchShifter = DavidCNAntonia::IPitchShifter::createInstance(
+        1, static_cast<double>(sampleRate), maxBlockSize, otherMode);
+    _pitchDetector = PitchDetector::createInstance(sampleRate, leastFrequency);
+  }
+  const auto createLoadShedder = [engine](DavidCNAntonia::ProcessingMode m) {
+    LoadShedder::Config config;
+    // The phase vocoder has no cheaper setting, and its hop is the
+    // detector's. Offline, there is no deadline to meet.
+    config.numLevels = engine == ShifterEngine::phaseVocoder ||
+                               !getLoadSheddingFromEnv() ||
+                               m == DavidCNAntonia::ProcessingMode::offline
+                           ? 1
+                           : numLoadLevels;
+    return std::make_unique<LoadShedder>(config);
+  };
+  const auto createBypass = [sampleRate](int latency) {
+    return std::make_unique<ShifterBypass>(
+        latency, latency + static_cast<int>(bypassHoldSeconds * sampleRate));
+  };
+  _loadShedder = createLoadShedder(mode);
+  _standby.loadShedder = createLoadShedder(otherMode);
+  _loadLevel = fullQuality;
+  _sampleRate = sampleRate;
+  _processingMode = mode;
+  _stageDurations = StageDurations{};
+  _prevBlockSeconds = 0.;
+  _numShifterBufferFailures = 0;
+  _latency = _pitchShifter->getLatency();
+  _dryDelay = std::make_unique<DelayLine>(_latency);
+  _bypass = createBypass(_latency);
+  const auto standbyLatency = _standby.pitchShifter
+                                  ? _standby.pitchShifter->getLatency()
+                                  : _latency.load();
+  _standby.dryDelay = std::make_unique<DelayLine>(standbyLatency);
+  _standby.bypass = createBypass(standbyLatency);
+  _delayedDry.resize(PitchDetector::maxBlockSize);
+  _crotchetsPerSample = defaultCrotchetsPerSecond / sampleRate;
+  _prevTimeInCrotchets.reset();
+  _prevBlockTimeInCrotchets.reset();
+  _prevBlockHasJumps = false;
+  _logger->info(
+      "prepareToPlay sampleRate={0} samplesPerBlock={1} engine={2} mode={3}",
+      sampleRate, samplesPerBlock,
+      engine == ShifterEngine::phaseVocoder ? "phasevocoder" : "rubberband",
+      toString(mode));
+}
+
+void SoloHarmonizer::setProcessingMode(DavidCNAntonia::ProcessingMode mode) {
+  if (mode == _processingMode || !_pitchShifter) {
+    return;
+  }
+  // So that the shifter going on standby is at full quality when it's back.
+  _setLoadLevel(fullQuality);
+  if (_standby.pitchShifter) {
+    std::swap(_pitchShifter, _standby.pitchShifter);
+  }
+  std::swap(_loadShedder, _standby.loadShedder);
+  std::swap(_dryDelay, _standby.dryDelay);
+  std::swap(_bypass, _standby.bypass);
+  // What they hold, if anything, is from the last time they were used.
+  _loadShedder->reset();
+  _dryDelay->clear();
+  _bypass->reset();
+  _processingMode = mode;
+  _latency = _pitchShifter->getLatency();
+  _numShifterBufferFailures = _pitchShifter->getNumBufferFailures();
+  _prevBlockSeconds = 0.;
+  _audioThreadLogger->info("processing mode -> {0}", toString(mode));
 }
 
 void SoloHarmonizer::releaseResources() {
   // When playback stops, you can use this as an opportunity to free up any
   // spare memory, etc.
+  if (_pitchDetector) {
+    _pitchDetector->setAnalysisFrameListener(nullptr);
+  }
   _pitchShifter.reset();
+  _standby.pitchShifter.reset();
+  _latency = 0;
   _logger->info("releaseResources");
-  _logger->flush();
+  _audioThreadLogger->flush();
+}
+
+int SoloHarmonizer::getLoadLevel() const { return _loadLevel; }
+
+int SoloHarmonizer::getLatency() const { return _latency; }
+
+DavidCNAntonia::ProcessingMode SoloHarmonizer::getProcessingMode() const {
+  return _processingMode;
+}
+
+const SoloHarmonizer::StageDurations &
+SoloHarmonizer::getStageDurations() const {
+  return _stageDurations;
+}
+
+ProcessingStats &SoloHarmonizer::getProcessingStats() {
+  return _processingStats;
+}
+
+void SoloHarmonizer::_setLoadLevel(int level) {
+  if (level == _loadLevel) {
+    return;
+  }
+  _audioThreadLogger->info("load level {0} -> {1} (smoothed load {2})",
+                           _loadLevel.load(), level,
+                           _loadShedder->getSmoothedLoad());
+  _loadLevel = level;
+  // All of these can be changed on the fly without glitch.
+  _pitchShifter->setFormantPreserving(level < noFormantPreservation);
+  _pitchShifter->setPitchHighSpeed(level >= highSpeedPitchShifting);
+  _pitchDetector->setAnalysisOverlap(level >= sparsePitchDetection
+                                         ? 1
+                                         : PitchDetector::defaultAnalysisOverlap);
 }
 
 void SoloHarmonizer::setSemitoneShift(float value) {
   _pitchShifter->setSemitoneShift(value);
 }
 
+void SoloHarmonizer::_updateCrotchetsPerSample(
+    const std::optional<float> &timeInCrotchets, int blockSize,
+    bool isContinuous) {
+  if (isContinuous && timeInCrotchets.has_value() &&
+      _prevBlockTimeInCrotchets.has_value() &&
+      *timeInCrotchets > *_prevBlockTimeInCrotchets) {
+    _crotchetsPerSample = (*timeInCrotchets - *_prevBlockTimeInCrotchets) /
+                          static_cast<float>(_prevBlockSize);
+  }
+  _prevBlockTimeInCrotchets = timeInCrotchets;
+  _prevBlockSize = blockSize;
+}
+
+bool SoloHarmonizer::_isHarmonyDue(const IntervalGetter &intervalGetter,
+                                   float timeInCrotchets, int blockSize) {
+  _prevTimeInCrotchets = timeInCrotchets;
+  // Leave the shifter time to warm up before the harmony begins, accounting
+  // for the block granularity of the decision.
+  const auto lookaheadSamples = 2 * (_pitchShifter->getLatency() + blockSize);
+  return intervalGetter.hasHarmonyBetween(
+      timeInCrotchets,
+      timeInCrotchets + _crotchetsPerSample * lookaheadSamples);
+}
+
 void SoloHarmonizer::processBlock(float *block, int size) {
-  _logger->trace("processBlock");
-  if (!_midiFileOwner->hasIntervalGetter()) {
-    return;
+  SAINT_TRACE_ZONE("SoloHarmonizer::processBlock");
+  auto start = Clock::now();
+  const auto isRealtime =
+      _processingMode == DavidCNAntonia::ProcessingMode::realtime;
+  if (isRealtime && _prevBlockSeconds > 0.) {
+    const std::chrono::duration<double> period = start - _prevBlockStart;
+    if (period.count() > xrunPeriodFactor * _prevBlockSeconds) {
+      _processingStats.addXrun();
+    }
   }
-  const auto intervalGetter = _midiFileOwner->getIntervalGetter();
-  if (!intervalGetter) {
-    return;
+  const auto blockSeconds = static_cast<float>(size) / _sampleRate;
+  _prevBlockStart = start;
+  _prevBlockSeconds = blockSeconds;
+  _processBlock(block, size);
+  const auto elapsed = getSecondsSince(start);
+  _stageDurations.total += elapsed;
+  _processingStats.addBlock(elapsed, blockSeconds, isRealtime);
+  _setLoadLevel(_loadShedder->update(static_cast<float>(elapsed) / blockSeconds,
+                                     blockSeconds));
+}
+
+void SoloHarmonizer::_processBlock(float *block, int size) {
+  _audioThreadLogger->trace("processBlock");
+  // Parts of the block between jumps of the playhead, e.g. back to the
+  // beginning of a short loop, are processed each at its own time. Hosts may
+  // also give blocks larger than the detector takes, offline especially, and
+  // these are processed in several parts, timed by the playhead.
+  auto timeOpt = _playhead.getTimeInCrotchets();
+  auto hasJumps = timeOpt.has_value() && _playhead.getJump(0, 1).has_value();
+  _updateCrotchetsPerSample(timeOpt, size, !hasJumps && !_prevBlockHasJumps);
+  auto begin = 0;
+  // Whether a jump on sample `begin` is already in `timeOpt`.
+  auto hasJumped = false;
+  while (begin < size) {
+    auto end = std::min(size, begin + PitchDetector::maxBlockSize);
+    const auto from = hasJumped ? begin + 1 : begin;
+    const auto jump = timeOpt.has_value() && from < end
+                          ? _playhead.getJump(from, end - from)
+                          : std::optional<Playhead::Jump>{};
+    if (jump.has_value() && jump->numSamplesBefore == begin) {
+      timeOpt = jump->timeInCrotchetsAfter;
+      hasJumped = true;
+      continue;
+    } else if (jump.has_value()) {
+      end = jump->numSamplesBefore;
+      hasJumps = true;
+    }
+    if (begin > 0 && !hasJumped && timeOpt.has_value()) {
+      timeOpt = _playhead.getTimeInCrotchetsAt(begin);
+    }
+    _processPart(block + begin, end - begin, timeOpt);
+    begin = end;
+    hasJumped = false;
   }
-  const auto timeOpt = _playhead.getTimeInCrotchets();
+  _prevBlockHasJumps = hasJumps;
+}
+
+void SoloHarmonizer::_processPart(float *block, int size,
+                                  const std::optional<float> &timeOpt) {
+  assert(size <= PitchDetector::maxBlockSize);
+  _dryDelay->process(block, _delayedDry.data(), size);
+  const auto intervalGetter = _midiFileOwner->getAudioThreadIntervalGetter();
   if (!timeOpt.has_value()) {
-    // TODO logging
+    _prevTimeInCrotchets.reset();
+  } else if (intervalGetter && _prevTimeInCrotchets.has_value() &&
+             *timeOpt < *_prevTimeInCrotchets) {
+    // The playhead went back, e.g. to the beginning of a loop: the note held
+    // before is no reason to stick to its interval.
+    intervalGetter->reset();
+  }
+  const auto inputIsSilent = isSilent(block, size);
+  const auto harmonyIsDue =
+      intervalGetter && timeOpt.has_value() &&
+      _isHarmonyDue(*intervalGetter, *timeOpt, size);
+  const auto prevState = _bypass->getState();
+  const auto state =
+      _bypass->update(harmonyIsDue && !inputIsSilent, inputIsSilent, size);
+  if (state != prevState) {
+    _audioThreadLogger->debug("shifter bypass: {0} -> {1}",
+                              toString(prevState), toString(state));
+  }
+
+  if (state == ShifterBypass::State::idle) {
+    if (intervalGetter && timeOpt.has_value()) {
+      // No pitch: lets the interval getter follow the playhead rather than
+      // stick to the note it was on when we went idle.
+      intervalGetter->getHarmoInterval(*timeOpt, std::nullopt, size);
+    }
+    std::copy(_delayedDry.begin(), _delayedDry.begin() + size, block);
     return;
   }
-  const auto time = *timeOpt;
+
+  std::optional<float> pitchShift;
+  auto stageStart = Clock::now();
+  // Also without a time or an interval getter, e.g. while the bypass holds
+  // after the transport stopped: the phase vocoder only gets the frames it
+  // outputs through the detector, and would otherwise run dry.
   const auto pitch = _pitchDetector->process(block, size);
-  const auto pitchShift = intervalGetter->getHarmoInterval(time, pitch, size);
-  _logger->debug("_intervalGetter->getHarmoInterval() returned {0}",
-                 pitchShift ? std::to_string(*pitchShift) : "nullopt");
+  const auto detectionSeconds = getSecondsSince(stageStart);
+  _stageDurations.pitchDetection += detectionSeconds;
+  _processingStats.addStageDuration(ProcessingStats::Stage::pitchDetection,
+                                    detectionSeconds);
+  if (intervalGetter && timeOpt.has_value()) {
+    pitchShift = intervalGetter->getHarmoInterval(*timeOpt, pitch, size);
+    const auto lookupSeconds = getSecondsSince(stageStart);
+    _stageDurations.intervalLookup += lookupSeconds;
+    _processingStats.addStageDuration(ProcessingStats::Stage::intervalLookup,
+                                      lookupSeconds);
+    _audioThreadLogger->debug(
+        "_intervalGetter->getHarmoInterval() returned {0}", pitchShift);
+  }
   if (pitchShift.has_value()) {
     _pitchShifter->setMixPercentage(50.f);
     _pitchShifter->setSemitoneShift(*pitchShift);
   } else {
     _pitchShifter->setMixPercentage(0.f);
   }
-  std::vector<float *> channels(1);
-  channels[0] = block;
-  _pitchShifter->processBuffer(channels.data(), 1, size);
+  float *const channels[] = {block};
+  _pitchShifter->processBuffer(channels, 1, size);
+  const auto shiftingSeconds = getSecondsSince(stageStart);
+  _stageDurations.pitchShifting += shiftingSeconds;
+  _processingStats.addStageDuration(ProcessingStats::Stage::pitchShifting,
+                                    shiftingSeconds);
+  const auto numBufferFailures = _pitchShifter->getNumBufferFailures();
+  _processingStats.addShifterBufferFailures(numBufferFailures -
+                                            _numShifterBufferFailures);
+  _numShifterBufferFailures = numBufferFailures;
+  if (state == ShifterBypass::State::warmingUp) {
+    // The shifter is catching up with the input ; its output isn't
+    // trustworthy yet.
+    std::copy(_delayedDry.begin(), _delayedDry.begin() + size, block);
+  }
 }
 } // namespace saint
@@ -1,30 +1,117 @@
 #pragma once
 
+#include "AudioThreadLogger.h"
 #include "DavidCNAntonia/IPitchShifter.h"
+#include "DelayLine.h"
+#include "LoadShedder.h"
 #include "MidiFileOwner.h"
 #include "PitchDetector.h"
 #include "Playhead.h"
+#include "ProcessingStats.h"
+#include "ShifterBypass.h"
 
 #include <spdlog/spdlog.h>
 
+#include <atomic>
+#include <chrono>
+
 namespace saint {
 class SoloHarmonizer {
 public:
+  // Time spent in each stage of `processBlock` since `prepareToPlay`, in
+  // seconds. `total` also covers what isn't any of the other stages.
+  struct StageDurations {
+    double pitchDetection = 0.;
+    double intervalLookup = 0.;
+    double pitchShifting = 0.;
+    double total = 0.;
+  };
+
   SoloHarmonizer(std::shared_ptr<MidiFileOwner>, Playhead &);
   ~SoloHarmonizer();
 
   void setSemitoneShift(float value);
-  void prepareToPlay(int sampleRate, int samplesPerBlock);
+  void prepareToPlay(int sampleRate, int samplesPerBlock,
+                     DavidCNAntonia::ProcessingMode =
+                         DavidCNAntonia::ProcessingMode::realtime);
   void processBlock(float *, int size);
   void releaseResources();
+  // For hosts that switch to or from offline rendering without calling
+  // `prepareToPlay` again: switches to what `prepareToPlay` readied for the
+  // other mode, without allocating. Audio thread only.
+  void setProcessingMode(DavidCNAntonia::ProcessingMode);
+
+  // How many steps down the quality ladder this instance went to meet the
+  // audio deadline. 0 means full quality. Can be called from any thread.
+  int getLoadLevel() const;
+
+  // Valid after `prepareToPlay`. Can be called from any thread.
+  int getLatency() const;
+  DavidCNAntonia::ProcessingMode getProcessingMode() const;
+
+  // Not thread-safe: read it from the audio thread or once processing is over.
+  const StageDurations &getStageDurations() const;
+
+  // Per-block timings, xruns and the like, for live display. See
+  // `ProcessingStats` for the threading constraints.
+  ProcessingStats &getProcessingStats();
 
 private:
+  // What depends on the processing mode, readied by `prepareToPlay` for the
+  // mode it wasn't given.
+  struct Standby {
+    // Null if the same shifter works in both modes.
+    std::unique_ptr<DavidCNAntonia::IPitchShifter> pitchShifter;
+    std::unique_ptr<LoadShedder> loadShedder;
+    std::unique_ptr<DelayLine> dryDelay;
+    std::unique_ptr<ShifterBypass> bypass;
+  };
+
+  void _processBlock(float *, int size);
+  // Of a block the playhead's time doesn't jump within, and no larger than
+  // `PitchDetector::maxBlockSize`.
+  void _processPart(float *, int size,
+                    const std::optional<float> &timeInCrotchets);
+  // From the starts of whole blocks the playhead went through without
+  // jumping.
+  void _updateCrotchetsPerSample(const std::optional<float> &timeInCrotchets,
+                                 int blockSize, bool isContinuous);
+  void _setLoadLevel(int);
+  bool _isHarmonyDue(const IntervalGetter &, float timeInCrotchets,
+                     int blockSize);
+
   const std::shared_ptr<MidiFileOwner> _midiFileOwner;
   const std::string _loggerName;
   const std::shared_ptr<spdlog::logger> _logger;
+  // For all logging from `processBlock`.
+  const std::unique_ptr<AudioThreadLogger> _audioThreadLogger;
   Playhead &_playhead;
   std::unique_ptr<DavidCNAntonia::IPitchShifter> _pitchShifter;
   std::unique_ptr<PitchDetector> _pitchDetector;
   std::optional<float> _pitchShift;
+  // Input delayed by the shifter's latency, output whenever the shifter isn't.
+  std::unique_ptr<DelayLine> _dryDelay;
+  std::vector<float> _delayedDry;
+  std::unique_ptr<ShifterBypass> _bypass;
+  Standby _standby;
+  // That of `_pitchShifter`.
+  std::atomic<int> _latency = 0;
+  float _crotchetsPerSample = 0.f;
+  // Of the last part.
+  std::optional<float> _prevTimeInCrotchets;
+  std::optional<float> _prevBlockTimeInCrotchets;
+  int _prevBlockSize = 0;
+  bool _prevBlockHasJumps = false;
+  int _sampleRate = 0;
+  DavidCNAntonia::ProcessingMode _processingMode =
+      DavidCNAntonia::ProcessingMode::realtime;
+  std::unique_ptr<LoadShedder> _loadShedder;
+  std::atomic<int> _loadLevel = 0;
+  StageDurations _stageDurations;
+  ProcessingStats _processingStats;
+  std::chrono::steady_clock::time_point _prevBlockStart;
+  // 0 until the first block after `prepareToPlay`.
+  double _prevBlockSeconds = 0.;
+  int _numShifterBufferFailures = 0;
 };
 } // namespace saint
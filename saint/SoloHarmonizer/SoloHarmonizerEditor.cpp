@@ -1,6 +1,8 @@
 #include "SoloHarmonizerEditor.h"
 #include "PositionGetter.h"
+#include "SoloHarmonizerHelper.h"
 #include "SoloHarmonizerTypes.h"
+#include "Tracing.h"
 
 namespace saint {
 namespace {
@@ -76,8 +78,8 @@ SoloHarmonizerEditor::SoloHarmonizerEditor(SoloHarmonizerVst &soloHarmonizerVst,
     if (fileChooser.browseForFileToOpen()) {
       const std::filesystem::path path =
           fileChooser.getResult().getFullPathName().toStdString();
-      _midiFileOwner.setMidiFile(path);
-      _updateWidgets();
+      // Widgets are updated once it is loaded.
+      _midiFileOwner.loadMidiFile(path);
     }
   };
   addAndMakeVisible(_chooseFileButton);
@@ -106,6 +108,28 @@ SoloHarmonizerEditor::SoloHarmonizerEditor(SoloHarmonizerVst &soloHarmonizerVst,
   addAndMakeVisible(_beatNumberDisplay);
   addAndMakeVisible(_displayComponent);
 
+  _processingStatsLabel.setFont(
+      juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.f,
+                 juce::Font::plain));
+  _processingStatsLabel.setJustificationType(juce::Justification::topLeft);
+  _processingStatsLabel.setColour(juce::Label::textColourId,
+                                  juce::Colours::whitesmoke.withAlpha(0.7f));
+  addAndMakeVisible(_processingStatsLabel);
+
+#ifdef SAINT_TRACING
+  _dumpTraceButton.setButtonText("Dump trace");
+  _dumpTraceButton.setTooltip("Write the trace zones recorded so far to a "
+                              "Chrome trace file in the log directory");
+  _dumpTraceButton.onClick = [this]() {
+    auto path = generateLogFilename("trace");
+    path.replace_extension(".json");
+    _dumpTraceButton.setButtonText(tracing::dumpChromeTrace(path)
+                                       ? "Dumped " + path.filename().string()
+                                       : "Could not dump trace");
+  };
+  addAndMakeVisible(_dumpTraceButton);
+#endif
+
   _updateWidgets();
 
   _midiFileOwner.addStateChangeListener(this);
@@ -116,7 +140,7 @@ SoloHarmonizerEditor::SoloHarmonizerEditor(SoloHarmonizerVst &soloHarmonizerVst,
 
 SoloHarmonizerEditor::~SoloHarmonizerEditor() {
   _soloHarmonizerVst.onEditorDestruction(this);
-  _midiFileOwner.addStateChangeListener(nullptr);
+  _midiFileOwner.removeStateChangeListener(this);
 }
 
 void SoloHarmonizerEditor::onStateChange() { _updateWidgets(); }
@@ -126,6 +150,21 @@ void SoloHarmonizerEditor::onIntervalSpansAvailable(
   _updateTimeSpans(spans);
 }
 
+void SoloHarmonizerEditor::onMidiFileLoadStarted(
+    const std::filesystem::path &path) {
+  _chooseFileButton.setButtonText("Loading " + path.filename().string() +
+                                  " ...");
+}
+
+void SoloHarmonizerEditor::onMidiFileLoaded(const std::filesystem::path &path,
+                                            bool success) {
+  if (!success) {
+    _updateWidgets();
+    _chooseFileButton.setButtonText("Could not read " +
+                                    path.filename().string());
+  }
+}
+
 void SoloHarmonizerEditor::textEditorReturnKeyPressed(
     juce::TextEditor &editor) {
   _onTextEditorChange(editor);
@@ -155,10 +194,14 @@ void SoloHarmonizerEditor::_onTextEditorChange(juce::TextEditor &editor) {
 
 void SoloHarmonizerEditor::_updateTimeSpans(
     const std::vector<IntervalSpan> &spans) {
-  juce::MessageManager::getInstance()->callAsync([spans, this]() {
-    _displayComponent.setTimeSpans(spans);
-    _updateLayout();
-  });
+  juce::MessageManager::getInstance()->callAsync(
+      [spans, editor = juce::Component::SafePointer<SoloHarmonizerEditor>{
+                  this}]() {
+        if (editor) {
+          editor->_displayComponent.setTimeSpans(spans);
+          editor->_updateLayout();
+        }
+      });
 }
 
 void SoloHarmonizerEditor::_updateWidgets() {
@@ -214,10 +257,22 @@ void SoloHarmonizerEditor::_updateLayout() {
   grid.columnGap = 10_px;
   using Track = Grid::TrackInfo;
   grid.templateRows = {Track(1_fr), Track(1_fr), Track(1_fr)};
+  auto statsRow = 4;
   if (_playButton) {
     grid.templateRows.add(Track(1_fr));
     grid.items.add(GridItem(*_playButton).withRow({4, 5}).withColumn({1, 5}));
+    ++statsRow;
   }
+  grid.templateRows.add(Track(3_fr));
+  grid.items.add(GridItem(_processingStatsLabel)
+                     .withRow({statsRow, statsRow + 1})
+                     .withColumn({1, 5}));
+#ifdef SAINT_TRACING
+  grid.templateRows.add(Track(1_fr));
+  grid.items.add(GridItem(_dumpTraceButton)
+                     .withRow({statsRow + 1, statsRow + 2})
+                     .withColumn({1, 5}));
+#endif
   grid.templateColumns = {Track(1_fr), Track(1_fr), Track(1_fr), Track(1_fr),
                           Track(4_fr)};
   grid.items.addArray(
@@ -228,7 +283,9 @@ void SoloHarmonizerEditor::_updateLayout() {
        GridItem(_loopEndBarEditor).withRow({3, 4}).withColumn({2, 3}),
        GridItem(_barNumberDisplay).withRow({3, 4}).withColumn({3, 4}),
        GridItem(_beatNumberDisplay).withRow({3, 4}).withColumn({4, 5}),
-       GridItem(_displayComponent).withRow({1, 6}).withColumn({5, 6})});
+       GridItem(_displayComponent)
+           .withRow({1, grid.templateRows.size() + 1})
+           .withColumn({5, 6})});
   grid.performLayout(getLocalBounds());
 }
 
@@ -264,11 +321,28 @@ void SoloHarmonizerEditor::updateTimeInCrotchets(float crotchets) {
   const auto barNumberStr = std::to_string(roundedPosition.barIndex + 1);
   const auto beatNumberStr = std::to_string(roundedPosition.beatIndex + 1);
   juce::MessageManager::getInstance()->callAsync(
-      [this, barNumberStr, beatNumberStr, crotchets]() {
-        _displayComponent.updateTimeInCrotchets(crotchets);
-        _barNumberDisplay.setText(barNumberStr);
-        _beatNumberDisplay.setText(beatNumberStr);
-        repaint();
+      [editor = juce::Component::SafePointer<SoloHarmonizerEditor>{this},
+       barNumberStr, beatNumberStr, crotchets]() {
+        if (!editor) {
+          return;
+        }
+        editor->_displayComponent.updateTimeInCrotchets(crotchets);
+        editor->_barNumberDisplay.setText(barNumberStr);
+        editor->_beatNumberDisplay.setText(beatNumberStr);
+        editor->repaint();
+      });
+}
+
+void SoloHarmonizerEditor::updateProcessingStats(
+    const ProcessingStats::Summary &summary) {
+  const auto text = toString(summary);
+  juce::MessageManager::getInstance()->callAsync(
+      [editor = juce::Component::SafePointer<SoloHarmonizerEditor>{this},
+       text]() {
+        if (editor) {
+          editor->_processingStatsLabel.setText(text,
+                                                juce::dontSendNotification);
+        }
       });
 }
 
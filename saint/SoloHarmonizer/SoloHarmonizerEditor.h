@@ -2,6 +2,7 @@
 
 #include "DisplayComponent.h"
 #include "MidiFileOwner.h"
+#include "ProcessingStats.h"
 #include "SoloHarmonizerTypes.h"
 #include "SoloHarmonizerVst.h"
 
@@ -16,7 +17,7 @@ class SoloHarmonizerEditor : public juce::AudioProcessorEditor,
                              public MidiFileOwner::Listener {
 public:
   static constexpr auto width = 800;
-  static constexpr auto height = 300;
+  static constexpr auto height = 400;
 
   SoloHarmonizerEditor(SoloHarmonizerVst &, MidiFileOwner &);
   ~SoloHarmonizerEditor() override;
@@ -26,12 +27,16 @@ public:
   void resized() override;
 
   void updateTimeInCrotchets(float);
+  // Per-stage timings and CPU load of the audio processing.
+  void updateProcessingStats(const ProcessingStats::Summary &);
   void play();
 
 private:
   // MidiFileOwner::Listener
   void onStateChange() override;
   void onIntervalSpansAvailable(const std::vector<IntervalSpan> &) override;
+  void onMidiFileLoadStarted(const std::filesystem::path &) override;
+  void onMidiFileLoaded(const std::filesystem::path &, bool success) override;
 
   // juce::TextEditor::Listener
   void textEditorReturnKeyPressed(juce::TextEditor &) override;
@@ -63,6 +68,10 @@ private:
   juce::TextEditor _loopBeginBarEditor;
   juce::TextEditor _loopEndBarEditor;
   DisplayComponent _displayComponent;
+  juce::Label _processingStatsLabel;
+#ifdef SAINT_TRACING
+  juce::TextButton _dumpTraceButton;
+#endif
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoloHarmonizerEditor)
 };
@@ -1,6 +1,7 @@
 #include "SoloHarmonizerHelper.h"
 #include "Utils.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <ctime>
@@ -11,14 +12,21 @@
 namespace saint {
 std::filesystem::path getLogDir() {
 #ifdef _WIN32
-  const auto macro = "LOCALAPPDATA";
+  const auto baseDir = utils::getEnvironmentVariable("LOCALAPPDATA");
 #else
-#error please find out
+  // https://specifications.freedesktop.org/basedir-spec/latest/
+  auto baseDir = utils::getEnvironmentVariable("XDG_STATE_HOME");
+  if (baseDir.empty()) {
+    const auto home = utils::getEnvironmentVariable("HOME");
+    if (!home.empty()) {
+      baseDir = std::filesystem::path{home}.append(".local/state").string();
+    }
+  }
 #endif
-  char *buffer = nullptr;
-  size_t size = 0;
-  _dupenv_s(&buffer, &size, macro);
-  return std::filesystem::path{buffer}.append("saint");
+  if (baseDir.empty()) {
+    return std::filesystem::temp_directory_path().append("saint");
+  }
+  return std::filesystem::path{baseDir}.append("saint");
 }
 
 std::filesystem::path generateLogFilename(const std::string &loggerName) {
@@ -33,7 +41,7 @@ std::filesystem::path generateLogFilename(const std::string &loggerName) {
                  [](auto c) { return c == ':' ? '-' : c; });
   auto logDir = getLogDir();
   if (!std::filesystem::exists(logDir)) {
-    std::filesystem::create_directory(logDir);
+    std::filesystem::create_directories(logDir);
   }
   return logDir.append(compatibleFilename + "_" + loggerName + ".log");
 }
@@ -60,4 +68,22 @@ spdlog::level::level_enum getLogLevelFromEnv() {
     return defaultLogLevel;
   }
 }
+
+ShifterEngine getShifterEngineFromEnv() {
+  const auto envEngine = utils::getEnvironmentVariable("SAINT_SHIFTER_ENGINE");
+  if (envEngine == "phasevocoder") {
+    return ShifterEngine::phaseVocoder;
+  } else {
+    return ShifterEngine::rubberBand;
+  }
+}
+
+bool getLoadSheddingFromEnv() {
+  return utils::getEnvironmentVariable("SAINT_LOAD_SHEDDING").empty() ||
+         utils::getEnvironmentVariableAsBool("SAINT_LOAD_SHEDDING");
+}
+
+bool getSessionCaptureFromEnv() {
+  return utils::getEnvironmentVariableAsBool("SAINT_CAPTURE_SESSION");
+}
 } // namespace saint
@@ -4,7 +4,18 @@
 #include <spdlog/common.h>
 
 namespace saint {
+enum class ShifterEngine {
+  rubberBand,
+  // Shares the pitch detector's FFT frames ; see `PhaseVocoderPitchShifter`.
+  phaseVocoder,
+};
+
 std::filesystem::path getLogDir();
 std::filesystem::path generateLogFilename(const std::string &loggerName);
 spdlog::level::level_enum getLogLevelFromEnv();
+ShifterEngine getShifterEngineFromEnv();
+// On unless SAINT_LOAD_SHEDDING is set to something false.
+bool getLoadSheddingFromEnv();
+// Off unless SAINT_CAPTURE_SESSION is set to something true.
+bool getSessionCaptureFromEnv();
 } // namespace saint
@@ -1,24 +1,29 @@
 #include "DefaultMidiFileOwner.h"
+#include "IntervalGetter.h"
 #include "Playheads/ProcessCallbackDrivenPlayhead.h"
+#include "RealtimeSanitizer.h"
 #include "SoloHarmonizer.h"
 #include "SoloHarmonizerTypes.h"
-#include "Utils.h"
 #include "testUtils.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <unordered_map>
 
 namespace saint {
 
+using namespace ::testing;
 namespace fs = std::filesystem;
 
 constexpr auto blockSize = 512;
 constexpr auto sampleRate = 44100;
-const fs::path basePath{"C:/Users/saint/Downloads"};
+const fs::path basePath{testUtils::getOutDir()};
 
 void prependDelay(std::vector<float> &vector) {
   constexpr auto delayMs =
@@ -49,9 +54,7 @@ TEST(SoloHarmonizerTest, Les_Petits_Poissons) {
   factory->setMidiFile(fs::absolute("./saint/_assets/Les_Petits_Poissons.mid"));
   factory->setPlayedTrack(1);
   factory->setHarmonyTrack(2);
-  ProcessCallbackDrivenPlayhead playhead{
-      sampleRate, utils::getCrotchetsPerSample(
-                      *factory->getCrotchetsPerSecond(), sampleRate)};
+  ProcessCallbackDrivenPlayhead playhead{sampleRate, factory->getTempoMap()};
   SoloHarmonizer sut{factory, playhead};
   sut.prepareToPlay(sampleRate, blockSize);
   for (auto offset = 0; offset + blockSize < static_cast<int>(wav.size());
@@ -63,4 +66,204 @@ TEST(SoloHarmonizerTest, Les_Petits_Poissons) {
       wav.data(), wav.size(),
       fs::path{basePath}.append("Les_Petits_Poissons_harmonized.wav"));
 }
+
+TEST(SoloHarmonizerTest, processes_blocks_larger_than_the_detector_takes) {
+  // As hosts may give when bouncing.
+  constexpr auto largeBlockSize = 3 * PitchDetector::maxBlockSize + 100;
+  auto wav = testUtils::fromWavFile(
+      fs::absolute("./saint/_assets/Les_Petits_Poissons.wav"));
+  const auto factory = std::make_shared<DefaultMidiFileOwner>(
+      [](float) {}, [](PlayheadCommand) { return false; });
+  factory->setSampleRate(sampleRate);
+  factory->setMidiFile(fs::absolute("./saint/_assets/Les_Petits_Poissons.mid"));
+  factory->setPlayedTrack(1);
+  factory->setHarmonyTrack(2);
+  ProcessCallbackDrivenPlayhead playhead{sampleRate, factory->getTempoMap()};
+  SoloHarmonizer sut{factory, playhead};
+  sut.prepareToPlay(sampleRate, largeBlockSize,
+                    DavidCNAntonia::ProcessingMode::offline);
+  for (auto offset = 0;
+       offset + largeBlockSize < static_cast<int>(wav.size());
+       offset += largeBlockSize) {
+    sut.processBlock(wav.data() + offset, largeBlockSize);
+    playhead.incrementSampleCount(largeBlockSize);
+  }
+  EXPECT_TRUE(std::all_of(wav.begin(), wav.end(),
+                          [](float x) { return std::isfinite(x); }));
+}
+
+namespace {
+// Tells which times it was asked about.
+class SpyIntervalGetter : public IntervalGetter {
+public:
+  std::optional<float> getHarmoInterval(float timeInCrotchets,
+                                        const std::optional<float> &,
+                                        int) override {
+    times.push_back(timeInCrotchets);
+    return std::nullopt;
+  }
+  void reset() override { ++numResets; }
+  bool hasHarmonyBetween(float, float) const override { return true; }
+
+  std::vector<float> times;
+  int numResets = 0;
+};
+
+class SpiedMidiFileOwner : public DefaultMidiFileOwner {
+public:
+  SpiedMidiFileOwner()
+      : DefaultMidiFileOwner([](float) {},
+                             [](PlayheadCommand) { return false; }) {}
+  IntervalGetter *getAudioThreadIntervalGetter() const override {
+    return &spy;
+  }
+  mutable SpyIntervalGetter spy;
+};
+} // namespace
+
+TEST(SoloHarmonizerTest, times_the_parts_of_large_blocks_at_the_score_tempo) {
+  constexpr auto largeBlockSize = 20000;
+  constexpr auto crotchetsPerSecond = 2.; // 120 bpm
+  const auto owner = std::make_shared<SpiedMidiFileOwner>();
+  ProcessCallbackDrivenPlayhead playhead{
+      sampleRate, std::make_shared<TempoMap>(std::vector<TempoMap::TempoChange>{
+                      {0., crotchetsPerSecond}})};
+  SoloHarmonizer sut{owner, playhead};
+  sut.prepareToPlay(sampleRate, largeBlockSize,
+                    DavidCNAntonia::ProcessingMode::offline);
+  std::vector<float> block(largeBlockSize);
+  std::vector<float> expectedTimes;
+  for (auto blockIndex = 0; blockIndex < 3; ++blockIndex) {
+    // Not silent, for the shifter to be used.
+    for (auto i = 0; i < largeBlockSize; ++i) {
+      block[i] = 0.5f * std::sin(0.05f * (blockIndex * largeBlockSize + i));
+    }
+    for (auto begin = 0; begin < largeBlockSize;
+         begin += PitchDetector::maxBlockSize) {
+      expectedTimes.push_back(static_cast<float>(
+          (blockIndex * largeBlockSize + begin) * crotchetsPerSecond /
+          sampleRate));
+    }
+    sut.processBlock(block.data(), largeBlockSize);
+    playhead.incrementSampleCount(largeBlockSize);
+  }
+  EXPECT_THAT(owner->spy.numResets, Eq(0));
+  EXPECT_THAT(owner->spy.times, Pointwise(FloatNear(1e-4f), expectedTimes));
+}
+
+namespace {
+// A transport that can be stopped.
+class StoppablePlayhead : public Playhead {
+public:
+  std::optional<float> incrementSampleCount(int numSamples) override {
+    if (isPlaying) {
+      _timeInCrotchets += numSamples * crotchetsPerSample;
+    }
+    return getTimeInCrotchets();
+  }
+  std::optional<float> getTimeInCrotchets() override {
+    return getTimeInCrotchetsAt(0);
+  }
+  std::optional<float> getTimeInCrotchetsAt(int sampleOffset) override {
+    return isPlaying ? std::make_optional(_timeInCrotchets +
+                                          sampleOffset * crotchetsPerSample)
+                     : std::nullopt;
+  }
+
+  static constexpr auto crotchetsPerSample = 2.f / sampleRate;
+  bool isPlaying = true;
+
+private:
+  float _timeInCrotchets = 0.f;
+};
+
+void setEnvironmentVariable(const char *name, const char *value) {
+#ifdef _WIN32
+  _putenv_s(name, value);
+#else
+  setenv(name, value, 1);
+#endif
+}
+} // namespace
+
+TEST(SoloHarmonizerTest,
+     phase_vocoder_keeps_up_when_transport_stops_while_bypass_holds) {
+  setEnvironmentVariable("SAINT_SHIFTER_ENGINE", "phasevocoder");
+  const auto owner = std::make_shared<SpiedMidiFileOwner>();
+  StoppablePlayhead playhead;
+  SoloHarmonizer sut{owner, playhead};
+  sut.prepareToPlay(sampleRate, blockSize);
+  setEnvironmentVariable("SAINT_SHIFTER_ENGINE", "");
+  std::vector<float> block(blockSize);
+  // Long enough for the shifter to be active when the transport stops, and
+  // for the bypass to still hold it past its latency after that.
+  for (auto blockIndex = 0; blockIndex < 40; ++blockIndex) {
+    playhead.isPlaying = blockIndex < 20;
+    for (auto i = 0; i < blockSize; ++i) {
+      block[i] = 0.5f * std::sin(0.05f * (blockIndex * blockSize + i));
+    }
+    sut.processBlock(block.data(), blockSize);
+    playhead.incrementSampleCount(blockSize);
+  }
+  EXPECT_THAT(sut.getProcessingStats().getSummary().numShifterBufferFailures,
+              Eq(0));
+}
+
+#ifdef SAINT_RT_SANITIZER
+TEST(SoloHarmonizerTest, processBlock_is_realtime_safe) {
+  auto wav = testUtils::fromWavFile(
+      fs::absolute("./saint/_assets/Les_Petits_Poissons.wav"));
+  const auto factory = std::make_shared<DefaultMidiFileOwner>(
+      [](float) {}, [](PlayheadCommand) { return false; });
+  factory->setSampleRate(sampleRate);
+  factory->setMidiFile(fs::absolute("./saint/_assets/Les_Petits_Poissons.mid"));
+  factory->setPlayedTrack(1);
+  factory->setHarmonyTrack(2);
+  ProcessCallbackDrivenPlayhead playhead{sampleRate, factory->getTempoMap()};
+  SoloHarmonizer sut{factory, playhead};
+  sut.prepareToPlay(sampleRate, blockSize);
+  const auto numViolationsBefore = realtimeSanitizer::getNumViolations();
+  for (auto offset = 0; offset + blockSize < static_cast<int>(wav.size());
+       offset += blockSize) {
+    const ScopedRealtimeContext realtimeContext;
+    sut.processBlock(wav.data() + offset, blockSize);
+    playhead.incrementSampleCount(blockSize);
+  }
+  // Violations are printed on stderr with a stack trace.
+  EXPECT_EQ(realtimeSanitizer::getNumViolations(), numViolationsBefore);
+}
+
+TEST(SoloHarmonizerTest, switching_processing_mode_is_realtime_safe) {
+  auto wav = testUtils::fromWavFile(
+      fs::absolute("./saint/_assets/Les_Petits_Poissons.wav"));
+  const auto factory = std::make_shared<DefaultMidiFileOwner>(
+      [](float) {}, [](PlayheadCommand) { return false; });
+  factory->setSampleRate(sampleRate);
+  factory->setMidiFile(fs::absolute("./saint/_assets/Les_Petits_Poissons.mid"));
+  factory->setPlayedTrack(1);
+  factory->setHarmonyTrack(2);
+  ProcessCallbackDrivenPlayhead playhead{sampleRate, factory->getTempoMap()};
+  SoloHarmonizer sut{factory, playhead};
+  sut.prepareToPlay(sampleRate, blockSize);
+  const auto realtimeLatency = sut.getLatency();
+  const auto numViolationsBefore = realtimeSanitizer::getNumViolations();
+  auto blockIndex = 0;
+  for (auto offset = 0; offset + blockSize < static_cast<int>(wav.size());
+       offset += blockSize) {
+    const ScopedRealtimeContext realtimeContext;
+    // Back and forth, as a host bouncing a few times.
+    if (blockIndex++ % 200 == 100) {
+      sut.setProcessingMode(sut.getProcessingMode() ==
+                                    DavidCNAntonia::ProcessingMode::realtime
+                                ? DavidCNAntonia::ProcessingMode::offline
+                                : DavidCNAntonia::ProcessingMode::realtime);
+    }
+    sut.processBlock(wav.data() + offset, blockSize);
+    playhead.incrementSampleCount(blockSize);
+  }
+  EXPECT_EQ(realtimeSanitizer::getNumViolations(), numViolationsBefore);
+  sut.setProcessingMode(DavidCNAntonia::ProcessingMode::offline);
+  EXPECT_NE(sut.getLatency(), realtimeLatency);
+}
+#endif
 } // namespace saint
@@ -9,12 +9,13 @@ namespace saint {
 class JuceAudioPlayHeadProvider;
 class Playhead;
 class SoloHarmonizerEditor;
+class TempoMap;
 
 enum class TrackType { played, harmony, _size };
 
 using PlayheadFactory = std::function<std::shared_ptr<Playhead>(
     bool mustSetPpqPosition, const JuceAudioPlayHeadProvider &playheadProvider,
-    const std::optional<float> &crotchetsPerSecond,
+    std::shared_ptr<const TempoMap> tempoMap,
     const std::optional<int> &samplesPerSecond)>;
 
 constexpr auto numTrackTypes = static_cast<size_t>(TrackType::_size);
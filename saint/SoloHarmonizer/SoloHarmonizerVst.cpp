@@ -3,9 +3,12 @@
 #include "Playheads/HostDrivenPlayhead.h"
 #include "Playheads/ProcessCallbackDrivenPlayhead.h"
 #include "PositionGetter.h"
+#include "RealtimeSanitizer.h"
 #include "SoloHarmonizerEditor.h"
-#include "Utils.h"
+#include "SoloHarmonizerHelper.h"
+#include "Tracing.h"
 
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -23,23 +26,40 @@ SoloHarmonizerVst::SoloHarmonizerVst(PlayheadFactory factory)
               .withOutput("Output", juce::AudioChannelSet::mono(), true)),
       isStandalone(wrapperType == juce::AudioProcessor::wrapperType_Standalone),
       _midiFileOwner(std::make_shared<DefaultMidiFileOwner>(
-          std::bind(&SoloHarmonizerVst::_onCrotchetsPerSecondAvailable, this,
-                    _1),
-          std::bind(&SoloHarmonizerVst::_onPlayheadCommand, this, _1))),
+          [](float) {},
+          std::bind(&SoloHarmonizerVst::_onPlayheadCommand, this, _1),
+          [](std::function<void()> f) {
+            juce::MessageManager::getInstance()->callAsync(std::move(f));
+          })),
       _soloHarmonizer(std::make_unique<SoloHarmonizer>(_midiFileOwner, *this)),
       _playheadFactory(std::move(factory)),
       _editorCallThread(
           std::bind(&SoloHarmonizerVst::_editorCallThreadFun, this)) {
   _midiFileOwner->addStateChangeListener(this);
+  if (getSessionCaptureFromEnv()) {
+    auto path = generateLogFilename("capture");
+    path.replace_extension(".saintcap");
+    _sessionRecorder = std::make_unique<SessionRecorder>(path);
+    if (!_sessionRecorder->isOpen()) {
+      _sessionRecorder.reset();
+    }
+  }
 }
 
 SoloHarmonizerVst::~SoloHarmonizerVst() {
   _runEditorCallThread = false;
   _editorCallThread.join();
+  cancelPendingUpdate();
 }
 
 void SoloHarmonizerVst::_editorCallThreadFun() {
+  // Every half second, enough for percentiles to mean something.
+  constexpr auto processingStatsPeriod = 20;
+  auto numIterations = 0;
+  tracing::setThreadName("editor calls");
   while (_runEditorCallThread) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{25});
+    SAINT_TRACE_ZONE("SoloHarmonizerVst::_editorCallThreadFun");
     const auto time = getTimeInCrotchets();
     if (time.has_value()) {
       std::lock_guard<std::mutex> lock(_editorMutex);
@@ -47,7 +67,19 @@ void SoloHarmonizerVst::_editorCallThreadFun() {
         editor->updateTimeInCrotchets(*time);
       }
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds{25});
+    if (_processingModeChanged.exchange(false)) {
+      triggerAsyncUpdate();
+    }
+    if (++numIterations % processingStatsPeriod == 0) {
+      std::lock_guard<std::mutex> lock(_editorMutex);
+      if (!_editors.empty()) {
+        // This thread is the only reader of the stats.
+        const auto summary = _soloHarmonizer->getProcessingStats().getSummary();
+        for (auto editor : _editors) {
+          editor->updateProcessingStats(summary);
+        }
+      }
+    }
   }
 }
 
@@ -58,7 +90,14 @@ const juce::String SoloHarmonizerVst::getName() const {
 void SoloHarmonizerVst::prepareToPlay(double sampleRate, int samplesPerBlock) {
   _samplesPerSecond = static_cast<int>(sampleRate);
   _midiFileOwner->setSampleRate(*_samplesPerSecond);
-  _soloHarmonizer->prepareToPlay(*_samplesPerSecond, samplesPerBlock);
+  _soloHarmonizer->prepareToPlay(*_samplesPerSecond, samplesPerBlock,
+                                 _getProcessingMode());
+  setLatencySamples(_soloHarmonizer->getLatency());
+  if (_sessionRecorder) {
+    _recordScore();
+    _sessionRecorder->recordPrepare(
+        {*_samplesPerSecond, samplesPerBlock, _getProcessingMode()});
+  }
   if (!isStandalone) {
     _startPlaying();
   }
@@ -76,12 +115,51 @@ bool SoloHarmonizerVst::isBusesLayoutSupported(const BusesLayout &) const {
 
 void SoloHarmonizerVst::processBlock(juce::AudioBuffer<float> &buffer,
                                      juce::MidiBuffer &) {
+  const ScopedRealtimeContext realtimeContext;
+  SAINT_TRACE_THREAD_NAME("audio");
+  SAINT_TRACE_ZONE("SoloHarmonizerVst::processBlock");
+  if (_samplesPerSecond.has_value() &&
+      _getProcessingMode() != _soloHarmonizer->getProcessingMode()) {
+    // Hosts normally call prepareToPlay after switching to or from offline
+    // rendering, but not all do. Telling the host about the new latency isn't
+    // for this thread.
+    _soloHarmonizer->setProcessingMode(_getProcessingMode());
+    _processingModeChanged = true;
+  }
   const auto playhead = _playhead;
   const auto numSamples = buffer.getNumSamples();
   if (playhead) {
+    const auto loop = _loopCrotchets.load();
+    const auto handlesLoop = playhead->setLoop(loop.begin, loop.end);
+    // Where this block starts, in case the loop just changed or the host
+    // moved. For a host-driven playhead, this is the one query of the host
+    // this block.
+    _timeInCrotchets = playhead->getTimeInCrotchets();
+    _playheadHandlesLoop = handlesLoop;
     const auto p = buffer.getWritePointer(0);
+    if (_sessionRecorder) {
+      // What `_soloHarmonizer` is about to get.
+      std::array<Jump, SessionRecorder::maxJumpsPerBlock> jumps;
+      auto numJumps = 0;
+      auto from = 0;
+      while (numJumps < static_cast<int>(jumps.size()) && from < numSamples) {
+        const auto jump = getJump(from, numSamples - from);
+        if (!jump.has_value()) {
+          break;
+        }
+        jumps[numJumps++] = *jump;
+        from = jump->numSamplesBefore + 1;
+      }
+      _sessionRecorder->recordBlock(p, numSamples,
+                                    _soloHarmonizer->getProcessingMode(),
+                                    getTimeInCrotchets(), jumps.data(),
+                                    numJumps);
+    }
     // Calls SoloHarmonizerVst::getTimeInCrotchets()
     _soloHarmonizer->processBlock(p, numSamples);
+    if (_sessionRecorder) {
+      _sessionRecorder->finishBlock();
+    }
     playhead->mixMetronome(p, numSamples);
     _timeInCrotchets = playhead->incrementSampleCount(numSamples);
   }
@@ -97,41 +175,86 @@ std::optional<float> SoloHarmonizerVst::incrementSampleCount(int) {
 }
 
 std::optional<float> SoloHarmonizerVst::getTimeInCrotchets() {
-  const auto t = _timeInCrotchets.load();
-  if (!t.has_value() || !_midiFileOwner->hasPositionGetter()) {
-    return std::nullopt;
+  return _toLoopTime(_timeInCrotchets.load());
+}
+
+std::optional<float> SoloHarmonizerVst::getTimeInCrotchetsAt(int sampleOffset) {
+  const auto playhead = _playhead;
+  const auto t = _toLoopTime(
+      playhead ? playhead->getTimeInCrotchetsAt(sampleOffset) : std::nullopt);
+  if (_sessionRecorder) {
+    _sessionRecorder->recordPartTime({sampleOffset, t});
   }
-  const auto positionGetter = _midiFileOwner->getPositionGetter();
-  if (!positionGetter) {
+  return t;
+}
+
+std::optional<float>
+SoloHarmonizerVst::_toLoopTime(const std::optional<float> &t) const {
+  if (!t.has_value() || !_midiFileOwner->hasPositionGetter()) {
     return std::nullopt;
   }
-  const auto loopBeginBar = _loopBeginBar.load().value_or(1);
-  const auto loopEndBar = _loopEndBar.load();
-  if (!loopEndBar.has_value() || *loopEndBar <= loopBeginBar) {
+  const auto loop = _loopCrotchets.load();
+  const auto loopDuration = loop.end - loop.begin;
+  if (_playheadHandlesLoop || loopDuration <= 0.f) {
     return *t;
   } else {
-    const auto loopBeginCrotchet =
-        positionGetter->getBarTimeInCrotchets(loopBeginBar - 1);
-    const auto loopEndCrotchet =
-        positionGetter->getBarTimeInCrotchets(*loopEndBar - 1);
-    const auto loopDuration = loopEndCrotchet - loopBeginCrotchet;
     const auto numLoopsElapsed = static_cast<int>(*t / loopDuration);
     const auto offsetInLoop =
         *t - static_cast<float>(numLoopsElapsed) * loopDuration;
-    return loopBeginCrotchet + offsetInLoop;
+    return loop.begin + offsetInLoop;
   }
 }
 
+std::optional<Playhead::Jump> SoloHarmonizerVst::getJump(int fromSample,
+                                                        int numSamples) {
+  const auto playhead = _playhead;
+  return playhead ? playhead->getJump(fromSample, numSamples) : std::nullopt;
+}
+
+void SoloHarmonizerVst::handleAsyncUpdate() {
+  // The processing mode changed without `prepareToPlay` being called.
+  // Session captures have it with the blocks already.
+  setLatencySamples(_soloHarmonizer->getLatency());
+}
+
 juce::AudioPlayHead *SoloHarmonizerVst::getJuceAudioPlayHead() const {
   return getPlayHead();
 }
 
+void SoloHarmonizerVst::onStateChange() {
+  // Bars may have moved with the file.
+  _updateLoopCrotchets();
+  if (_sessionRecorder) {
+    _recordScore();
+  }
+}
+
+void SoloHarmonizerVst::_recordScore() {
+  _sessionRecorder->recordScore({_midiFileOwner->getMidiFile().value_or(""),
+                                 _midiFileOwner->getPlayedTrack(),
+                                 _midiFileOwner->getHarmonyTrack()});
+}
+
 void SoloHarmonizerVst::onLoopBeginBarChange(const std::optional<int> &bar) {
   _loopBeginBar = bar;
+  _updateLoopCrotchets();
 }
 
 void SoloHarmonizerVst::onLoopEndBarChange(const std::optional<int> &bar) {
   _loopEndBar = bar;
+  _updateLoopCrotchets();
+}
+
+void SoloHarmonizerVst::_updateLoopCrotchets() {
+  const auto positionGetter = _midiFileOwner->getPositionGetter();
+  const auto loopBeginBar = _loopBeginBar.value_or(1);
+  LoopCrotchets loop;
+  if (positionGetter && _loopEndBar.has_value() &&
+      *_loopEndBar > loopBeginBar) {
+    loop.begin = positionGetter->getBarTimeInCrotchets(loopBeginBar - 1);
+    loop.end = positionGetter->getBarTimeInCrotchets(*_loopEndBar - 1);
+  }
+  _loopCrotchets = loop;
 }
 
 SoloHarmonizerEditor *SoloHarmonizerVst::createSoloHarmonizerEditor() {
@@ -165,11 +288,6 @@ void SoloHarmonizerVst::setStateInformation(const void *data, int size) {
       static_cast<const char *>(data), static_cast<const char *>(data) + size});
 }
 
-void SoloHarmonizerVst::_onCrotchetsPerSecondAvailable(
-    float crotchetsPerSecond) {
-  _crotchetsPerSecond = crotchetsPerSecond;
-}
-
 bool SoloHarmonizerVst::_onPlayheadCommand(PlayheadCommand command) {
   switch (command) {
   case PlayheadCommand::play:
@@ -183,9 +301,15 @@ bool SoloHarmonizerVst::_onPlayheadCommand(PlayheadCommand command) {
   }
 }
 
+DavidCNAntonia::ProcessingMode SoloHarmonizerVst::_getProcessingMode() const {
+  return isNonRealtime() ? DavidCNAntonia::ProcessingMode::offline
+                         : DavidCNAntonia::ProcessingMode::realtime;
+}
+
 bool SoloHarmonizerVst::_startPlaying() {
-  _playhead = _playheadFactory(isStandalone, *this, _crotchetsPerSecond,
-                               _samplesPerSecond);
+  _playhead =
+      _playheadFactory(isStandalone, *this, _midiFileOwner->getTempoMap(),
+                       _samplesPerSecond);
   return _playhead != nullptr;
 }
 
@@ -200,19 +324,21 @@ juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter() {
   using namespace saint;
   PlayheadFactory factory{[](bool mustSetPpqPosition,
                              const JuceAudioPlayHeadProvider &playheadProvider,
-                             const std::optional<float> &crotchetsPerSecond,
+                             std::shared_ptr<const TempoMap> tempoMap,
                              const std::optional<int> &samplesPerSecond)
                               -> std::shared_ptr<Playhead> {
+    if (!samplesPerSecond.has_value()) {
+      return nullptr;
+    }
     if (mustSetPpqPosition) {
-      if (!crotchetsPerSecond.has_value() || !samplesPerSecond.has_value()) {
+      if (!tempoMap) {
         return nullptr;
       }
-      const auto crotchetsPerSample =
-          utils::getCrotchetsPerSample(*crotchetsPerSecond, *samplesPerSecond);
       return std::make_shared<ProcessCallbackDrivenPlayhead>(
-          *samplesPerSecond, crotchetsPerSample);
+          *samplesPerSecond, std::move(tempoMap));
     } else {
-      return std::make_shared<HostDrivenPlayhead>(playheadProvider);
+      return std::make_shared<HostDrivenPlayhead>(playheadProvider,
+                                                  *samplesPerSecond);
     }
   }};
   return new SoloHarmonizerVst(std::move(factory));
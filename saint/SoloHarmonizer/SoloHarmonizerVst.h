@@ -3,6 +3,7 @@
 #include "JuceAudioPlayHeadProvider.h"
 #include "MidiFileOwner.h"
 #include "Playhead.h"
+#include "SessionCapture.h"
 #include "SoloHarmonizer.h"
 #include "SoloHarmonizerTypes.h"
 
@@ -21,7 +22,8 @@ namespace saint {
 class SoloHarmonizerVst : public juce::AudioProcessor,
                           public Playhead,
                           public MidiFileOwner::Listener,
-                          JuceAudioPlayHeadProvider {
+                          JuceAudioPlayHeadProvider,
+                          juce::AsyncUpdater {
 public:
   SoloHarmonizerVst(PlayheadFactory);
   ~SoloHarmonizerVst() override;
@@ -37,15 +39,21 @@ public:
   // Playhead
   std::optional<float> incrementSampleCount(int) override;
   std::optional<float> getTimeInCrotchets() override;
+  std::optional<float> getTimeInCrotchetsAt(int sampleOffset) override;
+  std::optional<Jump> getJump(int fromSample, int numSamples) override;
 
   // JuceAudioPlayHeadProvider
   juce::AudioPlayHead *getJuceAudioPlayHead() const override;
 
 private:
   // MidiFileOwner::Listener
+  void onStateChange() override;
   void onLoopBeginBarChange(const std::optional<int> &) override;
   void onLoopEndBarChange(const std::optional<int> &) override;
 
+  // juce::AsyncUpdater
+  void handleAsyncUpdate() override;
+
   juce::AudioProcessorEditor *createEditor() override;
   void releaseResources() override;
   bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
@@ -71,15 +79,34 @@ private:
   void setStateInformation(const void *data, int sizeInBytes) override;
 
 private:
-  void _onCrotchetsPerSecondAvailable(float);
+  // Where the time loops back from and to. `begin` and `end` are equal if it
+  // doesn't.
+  struct LoopCrotchets {
+    float begin = 0.f;
+    float end = 0.f;
+  };
+
   bool _onPlayheadCommand(PlayheadCommand);
+  DavidCNAntonia::ProcessingMode _getProcessingMode() const;
   bool _startPlaying();
   bool _stopPlaying();
   void _editorCallThreadFun();
+  void _recordScore();
+  void _updateLoopCrotchets();
+  // Within the loop, if the playhead doesn't handle it. Nullopt without a
+  // score.
+  std::optional<float> _toLoopTime(const std::optional<float> &) const;
   std::atomic<std::optional<float>> _timeInCrotchets;
-  std::atomic<std::optional<int>> _loopBeginBar;
-  std::atomic<std::optional<int>> _loopEndBar;
-  std::optional<float> _crotchetsPerSecond;
+  std::optional<int> _loopBeginBar;
+  std::optional<int> _loopEndBar;
+  // Computed when the loop or the file changes rather than by the audio
+  // thread, and published whole.
+  std::atomic<LoopCrotchets> _loopCrotchets;
+  // If so, `_timeInCrotchets` already is within the loop, if any.
+  std::atomic<bool> _playheadHandlesLoop = false;
+  // Set by the audio thread, for the editor call thread to have the message
+  // thread follow up, the audio thread being no place to trigger that.
+  std::atomic<bool> _processingModeChanged = false;
   std::optional<int> _samplesPerSecond;
   const std::shared_ptr<MidiFileOwner> _midiFileOwner;
   const std::unique_ptr<SoloHarmonizer> _soloHarmonizer;
@@ -89,6 +116,8 @@ private:
   std::thread _editorCallThread;
   bool _runEditorCallThread = true;
   std::mutex _editorMutex;
+  // Only with SAINT_CAPTURE_SESSION.
+  std::unique_ptr<SessionRecorder> _sessionRecorder;
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoloHarmonizerVst)
 };
 } // namespace saint
@@ -2,7 +2,6 @@
 #include "Playhead.h"
 #include "Playheads/ProcessCallbackDrivenPlayhead.h"
 #include "SoloHarmonizerEditor.h"
-#include "Utils.h"
 
 #include <gmock/gmock.h>
 
@@ -34,16 +33,15 @@ TestAppMainWindow::TestAppMainWindow(juce::String name)
       _openEditorButton("Open Editor"),
       _harmonizerVst([](bool mustSetPpqPosition,
                         const JuceAudioPlayHeadProvider &,
-                        const std::optional<float> &crotchetsPerSecond,
+                        std::shared_ptr<const TempoMap> tempoMap,
                         const std::optional<int> &samplesPerSecond)
                          -> std::shared_ptr<Playhead> {
         assert(mustSetPpqPosition);
-        if (!samplesPerSecond.has_value() || !crotchetsPerSecond.has_value()) {
+        if (!samplesPerSecond.has_value() || !tempoMap) {
           return nullptr;
         }
         return std::shared_ptr<Playhead>{new ProcessCallbackDrivenPlayhead(
-            *samplesPerSecond, utils::getCrotchetsPerSample(
-                                   *crotchetsPerSecond, *samplesPerSecond))};
+            *samplesPerSecond, std::move(tempoMap))};
       }),
       _filePlaybackComponent(
           std::bind(&TestAppMainWindow::_prepareToPlay, this, _1, _2),
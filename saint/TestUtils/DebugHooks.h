@@ -0,0 +1,24 @@
+#pragma once
+
+// Debug hooks let the pitch detector and the interval getter hand their
+// internals to a sink (typically writing WAV files for inspection). They are
+// compiled in by configuring with SAINT_DEBUG_HOOKS (always the case in Debug
+// builds), and to nothing otherwise, arguments included.
+//
+// Usage:
+//   SAINT_DEBUG_HOOK(_debugSink, onSomething(a, b));
+//
+// calls `_debugSink->onSomething(a, b)` if `_debugSink` is set. Members only
+// the hooks use should be declared within `#ifdef SAINT_DEBUG_HOOKS`.
+#ifdef SAINT_DEBUG_HOOKS
+#define SAINT_DEBUG_HOOK(sink, ...)                                            \
+  do {                                                                         \
+    if (sink) {                                                                \
+      (sink)->__VA_ARGS__;                                                     \
+    }                                                                          \
+  } while (false)
+#else
+#define SAINT_DEBUG_HOOK(sink, ...)                                            \
+  do {                                                                         \
+  } while (false)
+#endif
@@ -0,0 +1,216 @@
+#include "DiagnosticsTrace.h"
+#include "testUtils.h"
+
+#include <juce_core/juce_core.h>
+
+#include <chrono>
+#include <string>
+
+namespace saint {
+namespace testUtils {
+namespace fs = std::filesystem;
+using namespace diagnostics;
+
+namespace {
+constexpr char magic[] = {'S', 'A', 'I', 'N', 'T', 'D', 'G', 'N'};
+constexpr std::uint32_t chunkMagic = 0x4b4e4843; // "CHNK"
+constexpr auto pollPeriod = std::chrono::milliseconds{10};
+
+constexpr std::size_t alignTo8(std::size_t size) { return (size + 7) & ~7u; }
+} // namespace
+
+DiagnosticsTraceWriter::Channel::Channel(std::uint16_t source)
+    : _source(source), _record(maxRecordSize) {}
+
+void DiagnosticsTraceWriter::Channel::_write(RecordType type,
+                                             std::int64_t samplePosition,
+                                             const void *payload,
+                                             std::size_t payloadSize,
+                                             const float *values,
+                                             int numValues) {
+  const auto valuesSize = static_cast<std::size_t>(numValues) * sizeof(float);
+  const auto numBytes = alignTo8(payloadSize + valuesSize);
+  const auto size = sizeof(RecordHeader) + numBytes;
+  if (size > _record.size() || _ring.writeAvailable() < size) {
+    _numDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const RecordHeader header{type, _source, static_cast<std::uint32_t>(numBytes),
+                            samplePosition};
+  auto p = _record.data();
+  std::memcpy(p, &header, sizeof(header));
+  p += sizeof(header);
+  std::memcpy(p, payload, payloadSize);
+  p += payloadSize;
+  if (valuesSize > 0) {
+    std::memcpy(p, values, valuesSize);
+    p += valuesSize;
+  }
+  std::fill(p, _record.data() + size, '\0');
+  // All at once, so that the writer never sees part of a record.
+  _ring.writeBuff(_record.data(), size);
+}
+
+DiagnosticsTraceWriter::DiagnosticsTraceWriter(const fs::path &path)
+    : _file(path, std::ios::binary), _payload(Channel::maxRecordSize) {
+  FileHeader header{};
+  std::copy(std::begin(magic), std::end(magic), header.magic);
+  header.version = formatVersion;
+  _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  _chunk.reserve(chunkSize + Channel::maxRecordSize);
+  _thread = std::thread{[this] { _run(); }};
+}
+
+DiagnosticsTraceWriter::~DiagnosticsTraceWriter() {
+  _isRunning = false;
+  _thread.join();
+  _drain();
+  _writeChunk();
+}
+
+bool DiagnosticsTraceWriter::isOpen() const { return _file.good(); }
+
+DiagnosticsTraceWriter::Channel &DiagnosticsTraceWriter::addChannel() {
+  std::lock_guard<std::mutex> lock{_channelsMutex};
+  const auto source = static_cast<std::uint16_t>(_channels.size());
+  _channels.emplace_back(new Channel(source));
+  return *_channels.back();
+}
+
+void DiagnosticsTraceWriter::_run() {
+  while (_isRunning) {
+    _drain();
+    // Chunks are written at least this often, so that a trace is of use even
+    // if the process doesn't end well.
+    _writeChunk();
+    std::this_thread::sleep_for(pollPeriod);
+  }
+}
+
+void DiagnosticsTraceWriter::_drain() {
+  std::lock_guard<std::mutex> lock{_channelsMutex};
+  for (auto &channel : _channels) {
+    auto &ring = channel->_ring;
+    RecordHeader header;
+    while (ring.readAvailable() >= sizeof(header)) {
+      ring.readBuff(reinterpret_cast<char *>(&header), sizeof(header));
+      ring.readBuff(_payload.data(), header.numBytes);
+      _append(header, _payload.data());
+    }
+    const auto numDropped = channel->_numDropped.load();
+    if (numDropped != channel->_numDroppedWritten) {
+      const Dropped dropped{numDropped - channel->_numDroppedWritten, 0u};
+      _append({RecordType::dropped, channel->_source, sizeof(dropped), -1},
+              reinterpret_cast<const char *>(&dropped));
+      channel->_numDroppedWritten = numDropped;
+    }
+  }
+}
+
+void DiagnosticsTraceWriter::_append(const RecordHeader &header,
+                                     const char *payload) {
+  if (_chunk.size() + sizeof(header) + header.numBytes > chunkSize) {
+    _writeChunk();
+  }
+  const auto p = reinterpret_cast<const char *>(&header);
+  _chunk.insert(_chunk.end(), p, p + sizeof(header));
+  _chunk.insert(_chunk.end(), payload, payload + header.numBytes);
+  ++_chunkNumRecords;
+}
+
+void DiagnosticsTraceWriter::_writeChunk() {
+  if (_chunk.empty()) {
+    return;
+  }
+  const ChunkHeader header{chunkMagic, _chunkNumRecords, _chunk.size()};
+  _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  _file.write(_chunk.data(), _chunk.size());
+  _file.flush();
+  _chunk.clear();
+  _chunkNumRecords = 0;
+}
+
+std::shared_ptr<DiagnosticsTraceWriter> getDiagnosticsTraceWriter() {
+  static std::mutex mutex;
+  static std::weak_ptr<DiagnosticsTraceWriter> current;
+  std::lock_guard<std::mutex> lock{mutex};
+  if (auto writer = current.lock()) {
+    return writer;
+  }
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+  auto writer = std::make_shared<DiagnosticsTraceWriter>(
+      fs::path{getOutDir()} /
+      ("diagnostics_" + std::to_string(ms) + ".saintdiag"));
+  current = writer;
+  return writer;
+}
+
+DiagnosticsTraceReader::DiagnosticsTraceReader(const fs::path &path)
+    : _file(std::make_unique<juce::MemoryMappedFile>(
+          juce::File{fs::absolute(path).string()},
+          juce::MemoryMappedFile::readOnly)) {
+  _data = static_cast<const char *>(_file->getData());
+  _size = _file->getSize();
+  FileHeader header;
+  if (_data == nullptr || _size < sizeof(header)) {
+    return;
+  }
+  std::memcpy(&header, _data, sizeof(header));
+  _isOpen = std::equal(std::begin(magic), std::end(magic), header.magic) &&
+            header.version == formatVersion;
+  _position = _chunkEnd = sizeof(header);
+}
+
+DiagnosticsTraceReader::~DiagnosticsTraceReader() = default;
+
+bool DiagnosticsTraceReader::isOpen() const { return _isOpen; }
+
+bool DiagnosticsTraceReader::hasError() const { return _hasError; }
+
+bool DiagnosticsTraceReader::isTruncated() const { return _isTruncated; }
+
+std::optional<DiagnosticsTraceReader::Record> DiagnosticsTraceReader::next() {
+  if (!_isOpen || _hasError || _isTruncated) {
+    return std::nullopt;
+  }
+  while (_position == _chunkEnd) {
+    if (_position == _size) {
+      return std::nullopt;
+    }
+    ChunkHeader chunk;
+    if (_size - _position < sizeof(chunk)) {
+      _isTruncated = true;
+      return std::nullopt;
+    }
+    std::memcpy(&chunk, _data + _position, sizeof(chunk));
+    if (chunk.magic != chunkMagic) {
+      _hasError = true;
+      return std::nullopt;
+    }
+    if (chunk.numBytes > _size - _position - sizeof(chunk)) {
+      _isTruncated = true;
+      return std::nullopt;
+    }
+    _position += sizeof(chunk);
+    _chunkEnd = _position + chunk.numBytes;
+  }
+  RecordHeader header;
+  if (_chunkEnd - _position < sizeof(header)) {
+    _hasError = true;
+    return std::nullopt;
+  }
+  std::memcpy(&header, _data + _position, sizeof(header));
+  _position += sizeof(header);
+  if (header.numBytes > _chunkEnd - _position) {
+    _hasError = true;
+    return std::nullopt;
+  }
+  const Record record{header.type, header.source, header.samplePosition,
+                      _data + _position, header.numBytes};
+  _position += header.numBytes;
+  return record;
+}
+} // namespace testUtils
+} // namespace saint
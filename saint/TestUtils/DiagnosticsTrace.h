@@ -0,0 +1,221 @@
+#pragma once
+
+#include <ringbuffer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace juce {
+class MemoryMappedFile;
+}
+
+namespace saint {
+namespace testUtils {
+// Diagnostics of the pitch detector and the interval getter, compact enough
+// to be recorded over long takes.
+// A trace file is a `diagnostics::FileHeader` followed by chunks, each a
+// `ChunkHeader` and `numBytes` of records. A record is a `RecordHeader`
+// followed by `numBytes` of payload. Everything is in native byte order and
+// 8-byte aligned, so that a mapped file can be read in place. A chunk is
+// written whole, so a trace cut short, e.g. by a crash, can still be read up
+// to its last complete chunk.
+namespace diagnostics {
+constexpr std::uint32_t formatVersion = 1;
+
+enum class RecordType : std::uint16_t {
+  // `SpanCrotchets`, followed by float crotchets[numSpans].
+  spanCrotchets = 1,
+  // `Xcorr`, followed by float values[numValues]: the first and last halves
+  // of an analysis frame's autocorrelation, with its peak zeroed.
+  xcorr,
+  pitchAnalysis,
+  detectedPitch,
+  intervalLookup,
+  // Records a channel had to drop because the writer was lagging behind.
+  dropped,
+};
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+struct ChunkHeader {
+  std::uint32_t magic;
+  std::uint32_t numRecords;
+  std::uint64_t numBytes;
+};
+
+struct RecordHeader {
+  RecordType type;
+  // Tells apart records of different pitch detector or interval getter
+  // instances.
+  std::uint16_t source;
+  std::uint32_t numBytes;
+  // Samples since the source started processing, -1 if unknown.
+  std::int64_t samplePosition;
+};
+
+struct SpanCrotchets {
+  float crotchetsPerSample;
+  std::int32_t numSpans;
+};
+
+struct Xcorr {
+  std::int32_t olapAnalIndex;
+  std::int32_t numValues;
+};
+
+struct PitchAnalysis {
+  std::int32_t olapAnalIndex;
+  std::int32_t peakIndex;
+  float scaledMax;
+  float maxMin;
+};
+
+struct DetectedPitch {
+  std::int32_t hasPitch;
+  float pitch;
+};
+
+struct IntervalLookup {
+  float timeInCrotchets;
+  std::int32_t spanIndex;
+  std::int32_t hasInputPitch;
+  float inputPitch;
+  std::int32_t hasInterval;
+  float interval;
+};
+
+struct Dropped {
+  std::uint32_t numRecords;
+  std::uint32_t reserved;
+};
+} // namespace diagnostics
+
+// Streams diagnostics records to a trace file from a background thread. Each
+// producing thread writes to a channel of its own, a wait-free ring, without
+// allocating.
+class DiagnosticsTraceWriter {
+public:
+  class Channel {
+  public:
+    // By the one thread producing this channel's records. A record is dropped
+    // if the writer is lagging behind.
+    template <typename Payload>
+    void write(diagnostics::RecordType type, std::int64_t samplePosition,
+               const Payload &payload, const float *values = nullptr,
+               int numValues = 0) {
+      _write(type, samplePosition, &payload, sizeof(Payload), values,
+             numValues);
+    }
+
+  private:
+    friend class DiagnosticsTraceWriter;
+    static constexpr auto ringSize = 1 << 20;
+    static constexpr auto maxRecordSize = 1 << 18;
+
+    explicit Channel(std::uint16_t source);
+    void _write(diagnostics::RecordType, std::int64_t samplePosition,
+                const void *payload, std::size_t payloadSize,
+                const float *values, int numValues);
+
+    const std::uint16_t _source;
+    jnk0le::Ringbuffer<char, ringSize> _ring;
+    // Producer side.
+    std::vector<char> _record;
+    std::atomic<std::uint32_t> _numDropped = 0;
+    // Writer side.
+    std::uint32_t _numDroppedWritten = 0;
+  };
+
+  explicit DiagnosticsTraceWriter(const std::filesystem::path &);
+  // Writes what's still pending.
+  ~DiagnosticsTraceWriter();
+
+  bool isOpen() const;
+
+  // Not for the processing thread. The channel lives as long as the writer.
+  Channel &addChannel();
+
+private:
+  static constexpr auto chunkSize = 1 << 18;
+
+  void _run();
+  void _drain();
+  void _append(const diagnostics::RecordHeader &, const char *payload);
+  void _writeChunk();
+
+  std::ofstream _file;
+  std::mutex _channelsMutex;
+  std::vector<std::unique_ptr<Channel>> _channels;
+  std::vector<char> _chunk;
+  std::uint32_t _chunkNumRecords = 0;
+  std::vector<char> _payload;
+  std::atomic<bool> _isRunning = true;
+  std::thread _thread;
+};
+
+// The trace the debug sinks write to, in `getOutDir()`. It is shared by the
+// sinks alive at the same time, and a new one is started after they're all
+// gone.
+std::shared_ptr<DiagnosticsTraceWriter> getDiagnosticsTraceWriter();
+
+// Reads a trace in place from a memory-mapped file, one record at a time.
+class DiagnosticsTraceReader {
+public:
+  struct Record {
+    diagnostics::RecordType type;
+    int source;
+    std::int64_t samplePosition;
+    const char *payload;
+    std::size_t numBytes;
+
+    // The fixed-size part of the payload.
+    template <typename Payload> Payload get() const {
+      Payload value{};
+      std::memcpy(&value, payload, std::min(sizeof(Payload), numBytes));
+      return value;
+    }
+
+    // The values following `Payload`, for `spanCrotchets` and `xcorr`
+    // records. Valid as long as the reader.
+    template <typename Payload> const float *getValues() const {
+      return reinterpret_cast<const float *>(payload + sizeof(Payload));
+    }
+  };
+
+  explicit DiagnosticsTraceReader(const std::filesystem::path &);
+  ~DiagnosticsTraceReader();
+
+  // False if the file couldn't be mapped or isn't a trace.
+  bool isOpen() const;
+  // Nullopt at the end of the trace, or if it is corrupt, in which case
+  // `hasError()` is true.
+  std::optional<Record> next();
+  bool hasError() const;
+  // The file ends with an incomplete chunk, which was ignored.
+  bool isTruncated() const;
+
+private:
+  const std::unique_ptr<juce::MemoryMappedFile> _file;
+  const char *_data = nullptr;
+  std::size_t _size = 0;
+  std::size_t _position = 0;
+  std::size_t _chunkEnd = 0;
+  bool _isOpen = false;
+  bool _hasError = false;
+  bool _isTruncated = false;
+};
+} // namespace testUtils
+} // namespace saint
@@ -0,0 +1,93 @@
+#include "DiagnosticsTrace.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace saint {
+namespace testUtils {
+
+using namespace ::testing;
+using namespace diagnostics;
+
+namespace {
+std::filesystem::path getTracePath() {
+  return std::filesystem::temp_directory_path() /
+         "DiagnosticsTraceTests.saintdiag";
+}
+
+std::vector<DiagnosticsTraceReader::Record>
+readAll(DiagnosticsTraceReader &reader) {
+  std::vector<DiagnosticsTraceReader::Record> records;
+  while (const auto record = reader.next()) {
+    records.push_back(*record);
+  }
+  return records;
+}
+} // namespace
+
+TEST(DiagnosticsTrace, reads_back_records_of_each_channel_in_order) {
+  const auto path = getTracePath();
+  const std::vector<float> xcorr{0.f, 0.5f, 1.f};
+  {
+    DiagnosticsTraceWriter sut{path};
+    ASSERT_TRUE(sut.isOpen());
+    auto &detector = sut.addChannel();
+    auto &intervalGetter = sut.addChannel();
+    std::thread producer{[&] {
+      detector.write(RecordType::xcorr, 256, Xcorr{1, 3}, xcorr.data(), 3);
+      detector.write(RecordType::detectedPitch, 0, DetectedPitch{1, 440.f});
+    }};
+    intervalGetter.write(RecordType::intervalLookup, 0,
+                         IntervalLookup{1.5f, 2, 1, 440.f, 0, 0.f});
+    producer.join();
+  }
+  DiagnosticsTraceReader reader{path};
+  ASSERT_TRUE(reader.isOpen());
+  const auto records = readAll(reader);
+  EXPECT_FALSE(reader.hasError());
+  EXPECT_FALSE(reader.isTruncated());
+  ASSERT_THAT(records.size(), Eq(3u));
+
+  std::vector<DiagnosticsTraceReader::Record> detectorRecords;
+  std::copy_if(records.begin(), records.end(),
+               std::back_inserter(detectorRecords),
+               [](const auto &record) { return record.source == 0; });
+  ASSERT_THAT(detectorRecords.size(), Eq(2u));
+  const auto &xcorrRecord = detectorRecords[0];
+  EXPECT_THAT(xcorrRecord.type, Eq(RecordType::xcorr));
+  EXPECT_THAT(xcorrRecord.samplePosition, Eq(256));
+  const auto frame = xcorrRecord.get<Xcorr>();
+  EXPECT_THAT(frame.olapAnalIndex, Eq(1));
+  ASSERT_THAT(frame.numValues, Eq(3));
+  const auto values = xcorrRecord.getValues<Xcorr>();
+  EXPECT_THAT(std::vector<float>(values, values + frame.numValues),
+              ElementsAre(0.f, 0.5f, 1.f));
+  EXPECT_THAT(detectorRecords[1].get<DetectedPitch>().pitch, Eq(440.f));
+
+  const auto lookup =
+      std::find_if(records.begin(), records.end(),
+                   [](const auto &record) { return record.source == 1; });
+  ASSERT_THAT(lookup, Ne(records.end()));
+  EXPECT_THAT(lookup->type, Eq(RecordType::intervalLookup));
+  EXPECT_THAT(lookup->get<IntervalLookup>().spanIndex, Eq(2));
+  EXPECT_THAT(lookup->get<IntervalLookup>().hasInterval, Eq(0));
+}
+
+TEST(DiagnosticsTrace, ignores_an_incomplete_last_chunk) {
+  const auto path = getTracePath();
+  {
+    DiagnosticsTraceWriter sut{path};
+    sut.addChannel().write(RecordType::detectedPitch, 0,
+                           DetectedPitch{0, 0.f});
+  }
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+  DiagnosticsTraceReader reader{path};
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_THAT(readAll(reader), IsEmpty());
+  EXPECT_TRUE(reader.isTruncated());
+  EXPECT_FALSE(reader.hasError());
+}
+} // namespace testUtils
+} // namespace saint
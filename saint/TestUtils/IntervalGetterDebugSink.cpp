@@ -0,0 +1,46 @@
+#include "IntervalGetterDebugSink.h"
+#include "DiagnosticsTrace.h"
+
+namespace saint {
+namespace testUtils {
+namespace {
+class TraceIntervalGetterDebugSink : public IntervalGetterDebugSink {
+public:
+  TraceIntervalGetterDebugSink(float crotchetsPerSample)
+      : _crotchetsPerSample(crotchetsPerSample),
+        _writer(getDiagnosticsTraceWriter()), _channel(_writer->addChannel()) {}
+
+  void onHarmoInterval(const IntervalGetterDebugArgs &args) override {
+    if (_first) {
+      _first = false;
+      const auto &crotchets = args.intervalCrotchets;
+      const auto numSpans = static_cast<int>(crotchets.size());
+      _channel.write(diagnostics::RecordType::spanCrotchets, _position,
+                     diagnostics::SpanCrotchets{_crotchetsPerSample, numSpans},
+                     crotchets.data(), numSpans);
+    }
+    _channel.write(
+        diagnostics::RecordType::intervalLookup, _position,
+        diagnostics::IntervalLookup{
+            args.timeInCrotchets, args.newIndex,
+            args.inputPitch.has_value(), args.inputPitch.value_or(0.f),
+            args.returnedInterval.has_value(),
+            args.returnedInterval.value_or(0.f)});
+    _position += args.blockSize;
+  }
+
+private:
+  const float _crotchetsPerSample;
+  const std::shared_ptr<DiagnosticsTraceWriter> _writer;
+  DiagnosticsTraceWriter::Channel &_channel;
+  std::int64_t _position = 0;
+  bool _first = true;
+};
+} // namespace
+
+std::unique_ptr<IntervalGetterDebugSink>
+makeIntervalGetterDebugSink(float crotchetsPerSample) {
+  return std::make_unique<TraceIntervalGetterDebugSink>(crotchetsPerSample);
+}
+} // namespace testUtils
+} // namespace saint
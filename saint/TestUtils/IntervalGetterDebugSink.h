@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace saint {
+namespace testUtils {
+struct IntervalGetterDebugArgs {
+  const std::vector<float> &intervalCrotchets;
+  float timeInCrotchets;
+  const std::optional<float> &inputPitch;
+  const std::optional<float> &returnedInterval;
+  int newIndex;
+  int blockSize;
+};
+
+class IntervalGetterDebugSink {
+public:
+  virtual ~IntervalGetterDebugSink() = default;
+  virtual void onHarmoInterval(const IntervalGetterDebugArgs &) = 0;
+};
+
+// Writes the input and output of the interval getter to the diagnostics trace
+// (see `DiagnosticsTrace.h`).
+std::unique_ptr<IntervalGetterDebugSink>
+makeIntervalGetterDebugSink(float crotchetsPerSample);
+} // namespace testUtils
+} // namespace saint
@@ -0,0 +1,54 @@
+#include "PitchDetectorDebugSink.h"
+#include "DiagnosticsTrace.h"
+
+#include <algorithm>
+
+namespace saint {
+namespace testUtils {
+namespace {
+class TracePitchDetectorDebugSink : public PitchDetectorDebugSink {
+public:
+  TracePitchDetectorDebugSink()
+      : _writer(getDiagnosticsTraceWriter()), _channel(_writer->addChannel()) {}
+
+  void onAnalysis(const PitchDetectorFftAnal &anal) override {
+    // The window size doesn't change, so this only allocates the first time.
+    _truncatedXcorr.resize(anal.windowSize);
+    std::copy(anal.xcor.begin(), anal.xcor.begin() + anal.windowSize / 2,
+              _truncatedXcorr.begin());
+    std::copy(anal.xcor.end() - anal.windowSize / 2, anal.xcor.end(),
+              _truncatedXcorr.begin() + anal.windowSize / 2);
+    _truncatedXcorr[std::min((size_t)anal.peakIndex,
+                             _truncatedXcorr.size() - 1)] = 0.f;
+    const auto position = _blockPosition + anal.blockOffset;
+    _channel.write(diagnostics::RecordType::xcorr, position,
+                   diagnostics::Xcorr{anal.olapAnalIndex, anal.windowSize},
+                   _truncatedXcorr.data(), anal.windowSize);
+    _channel.write(diagnostics::RecordType::pitchAnalysis, position,
+                   diagnostics::PitchAnalysis{anal.olapAnalIndex,
+                                              anal.peakIndex, anal.scaledMax,
+                                              anal.maxMin});
+  }
+
+  void onBlockProcessed(const std::optional<float> &detectedPitch,
+                        int blockSize) override {
+    // At the beginning of the block it applies to.
+    _channel.write(diagnostics::RecordType::detectedPitch, _blockPosition,
+                   diagnostics::DetectedPitch{detectedPitch.has_value(),
+                                              detectedPitch.value_or(0.f)});
+    _blockPosition += blockSize;
+  }
+
+private:
+  const std::shared_ptr<DiagnosticsTraceWriter> _writer;
+  DiagnosticsTraceWriter::Channel &_channel;
+  std::vector<float> _truncatedXcorr;
+  std::int64_t _blockPosition = 0;
+};
+} // namespace
+
+std::unique_ptr<PitchDetectorDebugSink> makePitchDetectorDebugSink() {
+  return std::make_unique<TracePitchDetectorDebugSink>();
+}
+} // namespace testUtils
+} // namespace saint
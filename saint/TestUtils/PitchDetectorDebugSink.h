@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace saint {
+namespace testUtils {
+struct PitchDetectorFftAnal {
+  int windowSize;
+  // Only valid for the duration of the call.
+  const std::vector<float> &xcor;
+  int olapAnalIndex;
+  int peakIndex;
+  float scaledMax;
+  float maxMin;
+  // Where in the block being processed the analysed frame ends.
+  int blockOffset;
+};
+
+class PitchDetectorDebugSink {
+public:
+  virtual ~PitchDetectorDebugSink() = default;
+  virtual void onAnalysis(const PitchDetectorFftAnal &) = 0;
+  virtual void onBlockProcessed(const std::optional<float> &detectedPitch,
+                                int blockSize) = 0;
+};
+
+// Writes the analyses to the diagnostics trace (see `DiagnosticsTrace.h`).
+std::unique_ptr<PitchDetectorDebugSink> makePitchDetectorDebugSink();
+} // namespace testUtils
+} // namespace saint
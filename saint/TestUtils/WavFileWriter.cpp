@@ -2,6 +2,8 @@
 
 #include "testUtils.h"
 
+#include <algorithm>
+
 namespace saint {
 namespace testUtils {
 namespace fs = std::filesystem;
@@ -10,9 +12,8 @@ WavFileWriter::WavFileWriter(const fs::path &path)
     : _juceWriter(getJuceWavFileWriter(path)) {}
 
 bool WavFileWriter::write(const float *audio, int size) {
-  std::vector<const float *> channels(1);
-  channels[0] = audio;
-  return _juceWriter->writeFromFloatArrays(channels.data(), 1, size);
+  const float *channels[] = {audio};
+  return _juceWriter->writeFromFloatArrays(channels, 1, size);
 }
 
 bool WavFileWriter::write(const std::vector<float> &audio) {
@@ -20,9 +21,14 @@ bool WavFileWriter::write(const std::vector<float> &audio) {
 }
 
 bool WavFileWriter::write(float value, int size) {
-  std::vector<float> audio(size);
-  std::fill(audio.begin(), audio.end(), value);
-  return write(audio);
+  if (size <= 0) {
+    return true;
+  }
+  if (_constant.size() < static_cast<size_t>(size)) {
+    _constant.resize(size);
+  }
+  std::fill(_constant.begin(), _constant.begin() + size, value);
+  return write(_constant.data(), size);
 }
 } // namespace testUtils
 } // namespace saint
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <memory>
+#include <vector>
 
 #include <juce_audio_utils/juce_audio_utils.h>
 
@@ -16,6 +17,8 @@ public:
 
 private:
   const std::unique_ptr<juce::AudioFormatWriter> _juceWriter;
+  // For `write(value, xTimes)`; only grows.
+  std::vector<float> _constant;
 };
 } // namespace testUtils
 } // namespace saint
\ No newline at end of file
@@ -2,8 +2,11 @@
 
 #include <juce_audio_formats/juce_audio_formats.h>
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <memory>
+#include <numeric>
 #include <optional>
 
 namespace saint {
@@ -12,21 +15,21 @@ namespace testUtils {
 namespace fs = std::filesystem;
 
 std::unique_ptr<juce::AudioFormatWriter>
-getJuceWavFileWriter(const fs::path &path) {
+getJuceWavFileWriter(const fs::path &path, double sampleRate) {
   juce::WavAudioFormat format;
   std::unique_ptr<juce::AudioFormatWriter> writer;
   if (fs::exists(path)) {
     fs::remove(path);
   }
   writer.reset(format.createWriterFor(
-      new juce::FileOutputStream(juce::File(path.string())), 44100.0, 1, 16, {},
-      0));
+      new juce::FileOutputStream(juce::File(path.string())), sampleRate, 1, 16,
+      {}, 0));
   return writer;
 }
 
 void toWavFile(const float *audio, size_t N, std::optional<fs::path> pathOpt) {
   const auto writer = getJuceWavFileWriter(
-      pathOpt ? *pathOpt : fs::path{"C:/Users/saint/Downloads/test.wav"});
+      pathOpt ? *pathOpt : fs::path{getOutDir()}.append("test.wav"));
   writer->writeFromFloatArrays(&audio, 1, (int)N);
 }
 
@@ -42,7 +45,13 @@ std::string getInputFilePath() {
   return path.string();
 }
 
-std::string getOutDir() { return "C:/Users/saint/Downloads/"; }
+std::string getOutDir() {
+#ifdef _WIN32
+  return "C:/Users/saint/Downloads/";
+#else
+  return (fs::temp_directory_path() / "").string();
+#endif
+}
 
 std::unique_ptr<juce::AudioFormatReader>
 getJuceWavFileReader(const fs::path &path) {
@@ -67,7 +76,7 @@ std::vector<float> makeCosine(size_t T, size_t N) {
   const auto dT = (double)T;
   const auto dN = (double)N;
   for (auto i = 0u; i < N; ++i) {
-    sinewave[i] = std::cosf((float)(i * 2 * 3.1416 * dT / dN));
+    sinewave[i] = std::cos((float)(i * 2 * 3.1416 * dT / dN));
   }
   return sinewave;
 }
@@ -75,7 +84,7 @@ std::vector<float> makeCosine(size_t T, size_t N) {
 float getRms(const std::vector<float> &V) {
   auto U = V;
   std::transform(V.begin(), V.end(), U.begin(), [](auto v) { return v * v; });
-  return std::sqrtf(std::accumulate(U.begin(), U.end(), 0.f) / (float)V.size());
+  return std::sqrt(std::accumulate(U.begin(), U.end(), 0.f) / (float)V.size());
 }
 } // namespace testUtils
 } // namespace saint
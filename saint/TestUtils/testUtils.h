@@ -16,7 +16,7 @@ std::unique_ptr<juce::AudioFormatReader>
 getJuceWavFileReader(const std::filesystem::path &pathOpt);
 
 std::unique_ptr<juce::AudioFormatWriter>
-getJuceWavFileWriter(const std::filesystem::path &);
+getJuceWavFileWriter(const std::filesystem::path &, double sampleRate = 44100.);
 
 void toWavFile(const float *audio, size_t N,
                std::optional<std::filesystem::path> pathOpt = std::nullopt);
@@ -0,0 +1,278 @@
+#include "RealtimeSanitizer.h"
+
+#ifdef SAINT_RT_SANITIZER
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+// glibc's own entry points, which our malloc family forwards to. Using them
+// rather than `dlsym(RTLD_NEXT, "malloc")` avoids dlsym itself allocating
+// before we can forward anything.
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void __libc_free(void *);
+void *__libc_memalign(size_t, size_t);
+}
+
+namespace saint {
+namespace {
+// Plain integers, so that accessing them needs no initialization and never
+// allocates, even from within malloc.
+thread_local int realtimeDepth = 0;
+thread_local bool isReporting = false;
+
+std::atomic<int> numViolations = 0;
+bool haltOnViolation = false;
+
+template <typename F> F getNext(const char *name) {
+  return reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+}
+
+// Resolved before `main` and outside of any real-time context.
+struct NextFunctions {
+  NextFunctions() {
+    // The first call to `backtrace` loads libgcc, which allocates.
+    void *frames[1];
+    backtrace(frames, 1);
+    const auto halt = std::getenv("SAINT_RT_SANITIZER_HALT");
+    haltOnViolation = halt && std::strcmp(halt, "0") != 0;
+  }
+  decltype(&pthread_mutex_lock) mutexLock =
+      getNext<decltype(&pthread_mutex_lock)>("pthread_mutex_lock");
+  decltype(&pthread_cond_wait) condWait =
+      getNext<decltype(&pthread_cond_wait)>("pthread_cond_wait");
+  decltype(&nanosleep) nanoSleep = getNext<decltype(&nanosleep)>("nanosleep");
+  decltype(&usleep) uSleep = getNext<decltype(&usleep)>("usleep");
+  decltype(&sleep) secondSleep = getNext<decltype(&sleep)>("sleep");
+  decltype(&fopen) fOpen = getNext<decltype(&fopen)>("fopen");
+  decltype(&fwrite) fWrite = getNext<decltype(&fwrite)>("fwrite");
+  decltype(&fflush) fFlush = getNext<decltype(&fflush)>("fflush");
+  decltype(&read) readFd = getNext<decltype(&read)>("read");
+  decltype(&write) writeFd = getNext<decltype(&write)>("write");
+  int (*openFile)(const char *, int, ...) =
+      getNext<int (*)(const char *, int, ...)>("open");
+};
+
+NextFunctions &getNextFunctions() {
+  static NextFunctions functions;
+  return functions;
+}
+
+// Forces the resolution at static initialization time.
+const auto &nextFunctions = getNextFunctions();
+
+void writeToStderr(const char *text, size_t size) {
+  [[maybe_unused]] const auto numWritten =
+      getNextFunctions().writeFd(STDERR_FILENO, text, size);
+}
+
+void checkRealtimeSafety(const char *what) {
+  if (realtimeDepth == 0 || isReporting) {
+    return;
+  }
+  isReporting = true;
+  ++numViolations;
+  char message[256];
+  const auto size =
+      std::snprintf(message, sizeof(message),
+                    "saint: real-time violation: %s called in a real-time "
+                    "context\n",
+                    what);
+  if (size > 0) {
+    writeToStderr(message,
+                  std::min(static_cast<size_t>(size), sizeof(message) - 1));
+  }
+  void *frames[64];
+  const auto numFrames = backtrace(frames, 64);
+  // Skip this function.
+  backtrace_symbols_fd(frames + 1, numFrames - 1, STDERR_FILENO);
+  isReporting = false;
+  if (haltOnViolation) {
+    std::abort();
+  }
+}
+} // namespace
+
+ScopedRealtimeContext::ScopedRealtimeContext() { ++realtimeDepth; }
+
+ScopedRealtimeContext::~ScopedRealtimeContext() { --realtimeDepth; }
+
+namespace realtimeSanitizer {
+int getNumViolations() { return numViolations; }
+} // namespace realtimeSanitizer
+} // namespace saint
+
+using saint::checkRealtimeSafety;
+using saint::getNextFunctions;
+
+extern "C" {
+void *malloc(size_t size) {
+  checkRealtimeSafety("malloc");
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size) {
+  checkRealtimeSafety("calloc");
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *p, size_t size) {
+  checkRealtimeSafety("realloc");
+  return __libc_realloc(p, size);
+}
+
+void free(void *p) {
+  if (p) {
+    checkRealtimeSafety("free");
+  }
+  __libc_free(p);
+}
+
+int posix_memalign(void **p, size_t alignment, size_t size) {
+  checkRealtimeSafety("posix_memalign");
+  *p = __libc_memalign(alignment, size);
+  return *p ? 0 : ENOMEM;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  checkRealtimeSafety("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+  checkRealtimeSafety("pthread_mutex_lock");
+  return getNextFunctions().mutexLock(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+  checkRealtimeSafety("pthread_cond_wait");
+  return getNextFunctions().condWait(cond, mutex);
+}
+
+int nanosleep(const struct timespec *duration, struct timespec *remaining) {
+  checkRealtimeSafety("nanosleep");
+  return getNextFunctions().nanoSleep(duration, remaining);
+}
+
+int usleep(useconds_t duration) {
+  checkRealtimeSafety("usleep");
+  return getNextFunctions().uSleep(duration);
+}
+
+unsigned int sleep(unsigned int seconds) {
+  checkRealtimeSafety("sleep");
+  return getNextFunctions().secondSleep(seconds);
+}
+
+FILE *fopen(const char *path, const char *mode) {
+  checkRealtimeSafety("fopen");
+  return getNextFunctions().fOpen(path, mode);
+}
+
+size_t fwrite(const void *data, size_t size, size_t count, FILE *file) {
+  checkRealtimeSafety("fwrite");
+  return getNextFunctions().fWrite(data, size, count, file);
+}
+
+int fflush(FILE *file) {
+  checkRealtimeSafety("fflush");
+  return getNextFunctions().fFlush(file);
+}
+
+ssize_t read(int fd, void *buffer, size_t size) {
+  checkRealtimeSafety("read");
+  return getNextFunctions().readFd(fd, buffer, size);
+}
+
+ssize_t write(int fd, const void *buffer, size_t size) {
+  checkRealtimeSafety("write");
+  return getNextFunctions().writeFd(fd, buffer, size);
+}
+
+int open(const char *path, int flags, ...) {
+  checkRealtimeSafety("open");
+  mode_t mode = 0;
+  if (flags & O_CREAT) {
+    va_list args;
+    va_start(args, flags);
+    mode = static_cast<mode_t>(va_arg(args, int));
+    va_end(args);
+  }
+  return getNextFunctions().openFile(path, flags, mode);
+}
+} // extern "C"
+
+// The default operator new calls malloc, but that's libstdc++'s business: be
+// explicit, and report the C++ name.
+void *operator new(size_t size) {
+  checkRealtimeSafety("operator new");
+  if (auto p = __libc_malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new[](size_t size) {
+  checkRealtimeSafety("operator new[]");
+  if (auto p = __libc_malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  checkRealtimeSafety("operator new");
+  return __libc_malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  checkRealtimeSafety("operator new[]");
+  return __libc_malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *p) noexcept {
+  if (p) {
+    checkRealtimeSafety("operator delete");
+  }
+  __libc_free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  if (p) {
+    checkRealtimeSafety("operator delete[]");
+  }
+  __libc_free(p);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+void operator delete[](void *p, size_t) noexcept { operator delete[](p); }
+
+#else
+
+namespace saint {
+ScopedRealtimeContext::ScopedRealtimeContext() {}
+
+ScopedRealtimeContext::~ScopedRealtimeContext() {}
+
+namespace realtimeSanitizer {
+int getNumViolations() { return 0; }
+} // namespace realtimeSanitizer
+} // namespace saint
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+namespace saint {
+// Marks the calling thread as running real-time code for the lifetime of the
+// object. In builds configured with SAINT_RT_SANITIZER, memory allocation and
+// release, mutex locks, sleeps and file I/O done meanwhile by that thread are
+// reported on stderr with a stack trace, and counted. Without it, this is a
+// no-op.
+// Interception relies on the executable defining the intercepted functions:
+// it works for the tests, the standalone and the render tool, but not for a
+// plugin loaded by a host.
+class ScopedRealtimeContext {
+public:
+  ScopedRealtimeContext();
+  ~ScopedRealtimeContext();
+  ScopedRealtimeContext(const ScopedRealtimeContext &) = delete;
+  ScopedRealtimeContext &operator=(const ScopedRealtimeContext &) = delete;
+};
+
+namespace realtimeSanitizer {
+// Violations reported since the start of the process, all threads together.
+// Always 0 without SAINT_RT_SANITIZER.
+int getNumViolations();
+} // namespace realtimeSanitizer
+} // namespace saint
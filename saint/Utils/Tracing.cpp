@@ -0,0 +1,164 @@
+#include "Tracing.h"
+
+#ifdef SAINT_TRACING
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace saint {
+namespace tracing {
+#ifdef SAINT_TRACING
+namespace {
+// About 1.5MB per thread, enough for some seconds of audio processing.
+constexpr uint64_t eventsPerThread = 1 << 16;
+
+struct Event {
+  const char *name;
+  int64_t beginNs;
+  int64_t endNs;
+};
+
+// Single producer: the thread it belongs to. The events are a ring, and
+// `numWritten` tells which ones the dumping thread may read.
+struct ThreadBuffer {
+  ThreadBuffer(int tid) : events(eventsPerThread), tid(tid) {}
+  std::vector<Event> events;
+  std::atomic<uint64_t> numWritten = 0;
+  const int tid;
+  // Guarded by the registry mutex.
+  std::string name;
+};
+
+struct Registry {
+  std::mutex mutex;
+  // Buffers outlive their threads, for a dump to include threads that have
+  // finished.
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  int nextTid = 1;
+};
+
+Registry &getRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+ThreadBuffer &getThreadBuffer() {
+  thread_local const std::shared_ptr<ThreadBuffer> buffer = [] {
+    auto &registry = getRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex};
+    auto newBuffer = std::make_shared<ThreadBuffer>(registry.nextTid++);
+    registry.buffers.push_back(newBuffer);
+    return newBuffer;
+  }();
+  return *buffer;
+}
+
+int64_t getNanoseconds() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch)
+      .count();
+}
+
+// Zone names are literals of ours, but let's not write broken JSON anyway.
+std::string escape(const char *text) {
+  std::string escaped;
+  for (; *text; ++text) {
+    if (*text == '"' || *text == '\\') {
+      escaped += '\\';
+    }
+    escaped += *text;
+  }
+  return escaped;
+}
+} // namespace
+
+ScopedZone::ScopedZone(const char *name)
+    : _name(name), _beginNs(getNanoseconds()) {}
+
+ScopedZone::~ScopedZone() {
+  auto &buffer = getThreadBuffer();
+  const auto n = buffer.numWritten.load(std::memory_order_relaxed);
+  buffer.events[n % eventsPerThread] = {_name, _beginNs, getNanoseconds()};
+  buffer.numWritten.store(n + 1, std::memory_order_release);
+}
+
+void setThreadName(const std::string &name) {
+  auto &buffer = getThreadBuffer();
+  auto &registry = getRegistry();
+  std::lock_guard<std::mutex> lock{registry.mutex};
+  buffer.name = name;
+}
+
+bool dumpChromeTrace(const std::filesystem::path &path) {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::vector<std::string> names;
+  {
+    auto &registry = getRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex};
+    buffers = registry.buffers;
+    for (const auto &buffer : buffers) {
+      names.push_back(buffer->name);
+    }
+  }
+  const auto file = std::fopen(path.string().c_str(), "w");
+  if (!file) {
+    return false;
+  }
+  std::fprintf(file, "{\"traceEvents\":[\n");
+  auto first = true;
+  const auto separator = [&first]() {
+    const auto s = first ? "" : ",\n";
+    first = false;
+    return s;
+  };
+  std::vector<Event> events;
+  for (auto i = 0u; i < buffers.size(); ++i) {
+    auto &buffer = *buffers[i];
+    if (!names[i].empty()) {
+      std::fprintf(file,
+                   "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                   "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                   separator(), buffer.tid, escape(names[i].c_str()).c_str());
+    }
+    const auto end = buffer.numWritten.load(std::memory_order_acquire);
+    const auto begin = end > eventsPerThread ? end - eventsPerThread : 0;
+    events.clear();
+    for (auto n = begin; n < end; ++n) {
+      events.push_back(buffer.events[n % eventsPerThread]);
+    }
+    // Whatever the owner thread wrote meanwhile may have overwritten the
+    // oldest events we copied, and it may be writing the next one.
+    const auto numWrittenAfterCopy =
+        buffer.numWritten.load(std::memory_order_acquire);
+    const auto firstValid = numWrittenAfterCopy >= eventsPerThread
+                                ? numWrittenAfterCopy - eventsPerThread + 1
+                                : 0;
+    for (auto n = std::max(begin, firstValid); n < end; ++n) {
+      const auto &event = events[n - begin];
+      std::fprintf(file,
+                   "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                   "\"ts\":%.3f,\"dur\":%.3f}",
+                   separator(), escape(event.name).c_str(), buffer.tid,
+                   event.beginNs / 1000., (event.endNs - event.beginNs) / 1000.);
+    }
+  }
+  std::fprintf(file, "\n]}\n");
+  return std::fclose(file) == 0;
+}
+#else
+ScopedZone::ScopedZone(const char *name) : _name(name), _beginNs(0) {}
+
+ScopedZone::~ScopedZone() {}
+
+void setThreadName(const std::string &) {}
+
+bool dumpChromeTrace(const std::filesystem::path &) { return false; }
+#endif
+} // namespace tracing
+} // namespace saint
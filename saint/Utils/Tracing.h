@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Trace zones for timeline profiling, compiled in by configuring with
+// SAINT_TRACING, and to nothing otherwise.
+// Each thread records the zones it goes through in a buffer of its own,
+// keeping the most recent ones. `dumpChromeTrace` writes those of all threads
+// to a file that chrome://tracing or https://ui.perfetto.dev can open.
+//
+// Usage:
+//   void Foo::process() {
+//     SAINT_TRACE_ZONE("Foo::process");
+//     ...
+//   }
+//
+// The zone name must be a string literal: only its address is recorded.
+// The first zone or name of a thread allocates that thread's buffer.
+#ifdef SAINT_TRACING
+#define SAINT_TRACE_CONCAT_IMPL(a, b) a##b
+#define SAINT_TRACE_CONCAT(a, b) SAINT_TRACE_CONCAT_IMPL(a, b)
+#define SAINT_TRACE_ZONE(name)                                                 \
+  const ::saint::tracing::ScopedZone SAINT_TRACE_CONCAT(saintTraceZone,        \
+                                                        __COUNTER__)(name)
+// Names the calling thread in the trace, only the first time it is hit on
+// that thread, so that it can be used in a callback.
+#define SAINT_TRACE_THREAD_NAME(name)                                          \
+  [[maybe_unused]] static thread_local const bool SAINT_TRACE_CONCAT(          \
+      saintTraceThreadNamed, __COUNTER__) =                                    \
+      (::saint::tracing::setThreadName(name), true)
+#else
+#define SAINT_TRACE_ZONE(name)
+#define SAINT_TRACE_THREAD_NAME(name)
+#endif
+
+namespace saint {
+namespace tracing {
+// Use through SAINT_TRACE_ZONE.
+class ScopedZone {
+public:
+  explicit ScopedZone(const char *name);
+  ~ScopedZone();
+  ScopedZone(const ScopedZone &) = delete;
+  ScopedZone &operator=(const ScopedZone &) = delete;
+
+private:
+  const char *const _name;
+  const int64_t _beginNs;
+};
+
+// Without SAINT_TRACING, these are no-ops.
+void setThreadName(const std::string &);
+// Can be called anytime from any thread, while zones are being recorded.
+// Returns false if the file could not be written or tracing isn't compiled in.
+bool dumpChromeTrace(const std::filesystem::path &);
+} // namespace tracing
+} // namespace saint
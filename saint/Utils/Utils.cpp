@@ -2,18 +2,26 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdlib>
 
 namespace saint {
 namespace utils {
 std::string getEnvironmentVariable(const char *var) {
+#ifdef _WIN32
   char *buffer = nullptr;
   size_t size = 0;
   _dupenv_s(&buffer, &size, var);
   if (!buffer) {
     return "";
   } else {
-    return std::string{buffer};
+    std::string value{buffer};
+    free(buffer);
+    return value;
   }
+#else
+  const auto value = std::getenv(var);
+  return value ? std::string{value} : "";
+#endif
 }
 
 bool getEnvironmentVariableAsBool(const char *var) {
@@ -33,7 +41,7 @@ bool isDebugBuild() {
 }
 
 float getPitch(int noteNumber) {
-  return 440 * std::powf(2, (noteNumber - 69) / 12.f);
+  return 440 * std::pow(2.f, (noteNumber - 69) / 12.f);
 }
 
 float getCrotchetsPerSample(float crotchetsPerSecond, int samplesPerSecond) {